@@ -455,7 +455,7 @@ urj_pyc_get_dr (urj_pychain_t *self, int in, int type, PyObject *args)
              {
                  if (s->input != NULL)
                  {
-                     int new = bsr->out->data[s->input->bit];
+                     int new = urj_tap_register_get_bit (bsr->out, s->input->bit);
                      urj_part_salias_t *a;
                      for (a = part->saliases; a; a = a->next)
                      {
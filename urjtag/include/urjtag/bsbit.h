@@ -81,6 +81,28 @@ int urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
                                   int type, int safe, int ctrl_num,
                                   int ctrl_val, int ctrl_state);
 
+/**
+ * Define new BSR bit like urj_part_bsbit_alloc_control(), for callers that
+ * have looked up the BSR and the signal already.
+ *
+ * @param part
+ * @param bsr Boundary Scan Register of the part
+ * @param signal signal of the bit, NULL for none
+ * @param bit
+ * @param name associated signal name
+ * @param type URJ_BSBIT_{INPUT|OUTPUT|BIDIR|CONTROL|INTERNAL}
+ * @param safe default (safe) value (0|1|URJ_BSBIT_DONTCARE)
+ * @param ctrl_num control bit number, -1 for none
+ * @param ctrl_val control value
+ * @param ctrl_state control state
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_bsbit_define (urj_part_t *part, urj_data_register_t *bsr,
+                           urj_part_signal_t *signal, int bit,
+                           const char *name, int type, int safe,
+                           int ctrl_num, int ctrl_val, int ctrl_state);
+
 void urj_part_bsbit_free (urj_bsbit_t *b);
 
 #endif /* URJ_BSBIT_BSBIT_H */
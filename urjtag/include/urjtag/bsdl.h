@@ -33,6 +33,7 @@ typedef struct
 {
     char **path_list;
     int debug;
+    int jobs;                   /* threads reading files, 0 for one per CPU */
 }
 urj_bsdl_globs_t;
 
@@ -40,6 +41,7 @@ urj_bsdl_globs_t;
     do { \
         bsdl.path_list = NULL; \
         bsdl.debug = 0; \
+        bsdl.jobs = 0; \
     } while (0)
 
 /* @@@@ RFHH ToDo: let urj_bsdl_read_file also return URJ_STATUS_... */
@@ -59,5 +61,11 @@ void urj_bsdl_set_path (urj_chain_t *, const char *);
  *   > 0 : No errors, idcode checked and matched
  */
 int urj_bsdl_scan_files (urj_chain_t *, const char *, int);
+/**
+ * Create or update the IDCODE index of each directory in the BSDL path.
+ * urj_bsdl_scan_files() does so too when it looks for an IDCODE.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bsdl_index (urj_chain_t *);
 
 #endif /* URJ_BSDL_BSDL_H */
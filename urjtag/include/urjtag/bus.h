@@ -33,8 +33,46 @@
 
 extern urj_bus_t *urj_bus;
 
-/** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+/**
+ * Progress of a memory transfer, called after each chunk with the number of
+ * bytes done out of total and the seconds elapsed since the start.
+ */
+typedef void (*urj_bus_progress_func_t) (void *data, uint64_t done,
+                                         uint64_t total, double elapsed);
+
+/**
+ * Copy len bytes of memory starting at addr to f, logging the progress.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
 int urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len);
+/**
+ * urj_bus_readmem() that reports its progress to progress (if not NULL)
+ * instead of logging it.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_readmem_progress (urj_bus_t *bus, FILE *f, uint32_t addr,
+                              uint32_t len, urj_bus_progress_func_t progress,
+                              void *data);
+
+/** urj_bus_verifymem() flag: stop at the first differing byte */
+#define URJ_BUS_VERIFY_STOP     1
+
+/**
+ * Compare len bytes of memory starting at addr with the contents of f, the
+ * bytes urj_bus_readmem() would write, while reading.  The ranges that
+ * differ are logged.
+ * @return URJ_STATUS_OK if they are the same; URJ_STATUS_FAIL if they differ
+ *      or on error
+ */
+int urj_bus_verifymem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len,
+                       int flags);
+/**
+ * Compute the CRC-32 (as zlib) of the bytes urj_bus_readmem() would write
+ * for len bytes of memory starting at addr, without writing them.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_crcmem (urj_bus_t *bus, uint32_t addr, uint32_t len,
+                    uint32_t *crc);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len);
 
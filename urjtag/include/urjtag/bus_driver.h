@@ -121,6 +121,14 @@ struct URJ_BUS_DRIVER
     int (*enable) (urj_bus_t *bus);
     int (*disable) (urj_bus_t *bus);
     urj_bus_type_t bus_type;
+    /* optional, NULL for a word by word fallback on the operations above;
+     * buf holds one bus word per element, len is the number of words */
+    /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+    int (*read_block) (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                       uint32_t len);
+    /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+    int (*write_block) (urj_bus_t *bus, uint32_t adr, const uint32_t *buf,
+                        uint32_t len);
 };
 
 struct URJ_BUS
@@ -148,6 +156,27 @@ struct URJ_BUS
 #define URJ_BUS_ENABLE(bus)             (bus)->driver->enable(bus)
 #define URJ_BUS_DISABLE(bus)            (bus)->driver->disable(bus)
 #define URJ_BUS_TYPE(bus)               (bus)->driver->bus_type
+#define URJ_BUS_READ_BLOCK(bus,adr,buf,len) \
+    urj_bus_read_block(bus,adr,buf,len)
+#define URJ_BUS_WRITE_BLOCK(bus,adr,buf,len) \
+    urj_bus_write_block(bus,adr,buf,len)
+
+/**
+ * Read len consecutive bus words starting at byte address adr, with the
+ * read_block operation of the driver or word by word.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                        uint32_t len);
+/**
+ * Write len consecutive bus words starting at byte address adr, with the
+ * write_block operation of the driver or word by word.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_write_block (urj_bus_t *bus, uint32_t adr, const uint32_t *buf,
+                         uint32_t len);
 
 /**
  * API function to init a bus
@@ -66,6 +66,8 @@ typedef enum URJ_CABLE_PARAM_KEY
     URJ_CABLE_PARAM_KEY_INTERFACE,      /* lu           ftdi */
     URJ_CABLE_PARAM_KEY_FIRMWARE,       /* string       ice100 */
     URJ_CABLE_PARAM_KEY_INDEX,          /* lu           ftdi */
+    URJ_CABLE_PARAM_KEY_QUEUE,          /* lu           all (queue size) */
+    URJ_CABLE_PARAM_KEY_IOTHREAD,       /* bool         cmd_xfer based cables */
 }
 urj_cable_param_key_t;
 
@@ -105,21 +107,46 @@ struct URJ_CABLE_DRIVER
     void (*help) (urj_log_level_t ll, const char *);
     /* A bitfield of quirks */
     uint32_t quirks;
+    /** Optional variant of transfer() on packed bits: bit n of in/out is
+     * bit (n % 8) of byte n / 8; out may be NULL.  Preferred over
+     * transfer() when the queue is flushed.
+     * @return nonnegative number, or the number of transferred bits on
+     * success; -1 on failure */
+    int (*transfer_packed) (urj_cable_t *, int, const uint8_t *, uint8_t *);
+    /** Optional: like transfer_packed(), but with TMS raised on the last
+     * bit, so that the TAP leaves Shift-DR/IR in the same sequence.  The
+     * TDO bit in front of the last clock goes into out as well.
+     * @return nonnegative number, or the number of transferred bits on
+     * success; -1 on failure */
+    int (*transfer_exit) (urj_cable_t *, int, const uint8_t *, uint8_t *);
 };
 
 typedef struct URJ_CABLE_QUEUE urj_cable_queue_t;
 
+/**
+ * Handle for the result of a deferred operation, see
+ * urj_tap_cable_ticket_wait.  Tickets are handed out in ascending order.
+ */
+typedef unsigned long urj_cable_ticket_t;
+/** never a valid ticket; returned on failure */
+#define URJ_CABLE_NO_TICKET     0
+
 struct URJ_CABLE_QUEUE
 {
     enum
     {
         URJ_TAP_CABLE_CLOCK,
+        /* arg.clock.n (at most 7) clocks, TMS from the bits of
+         * arg.clock.tms starting at the LSB */
         URJ_TAP_CABLE_CLOCK_COMPACT,
         URJ_TAP_CABLE_GET_TDO,
         URJ_TAP_CABLE_TRANSFER,
         URJ_TAP_CABLE_SET_SIGNAL,
         URJ_TAP_CABLE_GET_SIGNAL
     } action;
+    /** URJ_CABLE_NO_TICKET, or the ticket to resolve with the result;
+     * drivers copy it from the todo item to the done item */
+    urj_cable_ticket_t ticket;
     union
     {
         struct
@@ -134,32 +161,105 @@ struct URJ_CABLE_QUEUE
             int mask;
             int val;
         } value;
+        /* transfer payloads are packed bits, see tap_register.h */
         struct
         {
             int len;
-            char *in;
-            char *out;
+            uint8_t *in;
+            uint8_t *out;
+            /* raise TMS with the last bit, see transfer_exit() */
+            int exit;
         } transfer;
         struct
         {
             int len;
             int res;
-            char *out;
+            uint8_t *out;
         } xferred;
     } arg;
 };
 
+typedef struct URJ_CABLE_ARENA urj_cable_arena_t;
+
+/**
+ * Backing store for queued transfer payloads.  Buffers are carved off
+ * one after the other and the arena is rewound as soon as the last one
+ * has been released, so a steady stream of deferred transfers does not
+ * touch the heap.  When a block runs full it is retired until the next
+ * rewind, and the block is then grown to what the whole round needed.
+ */
+struct URJ_CABLE_ARENA
+{
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    /** bytes handed out since the last rewind, across all blocks */
+    size_t demand;
+    /** full blocks that still hold live payloads */
+    void *retired;
+    /** payloads handed out and not yet released */
+    int live;
+};
+
+typedef struct URJ_CABLE_TICKETS urj_cable_tickets_t;
+
+/** Results of ticketed operations, indexed by ticket */
+struct URJ_CABLE_TICKETS
+{
+    struct URJ_CABLE_TICKET_SLOT *slot;
+    /** capacity; always a power of two */
+    unsigned long max_slots;
+    /** oldest ticket that has not been waited for */
+    urj_cable_ticket_t first;
+    /** the next ticket to hand out */
+    urj_cable_ticket_t next;
+    /** tickets whose results are still in the queues */
+    int pending;
+};
+
+typedef struct URJ_CABLE_QUEUE_STATS urj_cable_queue_stats_t;
+
+struct URJ_CABLE_QUEUE_STATS
+{
+    /** largest number of items held at the same time */
+    int high_water;
+    /** how often the queue had to grow */
+    int resizes;
+    /** items added in total */
+    unsigned long added;
+};
+
 typedef struct URJ_CABLE_QUEUE_INFO urj_cable_queue_info_t;
 
 struct URJ_CABLE_QUEUE_INFO
 {
     urj_cable_queue_t *data;
+    /** capacity; always a power of two */
     int max_items;
     int num_items;
     int next_item;
     int next_free;
+    urj_cable_queue_stats_t stats;
+    /** where the transfer payloads of the queued items live */
+    urj_cable_arena_t *arena;
 };
 
+/* TCK pacing of bit-banging cables, see urj_tap_cable_wait() */
+typedef struct
+{
+    /** nanoseconds per urj_tap_cable_wait(), i.e. half a TCK period;
+     * 0 disables pacing */
+    uint64_t half_period;
+    /** monotonic time in ns at which the last wait ended */
+    uint64_t last;
+    /** measured oversleep of the sleep call, subtracted from later sleeps */
+    uint64_t latency;
+    /** the achieved frequency is measured over windows of this many ns */
+    uint64_t window;
+    uint64_t window_start;
+    uint32_t window_waits;
+} urj_cable_pace_t;
+
 struct URJ_CABLE
 {
     const urj_cable_driver_t *driver;
@@ -173,8 +273,18 @@ struct URJ_CABLE
     urj_chain_t *chain;
     urj_cable_queue_info_t todo;
     urj_cable_queue_info_t done;
-    uint32_t delay;
+    urj_cable_arena_t payload;
+    urj_cable_tickets_t tickets;
+    /** initial capacity of todo and done; 0 selects the default */
+    int queue_size;
+    /** hand USB writes to a background thread, see
+     * URJ_CABLE_PARAM_KEY_IOTHREAD */
+    int io_thread;
+    urj_cable_pace_t pace;
+    /** achieved TCK frequency, as far as it is known */
     uint32_t frequency;
+    /** TCK frequency last passed to urj_tap_cable_set_frequency() */
+    uint32_t requested_frequency;
 };
 
 void urj_tap_cable_free (urj_cable_t *cable);
@@ -188,6 +298,14 @@ void urj_tap_cable_flush (urj_cable_t *cable,
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure */
 void urj_tap_cable_clock (urj_cable_t *cable, int tms, int tdi, int n);
 int urj_tap_cable_defer_clock (urj_cable_t *cable, int tms, int tdi, int n);
+/**
+ * Queue n clocks (at most 32) with TMS taken from the bits of tms, LSB
+ * first, and TDI held at tdi.  Drivers can send every 7 of them as a
+ * single command.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_tms (urj_cable_t *cable, uint32_t tms, int tdi,
+                             int n);
 /** @return 0 or 1 on success; -1 on failure */
 int urj_tap_cable_get_tdo (urj_cable_t *cable);
 /** @return 0 or 1 on success; -1 on failure */
@@ -206,16 +324,126 @@ int urj_tap_cable_get_signal_late (urj_cable_t *cable, urj_pod_sigsel_t sig);
 int urj_tap_cable_defer_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig);
 /** @return the number of transferred bits on success; -1 on failure */
 int urj_tap_cable_transfer (urj_cable_t *cable, int len, char *in, char *out);
+/**
+ * Same as urj_tap_cable_transfer, but on packed bits
+ * @return the number of transferred bits on success; -1 on failure
+ */
+int urj_tap_cable_transfer_packed (urj_cable_t *cable, int len,
+                                   const uint8_t *in, uint8_t *out);
 /** @return the number of transferred bits on success; -1 on failure */
 int urj_tap_cable_transfer_late (urj_cable_t *cable, char *out);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure */
 int urj_tap_cable_defer_transfer (urj_cable_t *cable, int len, char *in,
                                   char *out);
+/**
+ * Same as urj_tap_cable_transfer_late, but stores the result as packed bits
+ * into out (bits beyond the transferred length are left untouched)
+ * @return the number of transferred bits on success; -1 on failure
+ */
+int urj_tap_cable_transfer_packed_late (urj_cable_t *cable, uint8_t *out);
+/**
+ * Same as urj_tap_cable_defer_transfer, but takes the TDI data as packed
+ * bits.  Like there, out only indicates whether TDO should be recorded.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_transfer_packed (urj_cable_t *cable, int len,
+                                         const uint8_t *in, uint8_t *out);
+/**
+ * Same as urj_tap_cable_transfer_packed, but TMS is raised with the last
+ * bit, so the TAP moves from Shift-DR/IR to Exit1-DR/IR on it.  out (if
+ * not NULL) receives all len TDO bits.
+ * @return the number of transferred bits on success; -1 on failure
+ */
+int urj_tap_cable_transfer_exit (urj_cable_t *cable, int len,
+                                 const uint8_t *in, uint8_t *out);
+/**
+ * Same as urj_tap_cable_defer_transfer_packed, but TMS is raised with the
+ * last bit.  The result is picked up with urj_tap_cable_transfer_packed_late.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_cable_defer_transfer_exit (urj_cable_t *cable, int len,
+                                       const uint8_t *in, uint8_t *out);
+/**
+ * Ticketed variants of the defer functions.  Their results do not go
+ * through the FIFO of the _late functions but are picked up with
+ * urj_tap_cable_ticket_wait, in any order.  Every ticket has to be
+ * waited for exactly once.
+ *
+ * For the transfer, in and out are packed bits; out is required and
+ * must stay allocated until the ticket has been waited for.
+ *
+ * @return ticket on success; URJ_CABLE_NO_TICKET on failure
+ */
+urj_cable_ticket_t urj_tap_cable_defer_transfer_ticket (urj_cable_t *cable,
+                                                        int len,
+                                                        const uint8_t *in,
+                                                        uint8_t *out);
+/** Same as urj_tap_cable_defer_transfer_ticket, but TMS is raised with the
+ * last bit like in urj_tap_cable_defer_transfer_exit */
+urj_cable_ticket_t urj_tap_cable_defer_transfer_exit_ticket (urj_cable_t
+                                                             *cable, int len,
+                                                             const uint8_t
+                                                             *in,
+                                                             uint8_t *out);
+/**
+ * Zero-copy variant of urj_tap_cable_defer_transfer_exit_ticket: in and out
+ * are queued as they are rather than copied through the payload arena,
+ * and the TDO bits are written straight into out.  The caller guarantees
+ * that in stays unchanged and both stay allocated until the ticket has
+ * been waited for.
+ */
+urj_cable_ticket_t urj_tap_cable_defer_transfer_exit_zero_copy (urj_cable_t
+                                                                *cable,
+                                                                int len,
+                                                                const uint8_t
+                                                                *in,
+                                                                uint8_t *out);
+urj_cable_ticket_t urj_tap_cable_defer_get_tdo_ticket (urj_cable_t *cable);
+urj_cable_ticket_t urj_tap_cable_defer_get_signal_ticket (urj_cable_t *cable,
+                                                          urj_pod_sigsel_t
+                                                          sig);
+/**
+ * Check without blocking whether the result of a ticket has arrived
+ * @return 1 if so; 0 if not yet; -1 on failure (unknown ticket)
+ */
+int urj_tap_cable_ticket_poll (urj_cable_t *cable, urj_cable_ticket_t ticket);
+/**
+ * Flush the queue as far as needed and hand out the result of a ticket,
+ * which is released afterwards.  For transfers the TDO bits are in the
+ * out buffer given to urj_tap_cable_defer_transfer_ticket by then.
+ * @return TDO or signal value, or the transfer result, on success;
+ *      -1 on failure
+ */
+int urj_tap_cable_ticket_wait (urj_cable_t *cable, urj_cable_ticket_t ticket);
 
 void urj_tap_cable_set_frequency (urj_cable_t *cable, uint32_t frequency);
 uint32_t urj_tap_cable_get_frequency (urj_cable_t *cable);
+/** @return the TCK frequency last requested, 0 if none or unlimited */
+uint32_t urj_tap_cable_get_requested_frequency (urj_cable_t *cable);
+/**
+ * Wait until half a TCK period has passed since the previous wait.
+ * Bit-banging drivers call this between their signal changes; it sleeps
+ * for long waits and polls the clock for short ones.
+ */
 void urj_tap_cable_wait (urj_cable_t *cable);
 void urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io);
+/**
+ * Give a transfer payload back to the queue's arena once the driver or
+ * the caller is done with it.  Buffers not taken from the arena, the
+ * caller's own of urj_tap_cable_defer_transfer_exit_zero_copy and NULL,
+ * are ignored.
+ */
+void urj_tap_cable_release_payload (urj_cable_queue_info_t *q,
+                                    uint8_t *payload);
+/**
+ * Copy the depth statistics of the todo and done queues into the
+ * provided structures (either may be NULL)
+ */
+void urj_tap_cable_get_queue_stats (urj_cable_t *cable,
+                                    urj_cable_queue_stats_t *todo,
+                                    urj_cable_queue_stats_t *done);
+/** Restart the queue statistics from the current queue depths */
+void urj_tap_cable_reset_queue_stats (urj_cable_t *cable);
 /** @return queue item number on success; -1 on failure */
 int urj_tap_cable_add_queue_item (urj_cable_t *cable,
                                   urj_cable_queue_info_t *q);
@@ -26,6 +26,7 @@
 #define URJ_CHAIN_H
 
 #include "types.h"
+#include "cable.h"
 
 #include "pod.h"
 #include "bsdl.h"
@@ -36,6 +37,15 @@
 #define URJ_CHAIN_EXITMODE_EXIT1        2
 #define URJ_CHAIN_EXITMODE_UPDATE       3
 
+/* a data register scan queued by urj_tap_chain_defer_data_registers */
+typedef struct
+{
+    urj_tap_register_t *in;
+    urj_tap_register_t *out;
+    urj_cable_ticket_t ticket;
+}
+urj_chain_deferred_t;
+
 struct URJ_CHAIN
 {
     int state;
@@ -45,6 +55,16 @@ struct URJ_CHAIN
     urj_cable_t *cable;
     urj_bsdl_globs_t bsdl;
     int main_part;
+    /* scratch registers for chain-wide scans, indexed by 0 for IR and 1
+       for DR; see urj_tap_chain_shift_data_registers_mode */
+    urj_tap_register_t *scan_in[2];
+    urj_tap_register_t *scan_out[2];
+    /* data register scans not collected yet, a ring of deferred_max
+       (a power of two) slots starting at deferred_first */
+    urj_chain_deferred_t *deferred;
+    int deferred_first;
+    int deferred_len;
+    int deferred_max;
 };
 
 urj_chain_t *urj_tap_chain_alloc (void);
@@ -81,6 +101,26 @@ int urj_tap_chain_shift_data_registers (urj_chain_t *chain,
 int urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
                                              int capture_output, int capture,
                                              int chain_exit);
+/**
+ * Queue a scan of the data registers like
+ * urj_tap_chain_shift_data_registers_mode (chain, 1, capture, chain_exit),
+ * but return without waiting for the captured bits.  Any number of scans can
+ * be deferred; urj_tap_chain_collect_data_registers then hands out their
+ * captured bits, oldest first.  The instructions of the parts must not
+ * change in between, and chain_exit must not be URJ_CHAIN_EXITMODE_SHIFT.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_chain_defer_data_registers (urj_chain_t *chain, int capture,
+                                        int chain_exit);
+/**
+ * Copy the bits captured by the oldest deferred scan to the data
+ * registers of the parts, flushing the cable as far as needed.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error or if no scan
+ *      is deferred
+ */
+int urj_tap_chain_collect_data_registers (urj_chain_t *chain);
 void urj_tap_chain_flush (urj_chain_t *chain);
 /** @return 0 or 1 on success; -1 on failure */
 int urj_tap_chain_set_pod_signal (urj_chain_t *chain, int mask, int val);
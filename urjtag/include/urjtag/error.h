@@ -96,7 +96,19 @@ typedef struct URJ_ERROR_STATE
 }
 urj_error_state_t;
 
-extern urj_error_state_t        urj_error_state;
+/**
+ * Storage class of state kept apart for each thread, like errno.
+ */
+#ifdef __GNUC__
+#define URJ_THREAD_LOCAL        __thread
+#else
+#define URJ_THREAD_LOCAL
+#endif
+
+/**
+ * The error state of the calling thread.
+ */
+extern URJ_THREAD_LOCAL urj_error_state_t urj_error_state;
 
 /**
  * Descriptive string for error type
@@ -40,6 +40,17 @@ urj_log_state_t;
 
 extern urj_log_state_t urj_log_state;
 
+/**
+ * Log output held back by urj_log_capture.
+ */
+typedef struct URJ_LOG_CAPTURE
+{
+    char               *buf;                    /**< level byte, text, NUL */
+    size_t              len;                    /**< bytes used in buf */
+    size_t              size;                   /**< bytes allocated */
+}
+urj_log_capture_t;
+
 int urj_do_log (urj_log_level_t level, const char *file, size_t line,
                 const char *func, const char *fmt, ...)
 #ifdef __GNUC__
@@ -53,6 +64,26 @@ int urj_do_log (urj_log_level_t level, const char *file, size_t line,
                 urj_do_log (lvl, __FILE__, __LINE__, __func__, __VA_ARGS__); \
         } while (0)
 
+/**
+ * Hold back the log output of the calling thread in cap instead of passing
+ * it to out_vprintf/err_vprintf, which need not be thread-safe.  The
+ * messages are filtered by level as usual.
+ *
+ * @param cap where to hold back the output; NULL ends the capture
+ */
+void urj_log_capture (urj_log_capture_t *cap);
+
+/**
+ * Append the messages held back in from to those in to, and empty from.
+ */
+void urj_log_capture_move (urj_log_capture_t *to, urj_log_capture_t *from);
+
+/**
+ * Pass the messages held back in cap to out_vprintf/err_vprintf from the
+ * calling thread, and empty cap.
+ */
+void urj_log_capture_replay (urj_log_capture_t *cap);
+
 /**
  * Print warning unless logging level is > URJ_LOG_LEVEL_WARNING
  *
@@ -25,7 +25,11 @@
 #ifndef URJ_PART_H
 #define URJ_PART_H
 
+#include <stdint.h>
+
 #include "types.h"
+#include "tap_register.h"
+#include "data_register.h"
 
 #define URJ_PART_MANUFACTURER_MAXLEN    25
 #define URJ_PART_PART_MAXLEN            20
@@ -54,6 +58,7 @@ struct URJ_PART
     int boundary_length;
     urj_bsbit_t **bsbits;
     urj_part_params_t *params;
+    urj_part_index_t *index;    /* name lookup, the lists grow at the head only */
 };
 
 urj_part_t *urj_part_alloc (const urj_tap_register_t *id);
@@ -70,6 +75,10 @@ urj_data_register_t *urj_part_find_data_register (urj_part_t *p,
  * urj_error; NULL on error */
 urj_part_signal_t *urj_part_find_signal (urj_part_t *p,
                                          const char *signalname);
+/* Like urj_part_find_data_register (p, "BSR"), but cached by the part.
+ * @return BSR pointer on success; NULL if not found but does not set
+ * urj_error; NULL on error */
+urj_data_register_t *urj_part_find_bsr (urj_part_t *p);
 void urj_part_set_instruction (urj_part_t *p, const char *iname);
 /** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val);
@@ -79,6 +88,172 @@ int urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val);
 
 /** @return -1 on error; signal number >= 0 for success */
 int urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s);
+
+/**
+ * Boundary scan cells of a signal, resolved once with
+ * urj_part_signal_resolve() so that urj_part_set_resolved() and
+ * urj_part_get_resolved() touch the BSR directly.  A handle stays valid as
+ * long as the BSR and the boundary bits of the part are not redefined.
+ */
+struct URJ_PART_SIGNAL_HANDLE
+{
+    urj_data_register_t *bsr;
+    int output;                 /**< BSR bit driving the signal, -1 if none */
+    int control;                /**< BSR bit enabling the output, -1 if none */
+    int control_value;          /**< control bit value disabling the output */
+    int input;                  /**< BSR bit sampling the signal, -1 if none */
+};
+
+/** @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
+int urj_part_signal_resolve (urj_part_t *p, const urj_part_signal_t *s,
+                             urj_part_signal_handle_t *h);
+
+/** urj_part_set_signal() for a resolved signal, without error checks */
+static inline void
+urj_part_set_resolved (const urj_part_signal_handle_t *h, int out, int val)
+{
+    if (out && h->output >= 0)
+        urj_tap_register_set_bit (h->bsr->in, h->output, val);
+    if (h->control >= 0)
+        urj_tap_register_set_bit (h->bsr->in, h->control,
+                                  out ? h->control_value ^ 1
+                                  : h->control_value);
+}
+#define urj_part_set_resolved_high(h)   urj_part_set_resolved ((h), 1, 1)
+#define urj_part_set_resolved_low(h)    urj_part_set_resolved ((h), 1, 0)
+#define urj_part_set_resolved_input(h)  urj_part_set_resolved ((h), 0, 0)
+
+/** @return value of a resolved signal; -1 if it has no input */
+static inline int
+urj_part_get_resolved (const urj_part_signal_handle_t *h)
+{
+    if (h->input < 0)
+        return -1;
+
+    return urj_tap_register_get_bit (h->bsr->out, h->input);
+}
+
+/** most signals in a urj_part_signal_vector_t */
+#define URJ_PART_VECTOR_MAX     32
+
+/** vector bits first .. first + len - 1 on consecutive BSR cells */
+typedef struct
+{
+    uint8_t first;
+    uint8_t len;
+    uint8_t reverse;            /**< bit first is on the highest cell */
+    int cell;                   /**< lowest cell of the run */
+}
+urj_part_signal_run_t;
+
+/**
+ * A bus of signals, bit 0 first, set and sampled as one value.  The BSR
+ * cells of the signals are compiled once by urj_part_signal_vector_init()
+ * into runs of consecutive output and input cells, which the accessors
+ * move with shifts and masks of whole words, and into the control cells
+ * of the outputs, each listed once even when it is shared by many
+ * signals.  A vector holds no pointers and needs no cleanup.
+ */
+struct URJ_PART_SIGNAL_VECTOR
+{
+    int width;
+    int out_runs;
+    urj_part_signal_run_t out_run[URJ_PART_VECTOR_MAX];
+    int in_runs;
+    urj_part_signal_run_t in_run[URJ_PART_VECTOR_MAX];
+    int ctrls;
+    struct
+    {
+        uint8_t first;          /**< first vector bit using the cell */
+        uint8_t mask;
+        uint8_t on;             /**< control bit enabling the outputs */
+        uint8_t off;            /**< control bit disabling the outputs */
+        int byte;
+    }
+    ctrl[URJ_PART_VECTOR_MAX];
+};
+
+/**
+ * Build a vector from width signals, the first one is bit 0.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_signal_vector_init (urj_part_t *p, urj_part_signal_vector_t *vec,
+                                 urj_part_signal_t *const *signals, int width);
+/**
+ * Build a vector from the signals between lsb and msb, both named like
+ * "A0" and "A23" (or "A[23]", "BSC007"), counting up or down from lsb.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_signal_vector_define (urj_part_t *p, urj_part_signal_vector_t *vec,
+                                   const char *lsb, const char *msb);
+
+/**
+ * Drive the first n signals of a vector with the bits of value.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_set_vector_n (urj_part_t *p, const urj_part_signal_vector_t *vec,
+                           int n, uint32_t value);
+/**
+ * Switch the outputs of the first n signals of a vector off.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_set_vector_input_n (urj_part_t *p,
+                                 const urj_part_signal_vector_t *vec, int n);
+/**
+ * Sample the first n signals of a vector, signals without input read as 0.
+ * @return value; 0 on error
+ */
+uint32_t urj_part_get_vector_n (urj_part_t *p,
+                                const urj_part_signal_vector_t *vec, int n);
+#define urj_part_set_vector(p, vec, value) \
+    urj_part_set_vector_n ((p), (vec), (vec)->width, (value))
+#define urj_part_set_vector_input(p, vec) \
+    urj_part_set_vector_input_n ((p), (vec), (vec)->width)
+#define urj_part_get_vector(p, vec) \
+    urj_part_get_vector_n ((p), (vec), (vec)->width)
+
+/** most BSR bytes patched by a urj_part_signal_template_t */
+#define URJ_PART_TEMPLATE_MAX   64
+
+/**
+ * The BSR cells a bus cycle drives to fixed levels, such as the chip select,
+ * the strobes and the direction of the data bus, recorded once as masked
+ * bytes of the BSR image and patched into it with urj_part_set_template().
+ * Templates are filled in order, a later level of a cell replaces an
+ * earlier one.
+ */
+struct URJ_PART_SIGNAL_TEMPLATE
+{
+    int len;
+    struct
+    {
+        int byte;
+        uint8_t mask;
+        uint8_t value;
+    }
+    patch[URJ_PART_TEMPLATE_MAX];
+};
+
+/** Empty a template */
+void urj_part_signal_template_init (urj_part_signal_template_t *t);
+/**
+ * Record the cells urj_part_set_signal (p, s, out, val) would set.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_signal_template_add (urj_part_t *p, urj_part_signal_template_t *t,
+                                  urj_part_signal_t *s, int out, int val);
+/**
+ * Record the control cells urj_part_set_vector_input (p, vec) would set.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_signal_template_add_input (urj_part_signal_template_t *t,
+                                        const urj_part_signal_vector_t *vec);
+/**
+ * Patch the cells of a template into the BSR of a part.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_set_template (urj_part_t *p, const urj_part_signal_template_t *t);
+
 /* @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error */
 int urj_part_print (urj_log_level_t ll, urj_part_t *p);
 /**
@@ -98,6 +273,22 @@ urj_part_instruction_t *urj_part_instruction_define (urj_part_t *part,
                                                      const char *code,
                                                      const char *data_register);
 
+/**
+ * Save the signals, signal aliases, instructions, data registers and
+ * boundary bits of a part to a file, tagged with key.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_model_save (const urj_part_t *part, const char *filename,
+                         uint64_t key);
+/**
+ * Load the definitions saved by urj_part_model_save() into a part that has
+ * none yet.  The part is left untouched if the file is missing, damaged or
+ * tagged with another key.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_part_model_load (urj_part_t *part, const char *filename,
+                         uint64_t key);
+
 typedef void (*urj_part_init_func_t) (urj_part_t *);
 
 struct URJ_PART_INIT
@@ -0,0 +1,86 @@
+/*
+ * $Id$
+ *
+ * Compiled index of the part database
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_PARTDB_H
+#define URJ_PARTDB_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+/** file name of the index in the data directory */
+#define URJ_PARTDB_INDEX        "INDEX"
+
+/*
+ * The part database is a tree of text files: MANUFACTURERS maps the
+ * manufacturer ID to a directory, its PARTS maps the part number to a
+ * subdirectory, whose STEPPINGS maps the version to a part description
+ * file.  The index holds all three tables in one hash, keyed by the level
+ * and the ID bits up to that level.
+ */
+typedef enum URJ_PARTDB_LEVEL
+{
+    URJ_PARTDB_MANUFACTURER,    /**< 11 bit manufacturer ID */
+    URJ_PARTDB_PART,            /**< manufacturer ID << 16 | part number */
+    URJ_PARTDB_STEPPING,        /**< manufacturer << 20 | part << 4 | version */
+}
+urj_partdb_level_t;
+
+typedef struct URJ_PARTDB urj_partdb_t;
+
+/**
+ * Search the text table filename for the record of key and hand out its
+ * name (directory or file) and full name, both malloc()ed.
+ * @return 1 if found; 0 otherwise
+ */
+int urj_tap_partdb_find_record (const char *filename,
+                                const urj_tap_register_t *key, char **name,
+                                char **fullname);
+
+/**
+ * Compile the part database under db_path into the index file.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_tap_partdb_compile (const char *db_path, const char *index_file);
+
+/**
+ * Map the index of the part database under db_path.
+ * @return index; NULL if there is none or it is not usable
+ */
+urj_partdb_t *urj_tap_partdb_open (const char *db_path);
+void urj_tap_partdb_close (urj_partdb_t *db);
+
+/**
+ * Check that the text table filename is not newer than the index.
+ * @return 1 if the index covers it; 0 otherwise
+ */
+int urj_tap_partdb_current (const urj_partdb_t *db, const char *filename);
+
+/**
+ * Look up a record in the index and hand out its name and full name like
+ * urj_tap_partdb_find_record() does.
+ * @return 1 if found; 0 otherwise
+ */
+int urj_tap_partdb_lookup (const urj_partdb_t *db, urj_partdb_level_t level,
+                           uint32_t id, char **name, char **fullname);
+
+#endif /* URJ_PARTDB_H */
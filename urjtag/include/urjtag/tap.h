@@ -26,6 +26,7 @@
 #define URJ_TAP_H
 
 #include "types.h"
+#include "cable.h"
 
 void urj_tap_reset (urj_chain_t *chain);
 void urj_tap_trst_reset (urj_chain_t *chain);
@@ -36,6 +37,23 @@ void urj_tap_capture_ir (urj_chain_t *chain);
 void urj_tap_defer_shift_register (urj_chain_t *chain,
                                    const urj_tap_register_t *in,
                                    urj_tap_register_t *out, int tap_exit);
+/**
+ * Same as urj_tap_defer_shift_register, but the TDO bits are picked up with
+ * urj_tap_cable_ticket_wait instead of urj_tap_shift_register_output.  Only
+ * shifts that leave Shift-DR/IR in the cable transfer can be ticketed: out
+ * is required and as long as in, and tap_exit is not
+ * URJ_CHAIN_EXITMODE_SHIFT.  The registers are not copied: in must stay
+ * unchanged, and in and out allocated, until the ticket has been waited
+ * for.
+ *
+ * @return ticket on success; URJ_CABLE_NO_TICKET on error
+ */
+urj_cable_ticket_t urj_tap_defer_shift_register_ticket (urj_chain_t *chain,
+                                                        const
+                                                        urj_tap_register_t
+                                                        *in,
+                                                        urj_tap_register_t
+                                                        *out, int tap_exit);
 void urj_tap_shift_register_output (urj_chain_t *chain,
                                     const urj_tap_register_t *in,
                                     urj_tap_register_t *out, int tap_exit);
@@ -28,13 +28,41 @@
 #include "types.h"
 #include <stdint.h>
 
+/*
+ * Register bits are stored packed, LSB first: bit n of the register lives in
+ * bit (n % 8) of packed[n / 8].  This is the same layout the cable drivers
+ * use on the wire, so a register can be handed to a cable without repacking.
+ * The buffer is padded to a whole number of machine words and the padding
+ * bits are always kept zero, which allows whole-register operations to work
+ * on bytes or words instead of single bits.
+ */
 struct URJ_TAP_REGISTER
 {
-    char *data;         /* (public, r/w) register data */
+    uint8_t *packed;    /* (public, r/w) register data, see above */
     int len;            /* (public, r/o) register length */
     char *string;       /* (private) string representation of register data */
 };
 
+/** number of bytes needed to hold len packed bits */
+#define URJ_TAP_REGISTER_BYTES(len)     (((len) + 7) / 8)
+
+/** @return value (0 or 1) of bit n of the register */
+static inline int
+urj_tap_register_get_bit (const urj_tap_register_t *tr, int n)
+{
+    return (tr->packed[n >> 3] >> (n & 7)) & 1;
+}
+
+/** set bit n of the register to val & 1 */
+static inline void
+urj_tap_register_set_bit (urj_tap_register_t *tr, int n, int val)
+{
+    if (val & 1)
+        tr->packed[n >> 3] |= 1 << (n & 7);
+    else
+        tr->packed[n >> 3] &= ~(1 << (n & 7));
+}
+
 urj_tap_register_t *urj_tap_register_alloc (int len);
 urj_tap_register_t *urj_tap_register_realloc (urj_tap_register_t *tr, int new_len);
 urj_tap_register_t *urj_tap_register_duplicate (const urj_tap_register_t *tr);
@@ -60,4 +88,28 @@ urj_tap_register_t *urj_tap_register_shift_right (urj_tap_register_t *tr,
 urj_tap_register_t *urj_tap_register_shift_left (urj_tap_register_t *tr,
                                                  int shift);
 
+/*
+ * Compatibility view for code that works on one char per bit (0 or 1),
+ * e.g. cable drivers that still implement the unpacked transfer().
+ */
+/** copy len bits of register tr starting at bit first into bits[] */
+void urj_tap_register_get_bits (const urj_tap_register_t *tr, char *bits,
+                                int first, int len);
+/** copy len chars of bits[] into register tr starting at bit first */
+void urj_tap_register_set_bits (urj_tap_register_t *tr, const char *bits,
+                                int first, int len);
+
+/*
+ * Helpers for raw packed bit buffers (same layout as the register storage).
+ * Bits outside the destination range are left untouched.
+ */
+/** copy len bits from src (starting at bit src_off) to dst at bit dst_off */
+void urj_tap_bits_copy (uint8_t *dst, int dst_off, const uint8_t *src,
+                        int src_off, int len);
+/** pack len chars (one per bit) into dst starting at bit dst_off */
+void urj_tap_bits_pack (uint8_t *dst, int dst_off, const char *src, int len);
+/** unpack len bits of src starting at bit src_off into chars (one per bit) */
+void urj_tap_bits_unpack (char *dst, const uint8_t *src, int src_off,
+                          int len);
+
 #endif /* URJ_REGISTER_H */
@@ -62,5 +62,13 @@ int urj_tap_state_done (urj_chain_t *chain);
 int urj_tap_state_reset (urj_chain_t *chain);
 int urj_tap_state_set_trst (urj_chain_t *chain, int old_trst, int new_trst);
 int urj_tap_state_clock (urj_chain_t *chain, int tms);
+/**
+ * Queue the shortest TMS sequence from the current state to state, as
+ * one packed sequence for the cable.  An unknown current state is left
+ * through Test-Logic-Reset first, with five clocks of TMS high; this
+ * resets the instruction registers of the parts.
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on failure
+ */
+int urj_tap_goto_state (urj_chain_t *chain, int state);
 
 #endif /* URJ_TAP_STATE_H */
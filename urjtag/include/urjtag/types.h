@@ -38,6 +38,10 @@ typedef struct URJ_PART_SIGNAL urj_part_signal_t;
 typedef struct URJ_PART_SALIAS urj_part_salias_t;
 typedef struct URJ_PART_INSTRUCTION urj_part_instruction_t;
 typedef struct URJ_PART_PARAMS urj_part_params_t;
+typedef struct URJ_PART_INDEX urj_part_index_t;
+typedef struct URJ_PART_SIGNAL_HANDLE urj_part_signal_handle_t;
+typedef struct URJ_PART_SIGNAL_VECTOR urj_part_signal_vector_t;
+typedef struct URJ_PART_SIGNAL_TEMPLATE urj_part_signal_template_t;
 typedef struct URJ_PART_INIT urj_part_init_t;
 typedef struct URJ_DATA_REGISTER urj_data_register_t;
 typedef struct URJ_BSBIT urj_bsbit_t;
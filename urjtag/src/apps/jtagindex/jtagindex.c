@@ -0,0 +1,58 @@
+/*
+ * $Id$
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <urjtag/log.h>
+#include <urjtag/error.h>
+#include <urjtag/partdb.h>
+
+
+static void
+usage (void)
+{
+    puts ("Usage:  jtagindex <db-dir> <index-file>");
+    puts ("Compiles the part database into an index for detect.\n");
+    puts ("Parameters");
+    puts ("  db-dir     : Directory holding the MANUFACTURERS table");
+    puts ("  index-file : Name of the index, " URJ_PARTDB_INDEX
+          " in db-dir to be used");
+    puts ("");
+}
+
+
+int
+main (int argc, char *const argv[])
+{
+    if (argc != 3)
+    {
+        usage ();
+        return 1;
+    }
+
+    if (urj_tap_partdb_compile (argv[1], argv[2]) != URJ_STATUS_OK)
+    {
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+        return 1;
+    }
+
+    return 0;
+}
@@ -452,16 +452,19 @@ emuir_init_value (urj_tap_register_t *r, uint64_t insn)
     {
         if ((insn & 0xffffffffffff0000ULL) == 0)
         {
-            r->data[0] = 0;
-            r->data[1] = 1;
+            urj_tap_register_set_bit (r, 0, 0);
+            urj_tap_register_set_bit (r, 1, 1);
         }
         else if ((insn & 0xffffffff00000000ULL) == 0)
         {
-            r->data[0] = 1;
-            r->data[1] = 0;
+            urj_tap_register_set_bit (r, 0, 1);
+            urj_tap_register_set_bit (r, 1, 0);
         }
         else
-            r->data[0] = r->data[1] = 1;
+        {
+            urj_tap_register_set_bit (r, 0, 1);
+            urj_tap_register_set_bit (r, 1, 1);
+        }
     }
 }
 
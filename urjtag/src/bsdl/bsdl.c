@@ -43,6 +43,8 @@
 #include "bsdl_parser.h"
 
 #include "bsdl_msg.h"
+#include "bsdl_index.h"
+#include "bsdl_pool.h"
 
 #ifdef DMALLOC
 #include "dmalloc.h"
@@ -66,9 +68,9 @@
  *   > 0 : No errors, idcode checked and matched
  *
  ****************************************************************************/
-int
-urj_bsdl_read_file (urj_chain_t *chain, const char *BSDL_File_Name,
-                    int proc_mode, const char *idcode)
+static int
+bsdl_read_file (urj_chain_t *chain, const char *BSDL_File_Name,
+                int proc_mode, const char *idcode, char **file_idcode)
 {
     urj_bsdl_globs_t *globs = &(chain->bsdl);
     FILE *BSDL_File;
@@ -78,12 +80,14 @@ urj_bsdl_read_file (urj_chain_t *chain, const char *BSDL_File_Name,
     int result = 0;
 
     /* purge previous errors */
-    urj_error_reset ();
+    if (!(proc_mode & URJ_BSDL_MODE_WORKER))
+        urj_error_reset ();
 
     if (globs->debug)
         proc_mode |= URJ_BSDL_MODE_MSG_ALL;
 
     jtag_ctrl.proc_mode = proc_mode;
+    jtag_ctrl.idcode_ret = file_idcode;
 
     /* perform some basic checks */
     if (proc_mode & URJ_BSDL_MODE_INSTR_EXEC)
@@ -160,6 +164,40 @@ urj_bsdl_read_file (urj_chain_t *chain, const char *BSDL_File_Name,
     return Compile_Errors == 0 ? result : -1;
 }
 
+int
+urj_bsdl_read_file (urj_chain_t *chain, const char *BSDL_File_Name,
+                    int proc_mode, const char *idcode)
+{
+    return bsdl_read_file (chain, BSDL_File_Name, proc_mode, idcode, NULL);
+}
+
+
+/*****************************************************************************
+ * urj_bsdl_read_job( chain, job, proc_mode )
+ *
+ * Reads the file of a job without applying it and notes the result and
+ * the IDCODE of the file in the job.  This may run on a worker thread.
+ *
+ * Parameters
+ *   chain     : pointer to active chain structure
+ *   job       : job of the file to read
+ *   proc_mode : processing mode, without BSDL_MODE_INSTR_EXEC
+ *
+ ****************************************************************************/
+void
+urj_bsdl_read_job (urj_chain_t *chain, urj_bsdl_job_t *job, int proc_mode)
+{
+    job->idcode = NULL;
+    job->result = bsdl_read_file (chain, job->name,
+                                  proc_mode | URJ_BSDL_MODE_WORKER, NULL,
+                                  &job->idcode);
+    if (job->result < 0)
+    {
+        free (job->idcode);
+        job->idcode = NULL;
+    }
+}
+
 
 /*****************************************************************************
  * void urj_bsdl_set_path( chain, pathlist )
@@ -228,6 +266,247 @@ urj_bsdl_set_path (urj_chain_t *chain, const char *pathlist)
 }
 
 
+/*****************************************************************************
+ * scan_dir_pool( chain, d, dir, proc_mode )
+ *
+ * Does a test read on all files of the open directory d on the worker
+ * pool and prints
+ * their messages in the order of the directory, like scan_dir without
+ * an idcode would.
+ *
+ * Returns
+ *   see urj_bsdl_scan_files
+ *
+ ****************************************************************************/
+static int
+scan_dir_pool (urj_chain_t *chain, DIR *d, const char *dir, int proc_mode)
+{
+    struct dirent *elem;
+    urj_bsdl_job_t *jobs = NULL;
+    int n = 0, max_n = 0;
+    int result = 0;
+    int i;
+
+    while ((elem = readdir (d)))
+    {
+        struct stat buf;
+        char *name;
+
+        if (strncmp (elem->d_name, URJ_BSDL_INDEX_FILE,
+                     strlen (URJ_BSDL_INDEX_FILE)) == 0)
+            continue;
+
+        name = malloc (strlen (dir) + strlen (elem->d_name) + 1 + 1);
+        if (name == NULL)
+            break;
+        strcpy (name, dir);
+        strcat (name, "/");
+        strcat (name, elem->d_name);
+
+        if (stat (name, &buf) != 0 || !(buf.st_mode & S_IFREG))
+        {
+            free (name);
+            continue;
+        }
+
+        if (n == max_n)
+        {
+            urj_bsdl_job_t *j;
+
+            max_n = max_n ? 2 * max_n : 64;
+            j = realloc (jobs, max_n * sizeof *jobs);
+            if (j == NULL)
+            {
+                free (name);
+                break;
+            }
+            jobs = j;
+        }
+        jobs[n++].name = name;
+    }
+
+    urj_bsdl_pool_run (chain, jobs, n, proc_mode);
+
+    for (i = 0; i < n; i++)
+    {
+        urj_bsdl_job_flush (&jobs[i]);
+        result = jobs[i].result;
+        free ((char *) jobs[i].name);
+        free (jobs[i].idcode);
+    }
+    free (jobs);
+
+    return result;
+}
+
+
+/*****************************************************************************
+ * scan_dir( chain, dir, idcode, proc_mode )
+ *
+ * Does a test read on each file in dir until one matches idcode.
+ *
+ * Returns
+ *   see urj_bsdl_scan_files
+ *
+ ****************************************************************************/
+static int
+scan_dir (urj_chain_t *chain, const char *dir, const char *idcode,
+          int proc_mode)
+{
+    DIR *d;
+    struct dirent *elem;
+    int result = 0;
+
+    if ((d = opendir (dir)) == NULL)
+    {
+        urj_bsdl_warn (proc_mode, _("Cannot open directory %s\n"), dir);
+        return 0;
+    }
+
+    /* without an idcode every file is read, they can go in parallel */
+    if (idcode == NULL && !(proc_mode & URJ_BSDL_MODE_INSTR_EXEC))
+    {
+        result = scan_dir_pool (chain, d, dir, proc_mode);
+        closedir (d);
+        return result;
+    }
+
+    /* run through all elements in the current directory */
+    while ((elem = readdir (d)) && (result <= 0))
+    {
+        char *name;
+
+        if (strncmp (elem->d_name, URJ_BSDL_INDEX_FILE,
+                     strlen (URJ_BSDL_INDEX_FILE)) == 0)
+            continue;
+
+        /* @@@@ RFHH handle malloc error result */
+        name = malloc (strlen (dir) + strlen (elem->d_name) + 1 + 1);
+        if (name)
+        {
+            struct stat buf;
+
+            strcpy (name, dir);
+            strcat (name, "/");
+            strcat (name, elem->d_name);
+
+            if (stat (name, &buf) == 0)
+            {
+                if (buf.st_mode & S_IFREG)
+                {
+                    result = urj_bsdl_read_file (chain, name, proc_mode,
+                                                 idcode);
+                    if (result == 1)
+                        printf (_("  Filename:     %s\n"), name);
+                }
+            }
+
+            free (name);
+        }
+    }
+
+    closedir (d);
+
+    return result;
+}
+
+
+/*****************************************************************************
+ * file_hash( name, hash )
+ *
+ * Computes the 64 bit FNV-1a hash of the contents of a file.
+ *
+ * Returns
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ *
+ ****************************************************************************/
+static int
+file_hash (const char *name, uint64_t *hash)
+{
+    uint8_t buf[4096];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t n, i;
+    FILE *f;
+    int err;
+
+    f = fopen (name, FOPEN_R);
+    if (f == NULL)
+        return URJ_STATUS_FAIL;
+
+    while ((n = fread (buf, 1, sizeof buf, f)) > 0)
+        for (i = 0; i < n; i++)
+            h = (h ^ buf[i]) * 0x100000001b3ULL;
+
+    err = ferror (f);
+    fclose (f);
+    *hash = h;
+
+    return err ? URJ_STATUS_FAIL : URJ_STATUS_OK;
+}
+
+
+/*****************************************************************************
+ * scan_index( chain, dir, index, idcode, proc_mode )
+ *
+ * Reads only the files in dir whose indexed IDCODE matches idcode.
+ * When the part gets configured, the result is kept as a part model next
+ * to the index, so the next time the file needs not be parsed at all.
+ *
+ * Returns
+ *   see urj_bsdl_scan_files
+ *
+ ****************************************************************************/
+static int
+scan_index (urj_chain_t *chain, const char *dir,
+            const urj_bsdl_index_t *index, const char *idcode, int proc_mode)
+{
+    char name[1024];
+    char model[1024];
+    int result = 0;
+    int i;
+
+    for (i = 0; i < index->len && result <= 0; i++)
+    {
+        uint64_t hash;
+        int have_hash;
+
+        if (!urj_bsdl_index_match (&index->entry[i], idcode))
+            continue;
+
+        snprintf (name, sizeof name, "%s/%s", dir, index->entry[i].name);
+        snprintf (model, sizeof model, "%s/%s.%s", dir, URJ_BSDL_INDEX_FILE,
+                  index->entry[i].name);
+
+        have_hash = (proc_mode & URJ_BSDL_MODE_INSTR_EXEC) && chain->parts
+            && file_hash (name, &hash) == URJ_STATUS_OK;
+        if (have_hash
+            && urj_part_model_load (chain->parts->parts[chain->active_part],
+                                    model, hash) == URJ_STATUS_OK)
+        {
+            urj_bsdl_msg (proc_mode, _("Loaded part model '%s'\n"), model);
+            result = 1;
+        }
+        else
+        {
+            urj_error_reset ();
+            result = urj_bsdl_read_file (chain, name, proc_mode, idcode);
+            if (result == 1 && have_hash
+                && urj_part_model_save (chain->parts->parts[chain->active_part],
+                                        model, hash) != URJ_STATUS_OK)
+            {
+                urj_bsdl_msg (proc_mode, _("Cannot write part model '%s'\n"),
+                              model);
+                urj_error_reset ();
+            }
+        }
+        if (result == 1)
+            printf (_("  Filename:     %s\n"), name);
+    }
+
+    return result;
+}
+
+
 /*****************************************************************************
  * urj_bsdl_scan_files( chain, idcode, proc_mode )
  *
@@ -236,6 +515,10 @@ urj_bsdl_set_path (urj_chain_t *chain, const char *pathlist)
  * If mode >= 1 is requested, it will read the first BSDL file with matching
  * idcode in "execute" mode. I.e. all extracted statements are applied to
  * the current part.
+ * When looking for an idcode, only the files listed for it in the index of
+ * each directory are read.  The index is created or updated as needed;
+ * a directory whose index cannot be written is scanned up to the first
+ * match instead.
  *
  * Parameters
  *   chain     : pointer to active chain structure
@@ -261,49 +544,20 @@ urj_bsdl_scan_files (urj_chain_t *chain, const char *idcode, int proc_mode)
 
     while (globs->path_list[idx] && (result <= 0))
     {
-        DIR *dir;
+        urj_bsdl_index_t *index = NULL;
 
-        if ((dir = opendir (globs->path_list[idx])))
+        if (idcode)
+            index = urj_bsdl_index_update (chain, globs->path_list[idx],
+                                           proc_mode);
+        if (index)
         {
-            struct dirent *elem;
-
-            /* run through all elements in the current directory */
-            while ((elem = readdir (dir)) && (result <= 0))
-            {
-                char *name;
-
-                /* @@@@ RFHH handle malloc error result */
-                name = malloc (strlen (globs->path_list[idx])
-                               + strlen (elem->d_name) + 1 + 1);
-                if (name)
-                {
-                    struct stat buf;
-
-                    strcpy (name, globs->path_list[idx]);
-                    strcat (name, "/");
-                    strcat (name, elem->d_name);
-
-                    if (stat (name, &buf) == 0)
-                    {
-                        if (buf.st_mode & S_IFREG)
-                        {
-                            result = urj_bsdl_read_file (chain, name, proc_mode,
-                                                         idcode);
-                            if (result == 1)
-                                printf (_("  Filename:     %s\n"), name);
-                        }
-                    }
-
-                    free (name);
-                }
-            }
-
-            closedir (dir);
+            result = scan_index (chain, globs->path_list[idx], index, idcode,
+                                 proc_mode);
+            urj_bsdl_index_free (index);
         }
         else
-            urj_bsdl_warn (proc_mode,
-                           _("Cannot open directory %s\n"),
-                           globs->path_list[idx]);
+            result = scan_dir (chain, globs->path_list[idx], idcode,
+                               proc_mode);
 
         idx++;
     }
@@ -312,6 +566,62 @@ urj_bsdl_scan_files (urj_chain_t *chain, const char *idcode, int proc_mode)
 }
 
 
+/*****************************************************************************
+ * urj_bsdl_index( chain )
+ *
+ * Creates or updates the IDCODE index of each directory in bsdl_path_list.
+ *
+ * Parameters
+ *   chain     : pointer to active chain structure
+ *
+ * Returns
+ *   URJ_STATUS_OK, URJ_STATUS_FAIL
+ *
+ ****************************************************************************/
+int
+urj_bsdl_index (urj_chain_t *chain)
+{
+    urj_bsdl_globs_t *globs = &(chain->bsdl);
+    int proc_mode = URJ_BSDL_MODE_MSG_WARN;
+    int idx;
+
+    if (globs->path_list == NULL)
+    {
+        urj_error_set (URJ_ERROR_BSDL_BSDL, _("No BSDL path set"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (globs->debug)
+        proc_mode |= URJ_BSDL_MODE_MSG_ALL;
+
+    for (idx = 0; globs->path_list[idx]; idx++)
+    {
+        urj_bsdl_index_t *index;
+        int i, n;
+
+        index = urj_bsdl_index_update (chain, globs->path_list[idx],
+                                       proc_mode);
+        if (index == NULL)
+        {
+            urj_bsdl_warn (proc_mode, _("Cannot index directory %s\n"),
+                           globs->path_list[idx]);
+            continue;
+        }
+
+        for (i = n = 0; i < index->len; i++)
+            if (index->entry[i].idcode)
+                n++;
+        urj_log (URJ_LOG_LEVEL_NORMAL,
+                 _("%s: %d files, %d with IDCODE\n"),
+                 globs->path_list[idx], index->len, n);
+
+        urj_bsdl_index_free (index);
+    }
+
+    return URJ_STATUS_OK;
+}
+
+
 /*
  Local Variables:
  mode:C
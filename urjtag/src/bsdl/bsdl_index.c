@@ -0,0 +1,367 @@
+/*
+ * $Id$
+ *
+ * IDCODE index of the files in a BSDL directory
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <urjtag/chain.h>
+
+#include "bsdl_index.h"
+#include "bsdl_pool.h"
+#include "bsdl_msg.h"
+
+/*
+ * The index is a text file with one line per file of the directory:
+ *   <mtime> <size> <IDCODE pattern or -> <file name>
+ */
+
+
+static int
+compare_entry (const void *a, const void *b)
+{
+    const urj_bsdl_index_entry_t *ea = a;
+    const urj_bsdl_index_entry_t *eb = b;
+
+    return strcmp (ea->name, eb->name);
+}
+
+
+static urj_bsdl_index_entry_t *
+index_add (urj_bsdl_index_t *index, const char *name, long mtime, long size,
+           const char *idcode)
+{
+    urj_bsdl_index_entry_t *e;
+
+    if (index->len == index->max_len)
+    {
+        int max_len = index->max_len ? 2 * index->max_len : 64;
+
+        e = realloc (index->entry, max_len * sizeof *e);
+        if (e == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("realloc(%s,%zd) fails"),
+                           "index->entry", max_len * sizeof *e);
+            return NULL;
+        }
+        index->entry = e;
+        index->max_len = max_len;
+    }
+
+    e = &index->entry[index->len];
+    e->name = strdup (name);
+    e->idcode = idcode ? strdup (idcode) : NULL;
+    if (e->name == NULL || (idcode && e->idcode == NULL))
+    {
+        free (e->name);
+        free (e->idcode);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "strdup() fails");
+        return NULL;
+    }
+    e->mtime = mtime;
+    e->size = size;
+    e->seen = 0;
+    index->len++;
+
+    return e;
+}
+
+
+static void
+index_load (urj_bsdl_index_t *index, const char *filename)
+{
+    FILE *file;
+    char *line = NULL;
+    size_t len;
+
+    file = fopen (filename, FOPEN_R);
+    if (file == NULL)
+        return;
+
+    while (getline (&line, &len, file) != -1)
+    {
+        char idcode[64];
+        long mtime, size;
+        char *p;
+        int n;
+
+        p = strchr (line, '\n');
+        if (p)
+            *p = '\0';
+        if (line[0] == '#')
+            continue;
+
+        if (sscanf (line, "%ld %ld %63s %n", &mtime, &size, idcode, &n) != 3
+            || line[n] == '\0')
+            continue;
+
+        if (index_add (index, line + n, mtime, size,
+                       strcmp (idcode, "-") ? idcode : NULL) == NULL)
+            break;
+    }
+    free (line);
+    fclose (file);
+}
+
+
+static int
+index_save (const urj_bsdl_index_t *index, const char *filename)
+{
+    char tmpname[1024 + sizeof ".new"];
+    FILE *file;
+    int i;
+
+    snprintf (tmpname, sizeof tmpname, "%s.new", filename);
+    file = fopen (tmpname, FOPEN_W);
+    if (file == NULL)
+        return URJ_STATUS_FAIL;
+
+    fprintf (file, "# BSDL IDCODE index, maintained by UrJTAG\n");
+    for (i = 0; i < index->len; i++)
+    {
+        const urj_bsdl_index_entry_t *e = &index->entry[i];
+
+        fprintf (file, "%ld %ld %s %s\n", e->mtime, e->size,
+                 e->idcode ? e->idcode : "-", e->name);
+    }
+
+    if (fclose (file) != 0)
+    {
+        remove (tmpname);
+        return URJ_STATUS_FAIL;
+    }
+
+    /* rename() does not replace an existing file on all hosts */
+    if (rename (tmpname, filename) != 0)
+    {
+        remove (filename);
+        if (rename (tmpname, filename) != 0)
+        {
+            remove (tmpname);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    return URJ_STATUS_OK;
+}
+
+
+urj_bsdl_index_t *
+urj_bsdl_index_update (urj_chain_t *chain, const char *dir, int proc_mode)
+{
+    urj_bsdl_index_t *index;
+    char filename[1024];
+    char name[1024];
+    DIR *d;
+    struct dirent *elem;
+    urj_bsdl_job_t *jobs = NULL;
+    int *job_entry = NULL;
+    int n = 0, max_n = 0;
+    int changed = 0;
+    int old_len;
+    int i, j;
+
+    index = calloc (1, sizeof *index);
+    if (index == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd,%zd) fails"),
+                       (size_t) 1, sizeof *index);
+        return NULL;
+    }
+
+    d = opendir (dir);
+    if (d == NULL)
+    {
+        free (index);
+        return NULL;
+    }
+
+    snprintf (filename, sizeof filename, "%s/%s", dir, URJ_BSDL_INDEX_FILE);
+    index_load (index, filename);
+    qsort (index->entry, index->len, sizeof *index->entry, compare_entry);
+    old_len = index->len;
+
+    while ((elem = readdir (d)))
+    {
+        urj_bsdl_index_entry_t key, *e;
+        struct stat buf;
+
+        if (strncmp (elem->d_name, URJ_BSDL_INDEX_FILE,
+                     strlen (URJ_BSDL_INDEX_FILE)) == 0)
+            continue;
+
+        snprintf (name, sizeof name, "%s/%s", dir, elem->d_name);
+        if (stat (name, &buf) != 0 || !S_ISREG (buf.st_mode))
+            continue;
+
+        key.name = elem->d_name;
+        e = bsearch (&key, index->entry, old_len, sizeof *index->entry,
+                     compare_entry);
+        if (e && e->mtime == (long) buf.st_mtime
+            && e->size == (long) buf.st_size)
+        {
+            e->seen = 1;
+            continue;
+        }
+
+        /* new or changed file; files without an IDCODE or with errors are
+           indexed too, so they are not parsed again until they change */
+        if (n == max_n)
+        {
+            urj_bsdl_job_t *jb;
+            int *je;
+
+            max_n = max_n ? 2 * max_n : 64;
+            jb = realloc (jobs, max_n * sizeof *jobs);
+            if (jb)
+                jobs = jb;
+            je = realloc (job_entry, max_n * sizeof *job_entry);
+            if (je)
+                job_entry = je;
+            if (jb == NULL || je == NULL)
+                goto fail;
+        }
+        if (e)
+        {
+            free (e->idcode);
+            e->idcode = NULL;
+            e->mtime = buf.st_mtime;
+            e->size = buf.st_size;
+        }
+        else
+        {
+            e = index_add (index, elem->d_name, buf.st_mtime, buf.st_size,
+                           NULL);
+            if (e == NULL)
+                goto fail;
+        }
+        e->seen = 1;
+        jobs[n].name = strdup (name);
+        if (jobs[n].name == NULL)
+            goto fail;
+        job_entry[n++] = e - index->entry;
+        changed = 1;
+    }
+
+    /* the index of a read-only library cannot be kept; rather than parse
+       every new file on each use, leave it to the scan that stops at the
+       first match */
+    if (n > 0 && access (dir, W_OK) != 0)
+    {
+        urj_bsdl_msg (proc_mode, _("Cannot write index '%s'\n"), filename);
+        goto fail;
+    }
+    closedir (d);
+
+    /* parse the files for their IDCODE, on the worker pool */
+    for (i = 0; i < n; i++)
+        urj_bsdl_msg (proc_mode, _("Indexing '%s'\n"), jobs[i].name);
+    urj_bsdl_pool_run (chain, jobs, n, URJ_BSDL_MODE_SYN_CHECK);
+    for (i = 0; i < n; i++)
+    {
+        urj_bsdl_job_flush (&jobs[i]);
+        index->entry[job_entry[i]].idcode = jobs[i].idcode;
+        free ((char *) jobs[i].name);
+    }
+    free (jobs);
+    free (job_entry);
+
+    /* drop the entries of removed files */
+    for (i = j = 0; i < index->len; i++)
+    {
+        if (index->entry[i].seen)
+            index->entry[j++] = index->entry[i];
+        else
+        {
+            free (index->entry[i].name);
+            free (index->entry[i].idcode);
+            changed = 1;
+        }
+    }
+    index->len = j;
+
+    if (changed)
+    {
+        qsort (index->entry, index->len, sizeof *index->entry,
+               compare_entry);
+
+        if (index_save (index, filename) != URJ_STATUS_OK)
+        {
+            urj_bsdl_msg (proc_mode, _("Cannot write index '%s'\n"),
+                          filename);
+            urj_bsdl_index_free (index);
+            return NULL;
+        }
+    }
+
+    return index;
+
+ fail:
+    closedir (d);
+    for (i = 0; i < n; i++)
+        free ((char *) jobs[i].name);
+    free (jobs);
+    free (job_entry);
+    urj_bsdl_index_free (index);
+    return NULL;
+}
+
+
+void
+urj_bsdl_index_free (urj_bsdl_index_t *index)
+{
+    int i;
+
+    if (index == NULL)
+        return;
+
+    for (i = 0; i < index->len; i++)
+    {
+        free (index->entry[i].name);
+        free (index->entry[i].idcode);
+    }
+    free (index->entry);
+    free (index);
+}
+
+
+int
+urj_bsdl_index_match (const urj_bsdl_index_entry_t *e, const char *idcode)
+{
+    size_t i;
+
+    /* same rules as compare_idcode() in bsdl_sem.c */
+    if (e->idcode == NULL || strlen (e->idcode) != strlen (idcode))
+        return 0;
+
+    for (i = 0; idcode[i]; i++)
+        if (e->idcode[i] != 'X' && e->idcode[i] != idcode[i])
+            return 0;
+
+    return 1;
+}
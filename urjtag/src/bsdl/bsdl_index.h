@@ -0,0 +1,61 @@
+/*
+ * $Id$
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_BSDL_INDEX_H
+#define URJ_BSDL_INDEX_H
+
+#include <urjtag/types.h>
+
+/* name of the index file in each directory of the BSDL path; files whose
+   name starts with it are not BSDL files */
+#define URJ_BSDL_INDEX_FILE ".bsdl_index"
+
+typedef struct
+{
+    char *name;                 /* file name within the directory */
+    long mtime;                 /* modification time and size when */
+    long size;                  /*   the file was parsed */
+    char *idcode;               /* IDCODE pattern, NULL if there is none */
+    int seen;                   /* file still present */
+}
+urj_bsdl_index_entry_t;
+
+typedef struct
+{
+    urj_bsdl_index_entry_t *entry;      /* sorted by name */
+    int len;
+    int max_len;
+}
+urj_bsdl_index_t;
+
+/*
+ * Load the index of dir and bring it up to date: files that are new or
+ * changed since they were indexed are parsed for their IDCODE on the
+ * worker pool, entries of removed files are dropped.  The index is
+ * written back if it changed.
+ * Returns NULL if dir cannot be read or the index cannot be written.
+ */
+urj_bsdl_index_t *urj_bsdl_index_update (urj_chain_t *, const char *, int);
+void urj_bsdl_index_free (urj_bsdl_index_t *);
+
+/* @return 1 if idcode matches the pattern of an entry; 0 otherwise */
+int urj_bsdl_index_match (const urj_bsdl_index_entry_t *, const char *);
+
+#endif /* URJ_BSDL_INDEX_H */
@@ -53,16 +53,21 @@
             urj_log (URJ_LOG_LEVEL_ERROR, __VA_ARGS__);}        \
     } while (0)
 
-#define urj_bsdl_err_set(proc_mode, err, ...)  \
-    do {                                       \
-        if (proc_mode & URJ_BSDL_MODE_MSG_ERR) \
-            urj_error_set (err, __VA_ARGS__);  \
+/* set on worker threads, which must leave the error state alone */
+#define URJ_BSDL_MODE_WORKER       (1 << 15)
+
+#define urj_bsdl_err_set(proc_mode, err, ...)       \
+    do {                                            \
+        if ((proc_mode & URJ_BSDL_MODE_MSG_ERR)     \
+            && !(proc_mode & URJ_BSDL_MODE_WORKER)) \
+            urj_error_set (err, __VA_ARGS__);       \
     } while (0)
 
-#define urj_bsdl_ftl_set(proc_mode, err, ...)    \
-    do {                                         \
-        if (proc_mode & URJ_BSDL_MODE_MSG_FATAL) \
-            urj_error_set (err, __VA_ARGS__);    \
+#define urj_bsdl_ftl_set(proc_mode, err, ...)       \
+    do {                                            \
+        if ((proc_mode & URJ_BSDL_MODE_MSG_FATAL)   \
+            && !(proc_mode & URJ_BSDL_MODE_WORKER)) \
+            urj_error_set (err, __VA_ARGS__);       \
     } while (0)
 
 #endif /* URJ_BSDL_MSG_H */
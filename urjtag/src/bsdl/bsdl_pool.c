@@ -0,0 +1,287 @@
+/*
+ * $Id$
+ *
+ * Reading BSDL files on a pool of worker threads
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <urjtag/chain.h>
+#include <urjtag/log.h>
+
+#include "bsdl_pool.h"
+
+/*
+ * The parser reports through urj_log(), which writes to the terminal at
+ * once.  While the pool runs, the output functions of the log are
+ * replaced by ones that append the messages of a worker to the log of
+ * its current job.  The log is a sequence of strings, each starting with
+ * 'O' or 'E' for the stream it goes to.
+ */
+
+
+static void
+job_reset (urj_bsdl_job_t *job)
+{
+    job->result = 0;
+    job->idcode = NULL;
+    job->log = NULL;
+    job->log_len = 0;
+    job->log_size = 0;
+    job->log_err = 0;
+}
+
+
+static int
+job_log (urj_bsdl_job_t *job, int err, const char *fmt, va_list ap)
+{
+    va_list aq;
+    size_t size;
+    int len;
+
+    va_copy (aq, ap);
+    len = vsnprintf (NULL, 0, fmt, aq);
+    va_end (aq);
+    if (len < 0)
+        return len;
+
+    /* room for the text, its terminator and the marker of a new string */
+    size = job->log_len + len + 3;
+    if (size > job->log_size)
+    {
+        char *log;
+
+        if (size < 2 * job->log_size)
+            size = 2 * job->log_size;
+        log = realloc (job->log, size);
+        if (log == NULL)
+            return -1;
+        job->log = log;
+        job->log_size = size;
+    }
+
+    if (job->log_len == 0 || job->log_err != err)
+    {
+        if (job->log_len)
+            job->log_len++;
+        job->log[job->log_len++] = err ? 'E' : 'O';
+        job->log_err = err;
+    }
+    vsnprintf (job->log + job->log_len, len + 1, fmt, ap);
+    job->log_len += len;
+
+    return len;
+}
+
+
+static int
+log_printf (int (*p) (const char *, va_list), const char *fmt, ...)
+{
+    va_list ap;
+    int r;
+
+    va_start (ap, fmt);
+    r = (*p) (fmt, ap);
+    va_end (ap);
+
+    return r;
+}
+
+
+void
+urj_bsdl_job_flush (urj_bsdl_job_t *job)
+{
+    size_t i;
+
+    for (i = 0; i < job->log_len; i += strlen (job->log + i) + 1)
+        log_printf (job->log[i] == 'E' ? urj_log_state.err_vprintf
+                    : urj_log_state.out_vprintf, "%s", job->log + i + 1);
+
+    free (job->log);
+    job->log = NULL;
+    job->log_len = 0;
+    job->log_size = 0;
+}
+
+
+#ifdef HAVE_PTHREAD
+
+typedef struct
+{
+    urj_chain_t *chain;
+    urj_bsdl_job_t *jobs;
+    int n;
+    int proc_mode;
+    pthread_mutex_t lock;
+    int next;                   /* next job to hand out */
+}
+pool_t;
+
+static pthread_key_t job_key;
+static pthread_once_t job_key_once = PTHREAD_ONCE_INIT;
+static int (*saved_out_vprintf) (const char *, va_list);
+static int (*saved_err_vprintf) (const char *, va_list);
+
+
+static int
+pool_threads (urj_chain_t *chain)
+{
+    long n = chain->bsdl.jobs;
+
+#ifdef _SC_NPROCESSORS_ONLN
+    if (n <= 0)
+        n = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+
+    return n > 0 ? n : 1;
+}
+
+
+static void
+job_key_create (void)
+{
+    pthread_key_create (&job_key, NULL);
+}
+
+
+static int
+pool_out_vprintf (const char *fmt, va_list ap)
+{
+    urj_bsdl_job_t *job = pthread_getspecific (job_key);
+
+    if (job == NULL)
+        return saved_out_vprintf (fmt, ap);
+
+    return job_log (job, 0, fmt, ap);
+}
+
+
+static int
+pool_err_vprintf (const char *fmt, va_list ap)
+{
+    urj_bsdl_job_t *job = pthread_getspecific (job_key);
+
+    if (job == NULL)
+        return saved_err_vprintf (fmt, ap);
+
+    return job_log (job, 1, fmt, ap);
+}
+
+
+static void *
+pool_worker (void *arg)
+{
+    pool_t *pool = arg;
+
+    for (;;)
+    {
+        urj_bsdl_job_t *job;
+        int i;
+
+        pthread_mutex_lock (&pool->lock);
+        i = pool->next++;
+        pthread_mutex_unlock (&pool->lock);
+        if (i >= pool->n)
+            break;
+
+        job = &pool->jobs[i];
+        pthread_setspecific (job_key, job);
+        urj_bsdl_read_job (pool->chain, job, pool->proc_mode);
+        pthread_setspecific (job_key, NULL);
+    }
+
+    return NULL;
+}
+
+
+static int
+pool_run (urj_chain_t *chain, urj_bsdl_job_t *jobs, int n, int proc_mode,
+          int threads)
+{
+    pool_t pool;
+    pthread_t *thread;
+    int i, started;
+
+    thread = malloc (threads * sizeof *thread);
+    if (thread == NULL)
+        return URJ_STATUS_FAIL;
+
+    pool.chain = chain;
+    pool.jobs = jobs;
+    pool.n = n;
+    pool.proc_mode = proc_mode;
+    pool.next = 0;
+    pthread_mutex_init (&pool.lock, NULL);
+    pthread_once (&job_key_once, job_key_create);
+
+    saved_out_vprintf = urj_log_state.out_vprintf;
+    saved_err_vprintf = urj_log_state.err_vprintf;
+    urj_log_state.out_vprintf = pool_out_vprintf;
+    urj_log_state.err_vprintf = pool_err_vprintf;
+
+    for (started = 0; started < threads; started++)
+        if (pthread_create (&thread[started], NULL, pool_worker, &pool) != 0)
+            break;
+    for (i = 0; i < started; i++)
+        pthread_join (thread[i], NULL);
+
+    urj_log_state.out_vprintf = saved_out_vprintf;
+    urj_log_state.err_vprintf = saved_err_vprintf;
+    pthread_mutex_destroy (&pool.lock);
+    free (thread);
+
+    /* without any thread the jobs are read by the caller */
+    return started ? URJ_STATUS_OK : URJ_STATUS_FAIL;
+}
+
+#endif /* HAVE_PTHREAD */
+
+
+void
+urj_bsdl_pool_run (urj_chain_t *chain, urj_bsdl_job_t *jobs, int n,
+                   int proc_mode)
+{
+#ifdef HAVE_PTHREAD
+    int threads = pool_threads (chain);
+#endif
+    int i;
+
+    for (i = 0; i < n; i++)
+        job_reset (&jobs[i]);
+
+#ifdef HAVE_PTHREAD
+    if (threads > n)
+        threads = n;
+    if (threads > 1
+        && pool_run (chain, jobs, n, proc_mode, threads) == URJ_STATUS_OK)
+        return;
+#endif
+
+    for (i = 0; i < n; i++)
+        urj_bsdl_read_job (chain, &jobs[i], proc_mode);
+}
@@ -0,0 +1,54 @@
+/*
+ * $Id$
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_BSDL_POOL_H
+#define URJ_BSDL_POOL_H
+
+#include <stddef.h>
+
+#include <urjtag/types.h>
+
+typedef struct
+{
+    const char *name;           /* file to read */
+    int result;                 /* as returned by urj_bsdl_read_file() */
+    char *idcode;               /* IDCODE of the file, NULL on errors */
+    char *log;                  /* messages, kept until the job is flushed */
+    size_t log_len;
+    size_t log_size;
+    int log_err;                /* last message went to the error stream */
+}
+urj_bsdl_job_t;
+
+/*
+ * Read the files of n jobs in proc_mode, which must not include
+ * URJ_BSDL_MODE_INSTR_EXEC.  The files are spread over the worker threads
+ * set with 'bsdl jobs'; their messages are held back per job, so the
+ * caller can print them in the order of the jobs.
+ */
+void urj_bsdl_pool_run (urj_chain_t *, urj_bsdl_job_t *, int n, int proc_mode);
+
+/* print the messages of a job and release them; the idcode stays */
+void urj_bsdl_job_flush (urj_bsdl_job_t *);
+
+/* read the file of a job in the calling thread, defined in bsdl.c */
+void urj_bsdl_read_job (urj_chain_t *, urj_bsdl_job_t *, int proc_mode);
+
+#endif /* URJ_BSDL_POOL_H */
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <urjtag/cmd.h>
 #include <urjtag/part.h>
@@ -76,7 +77,7 @@ urj_bsdl_set_instruction_length (urj_bsdl_jtag_ctrl_t *jc)
 /*****************************************************************************
  * int urj_bsdl_emit_ports( urj_bsdl_jtag_ctrl_t *jc )
  *
- * Adds the specified port name as a signal via shell command
+ * Adds the specified port name as a signal, or prints the shell command
  *   signal <pin>
  * The port name is taken from the port_desc structure that was filled in
  * previously by rule Scalar_or_Vector. This way, the function can build
@@ -285,11 +286,61 @@ bsbit_safe_char (int safe)
     }
 }
 
+/* signal of a port named by the cells of the BSR */
+struct cell_port
+{
+    const char *name;
+    urj_part_signal_t *signal;
+};
+
+
+/*****************************************************************************
+ * urj_part_signal_t *cell_port_signal( urj_part_t *part,
+ *                                      struct cell_port *ports, size_t mask,
+ *                                      const char *name )
+ *
+ * Looks up the signal of a port only for the first cell that names it.
+ *
+ * Parameters
+ *   part  : part of the signals
+ *   ports : open addressing table of mask + 1 entries, NULL to look up
+ *           the signal each time
+ *   mask  : size of the table minus one
+ *   name  : port name of the cell
+ *
+ * Returns
+ *   signal of the port, NULL if there is none
+ ****************************************************************************/
+static urj_part_signal_t *
+cell_port_signal (urj_part_t *part, struct cell_port *ports, size_t mask,
+                  const char *name)
+{
+    const unsigned char *c;
+    size_t i = 0;
+
+    if (ports == NULL)
+        return urj_part_find_signal (part, name);
+
+    for (c = (const unsigned char *) name; *c; c++)
+        i = i * 31 + tolower (*c);
+
+    for (i &= mask; ports[i].name; i = (i + 1) & mask)
+        if (strcasecmp (ports[i].name, name) == 0)
+            return ports[i].signal;
+
+    ports[i].name = name;
+    ports[i].signal = urj_part_find_signal (part, name);
+
+    return ports[i].signal;
+}
+
+
 /*****************************************************************************
  * int urj_bsdl_process_cell_info( urj_bsdl_jtag_ctrl_t *jc )
  * Cell Info management function
  *
- * Creates a BSR cell from the temporary storage variables via shell command
+ * Creates a BSR cell from the temporary storage variables, or prints the
+ * shell command
  *   bit <bit_num> <type> <default> <signal> [<cbit> <cval> Z]
  *
  * Parameters
@@ -302,9 +353,34 @@ static int
 urj_bsdl_process_cell_info (urj_bsdl_jtag_ctrl_t *jc)
 {
     urj_bsdl_cell_info_t *ci = jc->cell_info_first;
+    urj_data_register_t *bsr = NULL;
+    struct cell_port *ports = NULL;
+    size_t mask = 0;
     int type;
     int safe;
 
+    if (ci && (jc->proc_mode & URJ_BSDL_MODE_INSTR_EXEC))
+    {
+        bsr = urj_part_find_bsr (jc->part);
+        if (bsr == NULL)
+        {
+            urj_error_set (URJ_ERROR_NOTFOUND,
+                           _("missing Boundary Scan Register (BSR)"));
+            return URJ_STATUS_FAIL;
+        }
+
+        /* ports often have several cells, so resolve each port name
+           once; the table is at most half full, without it every cell
+           looks up its signal */
+        for (; ci; ci = ci->next)
+            mask++;
+        for (mask *= 2; mask & (mask - 1); mask &= mask - 1)
+            ;
+        ports = calloc (2 * mask, sizeof *ports);
+        mask = 2 * mask - 1;
+        ci = jc->cell_info_first;
+    }
+
     while (ci)
     {
         /* convert cell function from BSDL token to jtag syntax */
@@ -341,16 +417,35 @@ urj_bsdl_process_cell_info (urj_bsdl_jtag_ctrl_t *jc)
         safe = strcasecmp (ci->basic_safe_value, "x") == 0 ? URJ_BSBIT_DONTCARE
                    : (ci->basic_safe_value[0] - '0');
 
-        if (ci->ctrl_bit_num >= 0)
+        if (bsr)
         {
-            if (jc->proc_mode & URJ_BSDL_MODE_INSTR_EXEC)
-                if (urj_part_bsbit_alloc_control (jc->part, ci->bit_num,
-                                                  ci->port_name, type, safe,
-                                                  ci->ctrl_bit_num,
-                                                  ci->disable_safe_value,
-                                                  URJ_BSBIT_STATE_Z) !=
-                    URJ_STATUS_OK)
+            urj_part_signal_t *signal;
+
+            signal = cell_port_signal (jc->part, ports, mask, ci->port_name);
+
+            if (ci->ctrl_bit_num >= 0)
+            {
+                if (urj_part_bsbit_define (jc->part, bsr, signal, ci->bit_num,
+                                           ci->port_name, type, safe,
+                                           ci->ctrl_bit_num,
+                                           ci->disable_safe_value,
+                                           URJ_BSBIT_STATE_Z) != URJ_STATUS_OK)
+                {
+                    free (ports);
                     return URJ_STATUS_FAIL;
+                }
+            }
+            else if (urj_part_bsbit_define (jc->part, bsr, signal, ci->bit_num,
+                                            ci->port_name, type, safe,
+                                            -1, -1, -1) != URJ_STATUS_OK)
+            {
+                free (ports);
+                return URJ_STATUS_FAIL;
+            }
+        }
+
+        if (ci->ctrl_bit_num >= 0)
+        {
             if (jc->proc_mode & URJ_BSDL_MODE_INSTR_PRINT)
                 urj_log (URJ_LOG_LEVEL_NORMAL,
                          "bit %d %c %c %s %d %d %c\n", ci->bit_num,
@@ -360,11 +455,6 @@ urj_bsdl_process_cell_info (urj_bsdl_jtag_ctrl_t *jc)
         }
         else
         {
-            if (jc->proc_mode & URJ_BSDL_MODE_INSTR_EXEC)
-                if (urj_part_bsbit_alloc (jc->part, ci->bit_num,
-                                          ci->port_name, type, safe) !=
-                    URJ_STATUS_OK)
-                    return URJ_STATUS_FAIL;
             if (jc->proc_mode & URJ_BSDL_MODE_INSTR_PRINT)
                 urj_log (URJ_LOG_LEVEL_NORMAL,
                          "bit %d %c %c %s\n", ci->bit_num,
@@ -374,6 +464,8 @@ urj_bsdl_process_cell_info (urj_bsdl_jtag_ctrl_t *jc)
         ci = ci->next;
     }
 
+    free (ports);
+
     return URJ_STATUS_OK;
 }
 
@@ -716,7 +808,11 @@ urj_bsdl_process_elements (urj_bsdl_jtag_ctrl_t *jc, const char *idcode)
     }
 
     if (jc->idcode)
+    {
         urj_bsdl_msg (jc->proc_mode, _("Got IDCODE: %s\n"), jc->idcode);
+        if (jc->idcode_ret)
+            *jc->idcode_ret = strdup (jc->idcode);
+    }
 
     if (jc->proc_mode & URJ_BSDL_MODE_IDCODE_CHECK)
         result |= compare_idcode (jc, idcode);
@@ -144,6 +144,7 @@ struct jtag_ctrl
     urj_vhdl_elem_t *vhdl_elem_last;
     /* collected by BSDL parser */
     char *idcode;               /* IDCODE string */
+    char **idcode_ret;          /* receives a copy of idcode if not NULL */
     char *usercode;             /* USERCODE string */
     int instr_len;
     int bsr_len;
@@ -134,13 +134,13 @@ static inline void
 register_set_bit (urj_tap_register_t *tr, unsigned int bitno,
                   unsigned int val)
 {
-    tr->data[bitno] = (val) ? 1 : 0;
+    urj_tap_register_set_bit (tr, bitno, (val) ? 1 : 0);
 }
 
 static inline int
 register_get_bit (urj_tap_register_t *tr, unsigned int bitno)
 {
-    return (tr->data[bitno] & 1) ? 1 : 0;
+    return urj_tap_register_get_bit (tr, bitno);
 }
 
 static inline void
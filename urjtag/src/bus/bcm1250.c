@@ -331,7 +331,8 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
     while (j > 0)
     {
         j--;
-        p->active_instruction->data_register->in->data[j] = ctrl[k++] & 1;
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  j, ctrl[k++] & 1);
     }
     urj_tap_chain_shift_data_registers (chain, 1);
 
@@ -356,7 +357,8 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
     while (j > 0)
     {
         j--;
-        p->active_instruction->data_register->in->data[j] = addrr[k++] & 1;
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  j, addrr[k++] & 1);
     }
     urj_tap_chain_shift_data_registers (chain, 0);
 
@@ -365,19 +367,24 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
         urj_part_set_instruction (p, "DATA");
         urj_tap_chain_shift_instructions (chain);
         for (j = 0; j < 277; j++)
-            p->active_instruction->data_register->in->data[j] = j & 1;
-        p->active_instruction->data_register->in->data[259] = 1;
-        p->active_instruction->data_register->in->data[258] = 0;
-        p->active_instruction->data_register->in->data[257] = 0;
-        p->active_instruction->data_register->in->data[256] = 1;
+            urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                      j, j & 1);
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  259, 1);
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  258, 0);
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  257, 0);
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  256, 1);
         j = 0;
         if (type < 5)
         {
             k = 256 - (n + (1 << type)) * 8;
             while (j < (8 << type))
             {
-                p->active_instruction->data_register->in->data[k + j] =
-                    da & 1;
+                urj_tap_register_set_bit (p->active_instruction->
+                                          data_register->in, k + j, da & 1);
                 da >>= 1;
                 j++;
             }
@@ -391,9 +398,9 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
                 t = buf[r];
                 for (s = 0; s < 8; s++)
                 {
-                    p->active_instruction->data_register->in->data[248 -
-                                                                   r * 8 +
-                                                                   s] = t & 1;
+                    urj_tap_register_set_bit (p->active_instruction->
+                                              data_register->in,
+                                              248 - r * 8 + s, t & 1);
                     t >>= 1;
                 }
             }
@@ -412,7 +419,8 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
     while (j > 0)
     {
         j--;
-        p->active_instruction->data_register->in->data[j] = ctrl[k++] & 1;
+        urj_tap_register_set_bit (p->active_instruction->data_register->in,
+                                  j, ctrl[k++] & 1);
     }
     urj_tap_chain_shift_data_registers (chain, 1);
     if (urj_log_state.level <= URJ_LOG_LEVEL_DETAIL || read)
@@ -429,7 +437,7 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
         urj_tap_chain_shift_instructions (chain);
         urj_tap_chain_shift_data_registers (chain, 1);
 
-        while ((out->data[276 - 17] == 0) && to--)
+        while ((urj_tap_register_get_bit (out, 276 - 17) == 0) && to--)
         {
             urj_tap_chain_shift_data_registers (chain, 1);
         }
@@ -439,7 +447,7 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
             for (m = 0; m < 8; m++)
             {
                 buf[j] <<= 1;
-                buf[j] += out->data[255 - (j * 8) - m] & 1;
+                buf[j] += urj_tap_register_get_bit (out, 255 - (j * 8) - m);
             }
             urj_log (URJ_LOG_LEVEL_DETAIL, "%02x ", buf[j]);
         }
@@ -450,7 +458,8 @@ bcm1250_ejtag_do (urj_bus_t *bus, uint64_t ad, uint64_t da, int read,
             urj_log (URJ_LOG_LEVEL_DETAIL, " status:\n");
             for (j = 0; j < 21; j++)
             {
-                urj_log (URJ_LOG_LEVEL_DETAIL, "%c", '0' + out->data[276 - j]);
+                urj_log (URJ_LOG_LEVEL_DETAIL, "%c",
+                         '0' + urj_tap_register_get_bit (out, 276 - j));
                 if ((j == 5) || (j == 11) || (j == 12) || (j == 16)
                     || (j == 17))
                     urj_log (URJ_LOG_LEVEL_DETAIL, " ");
@@ -35,6 +35,7 @@
 #include <urjtag/cmd.h>
 
 #include "buses.h"
+#include "generic_bus.h"
 
 const urj_bus_driver_t * const urj_bus_drivers[] = {
 #define _URJ_BUS(bus) &urj_bus_##bus##_bus,
@@ -219,6 +220,26 @@ urj_bus_init_bus (urj_chain_t *chain, const urj_bus_driver_t *bus_driver,
     return abus;
 }
 
+int
+urj_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                    uint32_t len)
+{
+    if (bus->driver->read_block)
+        return bus->driver->read_block (bus, adr, buf, len);
+
+    return urj_bus_generic_read_block (bus, adr, buf, len);
+}
+
+int
+urj_bus_write_block (urj_bus_t *bus, uint32_t adr, const uint32_t *buf,
+                     uint32_t len)
+{
+    if (bus->driver->write_block)
+        return bus->driver->write_block (bus, adr, buf, len);
+
+    return urj_bus_generic_write_block (bus, adr, buf, len);
+}
+
 static const urj_param_descr_t bus_param[] =
 {
     { URJ_BUS_PARAM_KEY_MUX,        URJ_PARAM_TYPE_BOOL,    "MUX", },
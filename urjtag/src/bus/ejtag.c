@@ -146,7 +146,7 @@ reg_value (urj_tap_register_t *reg)
 
     for (i = 0; i < reg->len; i++)
     {
-        if (reg->data[i])
+        if (urj_tap_register_get_bit (reg, i))
             retval |= (1 << i);
     }
     return retval;
@@ -177,21 +177,21 @@ ejtag_run_pracc (urj_bus_t *bus, const uint32_t *code, unsigned int len)
 
     for (;;)
     {
-        ejctrl->in->data[PrAcc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
         urj_tap_chain_shift_data_registers (bus->chain, 0);
         urj_tap_chain_shift_data_registers (bus->chain, 1);
 
         urj_log (URJ_LOG_LEVEL_ALL,  "ctrl=%s\n",
                  urj_tap_register_get_string (ejctrl->out));
 
-        if (ejctrl->out->data[Rocc])
+        if (urj_tap_register_get_bit (ejctrl->out, Rocc))
         {
             urj_error_set (URJ_ERROR_BUS, _("Reset occurred, ctrl=%s"),
                            urj_tap_register_get_string (ejctrl->out));
             bus->initialized = 0;
             break;
         }
-        if (!ejctrl->out->data[PrAcc])
+        if (!urj_tap_register_get_bit (ejctrl->out, PrAcc))
         {
             urj_error_set (URJ_ERROR_BUS, _("No processor access, ctrl=%s"),
                            urj_tap_register_get_string (ejctrl->out));
@@ -217,7 +217,7 @@ ejtag_run_pracc (urj_bus_t *bus, const uint32_t *code, unsigned int len)
 
         urj_tap_register_fill (ejdata->in, 0);
 
-        if (ejctrl->out->data[PRnW])
+        if (urj_tap_register_get_bit (ejctrl->out, PRnW))
         {
             urj_tap_chain_shift_data_registers (bus->chain, 1);
             data = reg_value (ejdata->out);
@@ -248,7 +248,7 @@ ejtag_run_pracc (urj_bus_t *bus, const uint32_t *code, unsigned int len)
                 data = code[(addr - 0xff200200) >> 2];
 
                 for (i = 0; i < 32; i++)
-                    ejdata->in->data[i] = (data >> i) & 1;
+                    urj_tap_register_set_bit (ejdata->in, i, (data >> i) & 1);
             }
             urj_log (URJ_LOG_LEVEL_ALL,
                      "%s(%d) PrAcc read: addr=0x%08lx data=0x%08lx\n",
@@ -260,7 +260,7 @@ ejtag_run_pracc (urj_bus_t *bus, const uint32_t *code, unsigned int len)
         urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
         urj_tap_chain_shift_instructions (bus->chain);
 
-        ejctrl->in->data[PrAcc] = 0;
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 0);
         urj_tap_chain_shift_data_registers (bus->chain, 0);
     }
     return retval;
@@ -343,11 +343,11 @@ ejtag_bus_init (urj_bus_t *bus)
     urj_tap_chain_shift_instructions (bus->chain);
     //Reset
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrRst] = 1;
-    ejctrl->in->data[PerRst] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrRst, 1);
+    urj_tap_register_set_bit (ejctrl->in, PerRst, 1);
     urj_tap_chain_shift_data_registers (bus->chain, 0); //Write
-    ejctrl->in->data[PrRst] = 0;
-    ejctrl->in->data[PerRst] = 0;
+    urj_tap_register_set_bit (ejctrl->in, PrRst, 0);
+    urj_tap_register_set_bit (ejctrl->in, PerRst, 0);
     urj_tap_chain_shift_data_registers (bus->chain, 0); //Write
 //
     if (EJTAG_VER == EJTAG_20)
@@ -377,12 +377,12 @@ ejtag_bus_init (urj_bus_t *bus)
         urj_tap_chain_shift_instructions (bus->chain);
         //Set some bits in CONTROL Register 0x00068B00
         urj_tap_register_fill (ejctrl->in, 0);  // Clear Register
-        ejctrl->in->data[PrAcc] = 1;    // 18----|||
-        ejctrl->in->data[DmaAcc] = 1;   // 17----|||
-        ejctrl->in->data[ProbEn] = 1;   // 15-----||
-        ejctrl->in->data[DStrt] = 1;    // 11------|
-        ejctrl->in->data[DrWn] = 1;     // 9-------|
-        ejctrl->in->data[Dsz1] = 1;     // 8-------| DMA_WORD = 0x00000100 = Bit8
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);    // 18----|||
+        urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);   // 17----|||
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);   // 15-----||
+        urj_tap_register_set_bit (ejctrl->in, DStrt, 1);    // 11------|
+        urj_tap_register_set_bit (ejctrl->in, DrWn, 1);     // 9-------|
+        urj_tap_register_set_bit (ejctrl->in, Dsz1, 1);     // 8-------| DMA_WORD = 0x00000100 = Bit8
         urj_tap_chain_shift_data_registers (bus->chain, 1);     //WriteRead
         urj_log (URJ_LOG_LEVEL_ALL, "Write To ejctrl->in     =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->in),
@@ -397,9 +397,9 @@ ejtag_bus_init (urj_bus_t *bus)
             urj_tap_chain_shift_instructions (bus->chain);
             urj_tap_register_fill (ejctrl->in, 0);
             //Set some bits in CONTROL Register 0x00068000
-            ejctrl->in->data[PrAcc] = 1;        // 18----||
-            ejctrl->in->data[DmaAcc] = 1;       // 17----||
-            ejctrl->in->data[ProbEn] = 1;       // 15-----|
+            urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);        // 18----||
+            urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);       // 17----||
+            urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);       // 15-----|
             urj_tap_chain_shift_data_registers (bus->chain, 1); //WriteRead
             urj_log (URJ_LOG_LEVEL_ALL, "Write To ejctrl->in     =%s %08lX\n",
                      urj_tap_register_get_string (ejctrl->in),
@@ -408,7 +408,7 @@ ejtag_bus_init (urj_bus_t *bus)
                      urj_tap_register_get_string( ejctrl->out),
                      (unsigned long) reg_value (ejctrl->out));
         }
-        while (ejctrl->out->data[DStrt] == 1);
+        while (urj_tap_register_get_bit (ejctrl->out, DStrt) == 1);
         urj_log (URJ_LOG_LEVEL_ALL, "Select EJTAG DATA Register\n");
         urj_part_set_instruction (bus->part, "EJTAG_DATA");
         urj_tap_chain_shift_instructions (bus->chain);
@@ -425,8 +425,8 @@ ejtag_bus_init (urj_bus_t *bus)
         urj_tap_chain_shift_instructions (bus->chain);
         urj_tap_register_fill (ejctrl->in, 0);
         //Set some bits in CONTROL Register 0x00048000
-        ejctrl->in->data[PrAcc] = 1;    // 18----||
-        ejctrl->in->data[ProbEn] = 1;   // 15-----|
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);    // 18----||
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);   // 15-----|
         urj_tap_chain_shift_data_registers (bus->chain, 1);     //WriteRead
         urj_log (URJ_LOG_LEVEL_ALL, "Write To ejctrl->in     =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->in),
@@ -434,14 +434,14 @@ ejtag_bus_init (urj_bus_t *bus)
         urj_log (URJ_LOG_LEVEL_ALL, "Read From ejctrl->out   =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->out),
                  (unsigned long) reg_value (ejctrl->out));
-        if (ejctrl->out->data[DeRR] == 1)
+        if (urj_tap_register_get_bit (ejctrl->out, DeRR) == 1)
         {
             urj_error_set (URJ_ERROR_BUS_DMA, "DMA READ ERROR");
         }
         //Now have data from DCR, need to reset the MP Bit (2) and write it back out
         urj_tap_register_init (ejdata->in,
                                urj_tap_register_get_string (ejdata->out));
-        ejdata->in->data[MemProt] = 0;
+        urj_tap_register_set_bit (ejdata->in, MemProt, 0);
         urj_log (URJ_LOG_LEVEL_ALL, "Need to Write ejdata-> =%s %08lX\n",
                  urj_tap_register_get_string (ejdata->in),
                  (unsigned long) reg_value (ejdata->in));
@@ -472,11 +472,11 @@ ejtag_bus_init (urj_bus_t *bus)
 
         //Set some bits in CONTROL Register
         urj_tap_register_fill (ejctrl->in, 0);  // Clear Register
-        ejctrl->in->data[DmaAcc] = 1;   // 17
-        ejctrl->in->data[Dsz1] = 1;     // DMA_WORD = 0x00000100 = Bit8
-        ejctrl->in->data[DStrt] = 1;    // 11
-        ejctrl->in->data[ProbEn] = 1;   // 15
-        ejctrl->in->data[PrAcc] = 1;    // 18
+        urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);   // 17
+        urj_tap_register_set_bit (ejctrl->in, Dsz1, 1);     // DMA_WORD = 0x00000100 = Bit8
+        urj_tap_register_set_bit (ejctrl->in, DStrt, 1);    // 11
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);   // 15
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);    // 18
         urj_tap_chain_shift_data_registers (bus->chain, 1);     //Write/Read
         urj_log (URJ_LOG_LEVEL_ALL, "Write to ejctrl->in     =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->in),
@@ -490,9 +490,9 @@ ejtag_bus_init (urj_bus_t *bus)
             //Might not need these 2 lines
             urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
             urj_tap_chain_shift_instructions (bus->chain);
-            ejctrl->in->data[DmaAcc] = 1;       // 17
-            ejctrl->in->data[ProbEn] = 1;       // 15
-            ejctrl->in->data[PrAcc] = 1;        // 18
+            urj_tap_register_set_bit (ejctrl->in, DmaAcc, 1);       // 17
+            urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);       // 15
+            urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);        // 18
             urj_tap_chain_shift_data_registers (bus->chain, 1); //Write/Read
             urj_log (URJ_LOG_LEVEL_ALL, "Write to ejctrl->in     =%s %08lX\n",
                      urj_tap_register_get_string (ejctrl->in),
@@ -501,14 +501,14 @@ ejtag_bus_init (urj_bus_t *bus)
                      urj_tap_register_get_string (ejctrl->out),
                      (unsigned long) reg_value (ejctrl->out));
         }
-        while (ejctrl->out->data[DStrt] == 1);
+        while (urj_tap_register_get_bit (ejctrl->out, DStrt) == 1);
         urj_log (URJ_LOG_LEVEL_ALL, "Select EJTAG CONTROL Register\n");
         urj_part_set_instruction (bus->part, "EJTAG_CONTROL");
         urj_tap_chain_shift_instructions (bus->chain);
         urj_tap_register_fill (ejctrl->in, 0);
         //Set some bits in CONTROL Register 0x00048000
-        ejctrl->in->data[PrAcc] = 1;    // 18----||
-        ejctrl->in->data[ProbEn] = 1;   // 15-----|
+        urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);    // 18----||
+        urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);   // 15-----|
         urj_tap_chain_shift_data_registers (bus->chain, 1);     //Write/Read
         urj_log (URJ_LOG_LEVEL_ALL, "Write To ejctrl->in     =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->in),
@@ -516,7 +516,7 @@ ejtag_bus_init (urj_bus_t *bus)
         urj_log (URJ_LOG_LEVEL_ALL, "Read From ejctrl->out   =%s %08lX\n",
                  urj_tap_register_get_string (ejctrl->out),
                  (unsigned long) reg_value (ejctrl->out));
-        if (ejctrl->out->data[DeRR] == 1)
+        if (urj_tap_register_get_bit (ejctrl->out, DeRR) == 1)
         {
             urj_error_set (URJ_ERROR_BUS_DMA, "DMA WRITE ERROR");
         }
@@ -526,26 +526,26 @@ ejtag_bus_init (urj_bus_t *bus)
     urj_tap_chain_shift_instructions (bus->chain);
 
     urj_tap_register_fill (ejctrl->in, 0);
-    ejctrl->in->data[PrAcc] = 1;
-    ejctrl->in->data[ProbEn] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
     if (EJTAG_VER >= EJTAG_25)
     {
-        ejctrl->in->data[ProbTrap] = 1;
-        ejctrl->in->data[Rocc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, ProbTrap, 1);
+        urj_tap_register_set_bit (ejctrl->in, Rocc, 1);
     }
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 
-    ejctrl->in->data[PrAcc] = 1;
-    ejctrl->in->data[ProbEn] = 1;
-    ejctrl->in->data[ProbTrap] = 1;
-    ejctrl->in->data[JtagBrk] = 1;
+    urj_tap_register_set_bit (ejctrl->in, PrAcc, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbEn, 1);
+    urj_tap_register_set_bit (ejctrl->in, ProbTrap, 1);
+    urj_tap_register_set_bit (ejctrl->in, JtagBrk, 1);
 
     urj_tap_chain_shift_data_registers (bus->chain, 0);
 
-    ejctrl->in->data[JtagBrk] = 0;
+    urj_tap_register_set_bit (ejctrl->in, JtagBrk, 0);
     urj_tap_chain_shift_data_registers (bus->chain, 1);
 
-    if (!ejctrl->out->data[BrkSt])
+    if (!urj_tap_register_get_bit (ejctrl->out, BrkSt))
     {
         urj_error_set (URJ_ERROR_ILLEGAL_STATE,
                        _("Failed to enter debug mode, ctrl=%s"),
@@ -556,11 +556,11 @@ ejtag_bus_init (urj_bus_t *bus)
     {
         urj_log (URJ_LOG_LEVEL_NORMAL, "Processor entered Debug Mode.\n");
     }
-    if (ejctrl->out->data[Rocc])
+    if (urj_tap_register_get_bit (ejctrl->out, Rocc))
     {
-        ejctrl->in->data[Rocc] = 0;
+        urj_tap_register_set_bit (ejctrl->in, Rocc, 0);
         urj_tap_chain_shift_data_registers (bus->chain, 0);
-        ejctrl->in->data[Rocc] = 1;
+        urj_tap_register_set_bit (ejctrl->in, Rocc, 1);
         urj_tap_chain_shift_data_registers (bus->chain, 1);
     }
 
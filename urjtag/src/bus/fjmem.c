@@ -90,7 +90,6 @@ fjmem_detect_reg_len (urj_chain_t *chain, urj_part_t *part, const char *opcode,
     urj_data_register_t *dr;
     urj_part_instruction_t *i;
     int l, fjmem_reg_len;
-    char *tdo_bit;
 
     /* build register FJMEM_REG with length of 1 bit */
     dr = urj_part_data_register_alloc (FJMEM_REG_NAME, 1);
@@ -148,18 +147,17 @@ fjmem_detect_reg_len (urj_chain_t *chain, urj_part_t *part, const char *opcode,
     fjmem_reg_len = 0;
     urj_tap_register_fill (dr->in, 1);
     urj_tap_register_fill (dr->out, 0);
-    tdo_bit = dr->out->data;
 
     urj_tap_capture_dr (chain);
     /* read current TDO and then shift once */
     urj_tap_shift_register (chain, dr->in, dr->out, URJ_CHAIN_EXITMODE_SHIFT);
     urj_tap_register_get_string (dr->out);
-    while ((tdo_bit[0] == 0) && (fjmem_reg_len < FJMEM_MAX_REG_LEN))
+    while ((urj_tap_register_get_bit (dr->out, 0) == 0)
+           && (fjmem_reg_len < FJMEM_MAX_REG_LEN))
     {
         /* read current TDO and then shift once */
         urj_tap_shift_register (chain, dr->in, dr->out,
                                 URJ_CHAIN_EXITMODE_SHIFT);
-        tdo_bit = dr->out->data;
         fjmem_reg_len++;
     }
     /* consider BYPASS register of other parts in the chain */
@@ -206,8 +204,8 @@ fjmem_detect_fields (urj_chain_t *chain, urj_part_t *part, urj_bus_t *bus)
        Shift in the query for block 0, will be used lateron. */
     urj_tap_register_fill (dr->in, 0);
     /* enter query instruction: 110 */
-    dr->in->data[bd->instr_pos + 1] = 1;
-    dr->in->data[bd->instr_pos + 2] = 1;
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 1, 1);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 2, 1);
 
     /* shift register */
     urj_tap_chain_shift_data_registers (chain, 1);
@@ -217,17 +215,18 @@ fjmem_detect_fields (urj_chain_t *chain, urj_part_t *part, urj_bus_t *bus)
              urj_tap_register_get_string (dr->out));
     /* scan block field */
     idx = bd->block_pos;
-    while (dr->out->data[idx] && (idx < dr->out->len))
+    while ((idx < dr->out->len) && urj_tap_register_get_bit (dr->out, idx))
         idx++;
     bd->block_len = idx - bd->block_pos;
     /* scan address field */
     bd->addr_pos = idx;
-    while ((dr->out->data[idx] == 0) && (idx < dr->out->len))
+    while ((idx < dr->out->len)
+           && (urj_tap_register_get_bit (dr->out, idx) == 0))
         idx++;
     bd->addr_len = idx - bd->addr_pos;
     /* scan data field */
     bd->data_pos = idx;
-    while (dr->out->data[idx] && (idx < dr->out->len))
+    while ((idx < dr->out->len) && urj_tap_register_get_bit (dr->out, idx))
         idx++;
     bd->data_len = idx - bd->data_pos;
 
@@ -264,7 +263,8 @@ fjmem_query_blocks (urj_chain_t *chain, urj_part_t *part, urj_bus_t *bus)
         /* prepare the next query before shifting the data register */
         for (idx = 0; idx < bd->block_len; idx++)
         {
-            dr->in->data[bd->block_pos + idx] = next_block_num & 1;
+            urj_tap_register_set_bit (dr->in, bd->block_pos + idx,
+                                      next_block_num & 1);
             next_block_num >>= 1;
         }
         urj_tap_chain_shift_data_registers (chain, 1);
@@ -275,12 +275,12 @@ fjmem_query_blocks (urj_chain_t *chain, urj_part_t *part, urj_bus_t *bus)
 
         /* extract address field length */
         for (addr_len = 0; addr_len < bd->addr_len; addr_len++)
-            if (dr->out->data[bd->addr_pos + addr_len] == 0)
+            if (!urj_tap_register_get_bit (dr->out, bd->addr_pos + addr_len))
                 break;
 
         /* extract data field length */
         for (data_len = 0; data_len < bd->data_len; data_len++)
-            if (dr->out->data[bd->data_pos + data_len] == 0)
+            if (!urj_tap_register_get_bit (dr->out, bd->data_pos + data_len))
                 break;
 
         /* it's a valid block only if address field and data field are
@@ -564,14 +564,14 @@ setup_address (urj_bus_t *bus, uint32_t a, block_param_t *block)
     /* set block number */
     for (idx = 0; idx < bd->block_len; idx++)
     {
-        dr->in->data[bd->block_pos + idx] = num & 1;
+        urj_tap_register_set_bit (dr->in, bd->block_pos + idx, num & 1);
         num >>= 1;
     }
 
     /* set address */
     for (idx = 0; idx < block->addr_width; idx++)
     {
-        dr->in->data[bd->addr_pos + idx] = a & 1;
+        urj_tap_register_set_bit (dr->in, bd->addr_pos + idx, a & 1);
         a >>= 1;
     }
 }
@@ -586,7 +586,7 @@ setup_data (urj_bus_t *bus, uint32_t d, block_param_t *block)
     /* set data */
     for (idx = 0; idx < block->data_width; idx++)
     {
-        dr->in->data[bd->data_pos + idx] = d & 1;
+        urj_tap_register_set_bit (dr->in, bd->data_pos + idx, d & 1);
         d >>= 1;
     }
 }
@@ -615,9 +615,9 @@ fjmem_bus_read_start (urj_bus_t *bus, uint32_t adr)
     setup_address (bus, adr, block);
 
     /* select read instruction */
-    dr->in->data[bd->instr_pos + 0] = 1;
-    dr->in->data[bd->instr_pos + 1] = 0;
-    dr->in->data[bd->instr_pos + 2] = 0;
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 0, 1);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 1, 0);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 2, 0);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 
@@ -653,7 +653,7 @@ fjmem_bus_read_next (urj_bus_t *bus, uint32_t adr)
     /* extract data from TDO stream */
     d = 0;
     for (idx = 0; idx < block->data_width; idx++)
-        if (dr->out->data[bd->data_pos + idx])
+        if (urj_tap_register_get_bit (dr->out, bd->data_pos + idx))
             d |= 1 << idx;
 
     return d;
@@ -682,16 +682,16 @@ fjmem_bus_read_end (urj_bus_t *bus)
     }
 
     /* prepare idle instruction to disable any spurious unintentional reads */
-    dr->in->data[bd->instr_pos + 0] = 0;
-    dr->in->data[bd->instr_pos + 1] = 0;
-    dr->in->data[bd->instr_pos + 2] = 0;
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 0, 0);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 1, 0);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 2, 0);
 
     urj_tap_chain_shift_data_registers (chain, 1);
 
     /* extract data from TDO stream */
     d = 0;
     for (idx = 0; idx < block->data_width; idx++)
-        if (dr->out->data[bd->data_pos + idx])
+        if (urj_tap_register_get_bit (dr->out, bd->data_pos + idx))
             d |= 1 << idx;
 
     return d;
@@ -721,9 +721,9 @@ fjmem_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
     setup_data (bus, data, block);
 
     /* select write instruction */
-    dr->in->data[bd->instr_pos + 0] = 0;
-    dr->in->data[bd->instr_pos + 1] = 1;
-    dr->in->data[bd->instr_pos + 2] = 0;
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 0, 0);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 1, 1);
+    urj_tap_register_set_bit (dr->in, bd->instr_pos + 2, 0);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 }
@@ -159,3 +159,140 @@ urj_bus_generic_read (urj_bus_t *bus, uint32_t adr)
     URJ_BUS_READ_START (bus, adr);
     return URJ_BUS_READ_END (bus);
 }
+
+/* @return bytes per bus word at adr; 0 on error */
+static uint32_t
+generic_step (urj_bus_t *bus, uint32_t adr)
+{
+    urj_bus_area_t area;
+
+    if (URJ_BUS_AREA (bus, adr, &area) != URJ_STATUS_OK)
+        return 0;
+    if (area.width < 8)
+    {
+        urj_error_set (URJ_ERROR_INVALID, _("Unknown bus width"));
+        return 0;
+    }
+
+    return area.width / 8;
+}
+
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+int
+urj_bus_generic_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                            uint32_t len)
+{
+    uint32_t step, i;
+
+    if (len == 0)
+        return URJ_STATUS_OK;
+    if (len == 1)
+    {
+        buf[0] = URJ_BUS_READ (bus, adr);
+        return URJ_STATUS_OK;
+    }
+
+    step = generic_step (bus, adr);
+    if (step == 0)
+        return URJ_STATUS_FAIL;
+
+    /* read_next() returns the word of the address given before */
+    if (URJ_BUS_READ_START (bus, adr) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    for (i = 1; i < len; i++)
+        buf[i - 1] = URJ_BUS_READ_NEXT (bus, adr + i * step);
+    buf[len - 1] = URJ_BUS_READ_END (bus);
+
+    return URJ_STATUS_OK;
+}
+
+/**
+ * bus->driver->(*write_block)
+ *
+ */
+int
+urj_bus_generic_write_block (urj_bus_t *bus, uint32_t adr,
+                             const uint32_t *buf, uint32_t len)
+{
+    uint32_t step, i;
+
+    if (len == 0)
+        return URJ_STATUS_OK;
+
+    step = generic_step (bus, adr);
+    if (step == 0)
+        return URJ_STATUS_FAIL;
+
+    for (i = 0; i < len; i++)
+        URJ_BUS_WRITE (bus, adr + i * step, buf[i]);
+
+    return URJ_STATUS_OK;
+}
+
+/* most BSR scans queued by urj_bus_generic_read_pipelined at a time */
+#define PIPELINE_DEPTH  256
+
+int
+urj_bus_generic_read_pipelined (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                                uint32_t len,
+                                const urj_bus_generic_pipeline_t *ops)
+{
+    urj_chain_t *chain = bus->chain;
+    uint32_t step, i, k, n;
+    int failed = 0;
+
+    if (len == 0)
+        return URJ_STATUS_OK;
+
+    step = generic_step (bus, adr);
+    if (step == 0)
+        return URJ_STATUS_FAIL;
+
+    if (URJ_BUS_READ_START (bus, adr) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* the scan that drives address k + 1 captures the data of address k */
+    for (i = 0; i < len && !failed; i += n)
+    {
+        n = len - i;
+        if (n > PIPELINE_DEPTH)
+            n = PIPELINE_DEPTH;
+
+        for (k = 0; k < n; k++)
+        {
+            if (i + k + 1 < len)
+                ops->address (bus, adr + (i + k + 1) * step);
+            else
+                ops->end (bus);
+            if (urj_tap_chain_defer_data_registers (chain, 1,
+                                                    URJ_CHAIN_EXITMODE_IDLE)
+                != URJ_STATUS_OK)
+            {
+                failed = 1;
+                n = k;
+                break;
+            }
+        }
+
+        /* collect all that were queued, even after an error */
+        for (k = 0; k < n; k++)
+        {
+            if (urj_tap_chain_collect_data_registers (chain) != URJ_STATUS_OK)
+                failed = 1;
+            buf[i + k] = ops->data (bus, adr + (i + k) * step);
+        }
+    }
+
+    if (failed)
+    {
+        /* the scan that ends the read cycle may not have gone out */
+        ops->end (bus);
+        urj_tap_chain_shift_data_registers (chain, 0);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
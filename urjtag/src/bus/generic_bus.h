@@ -42,5 +42,35 @@ int urj_bus_generic_no_disable (urj_bus_t *bus);
 void urj_bus_generic_prepare_extest (urj_bus_t *bus);
 int urj_bus_generic_write_start(urj_bus_t *bus, uint32_t adr);
 uint32_t urj_bus_generic_read (urj_bus_t *bus, uint32_t adr);
+int urj_bus_generic_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                                uint32_t len);
+int urj_bus_generic_write_block (urj_bus_t *bus, uint32_t adr,
+                                 const uint32_t *buf, uint32_t len);
+
+/**
+ * Read cycle of an EXTEST bus driver, split for
+ * urj_bus_generic_read_pipelined: address() and end() set up the BSR for
+ * reading from an address or for ending the read, data() decodes the data
+ * word of an address from the captured BSR.
+ */
+typedef struct
+{
+    void (*address) (urj_bus_t *bus, uint32_t adr);
+    void (*end) (urj_bus_t *bus);
+    uint32_t (*data) (urj_bus_t *bus, uint32_t adr);
+}
+urj_bus_generic_pipeline_t;
+
+/**
+ * bus->driver->(*read_block) for EXTEST bus drivers: after the driver's
+ * read_start, the BSR scans for many addresses are queued on the cable and
+ * their data is decoded when the queue has been flushed, instead of waiting
+ * for the result of each scan.
+ *
+ * @return URJ_STATUS_OK on success; URJ_STATUS_FAIL on error
+ */
+int urj_bus_generic_read_pipelined (urj_bus_t *bus, uint32_t adr,
+                                    uint32_t *buf, uint32_t len,
+                                    const urj_bus_generic_pipeline_t *ops);
 
 #endif /* URJ_BUS_GENERIC_BUS_H */
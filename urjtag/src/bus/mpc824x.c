@@ -53,6 +53,8 @@ typedef struct
     urj_part_signal_t *d[32];
     int bus_width;
     char revbits, dbg_addr, dbg_data;
+    urj_part_signal_vector_t var;
+    urj_part_signal_vector_t vd;
 } bus_params_t;
 
 #define boot_nFOE       ((bus_params_t *) bus->params)->boot_nfoe
@@ -67,6 +69,8 @@ typedef struct
 #define REVBITS         ((bus_params_t *) bus->params)->revbits
 #define dbgAddr         ((bus_params_t *) bus->params)->dbg_addr
 #define dbgData         ((bus_params_t *) bus->params)->dbg_data
+#define VAR             (&((bus_params_t *) bus->params)->var)
+#define VD              (&((bus_params_t *) bus->params)->vd)
 
 /**
  * bus->driver->(*new_bus)
@@ -226,6 +230,11 @@ mpc824x_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         failed |= urj_bus_generic_attach_sig (part, &(D[i]), buff);
     }
 
+    if (!failed
+        && (urj_part_signal_vector_init (part, VAR, AR, 23) != URJ_STATUS_OK
+            || urj_part_signal_vector_init (part, VD, D, 32) != URJ_STATUS_OK))
+        failed = 1;
+
     if (failed)
     {
         urj_bus_generic_free (bus);
@@ -317,20 +326,16 @@ setup_address (urj_bus_t *bus, uint32_t a)
     switch (BUS_WIDTH)
     {
     case 8:                    /* 8-bit data bus */
-        for (i = 0; i < 23; i++)
-            urj_part_set_signal (p, AR[i], 1, (a >> i) & 1);
+        urj_part_set_vector_n (p, VAR, 23, a);
         break;
     case 16:                   /* 16-bit data bus */
-        for (i = 0; i < 22; i++)
-            urj_part_set_signal (p, AR[i], 1, (a >> (i + 1)) & 1);
+        urj_part_set_vector_n (p, VAR, 22, a >> 1);
         break;
     case 32:                   /* 32-bit data bus */
-        for (i = 0; i < 21; i++)
-            urj_part_set_signal (p, AR[i], 1, (a >> (i + 2)) & 1);
+        urj_part_set_vector_n (p, VAR, 21, a >> 2);
         break;
     case 64:
-        for (i = 0; i < 20; i++)
-            urj_part_set_signal (p, AR[i], 1, (a >> (i + 3)) & 1);
+        urj_part_set_vector_n (p, VAR, 20, a >> 3);
         break;
     default:
         urj_error_set (URJ_ERROR_UNSUPPORTED,
@@ -376,19 +381,30 @@ setup_address (urj_bus_t *bus, uint32_t a)
 
 }
 
+/* map data bit i to D[BUS_WIDTH - 1 - i] for "revbits" */
+static uint32_t
+reverse_data (urj_bus_t *bus, uint32_t d)
+{
+    uint32_t r = 0;
+    int i;
+
+    for (i = 0; i < BUS_WIDTH && i < 32; i++)
+        if (BUS_WIDTH - 1 - i < 32)
+            r |= ((d >> (BUS_WIDTH - 1 - i)) & 1) << i;
+
+    return r;
+}
+
 static void
 set_data_in (urj_bus_t *bus, uint32_t adr)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     mpc824x_bus_area (bus, adr, &area);
     if (area.width > 64)
         return;
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, D[i]);
+    urj_part_set_vector_input_n (bus->part, VD, area.width);
 }
 
 static void
@@ -402,10 +418,8 @@ setup_data (urj_bus_t *bus, uint32_t adr, uint32_t d)
     if (area.width > 64)
         return;
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, D[i], 1,
-                             (d >> ((REVBITS == 1) ? BUS_WIDTH - 1 - i : i)) &
-                             1);
+    urj_part_set_vector_n (p, VD, area.width,
+                           (REVBITS == 1) ? reverse_data (bus, d) : d);
 
     /* Just for debugging */
     if (dbgData)
@@ -451,9 +465,9 @@ get_data (urj_bus_t *bus, uint32_t adr)
     if (area.width > 64)
         return 0;
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, D[i]) <<
-                         ((REVBITS == 1) ? BUS_WIDTH - 1 - i : i));
+    d = urj_part_get_vector_n (p, VD, area.width);
+    if (REVBITS == 1)
+        d = reverse_data (bus, d);
 
     /* Just for debugging */
     if (dbgData)
@@ -487,6 +501,15 @@ get_data (urj_bus_t *bus, uint32_t adr)
     return d;
 }
 
+static void
+read_cycle_end (urj_bus_t *bus)
+{
+    urj_part_t *p = bus->part;
+
+    urj_part_set_signal_high (p, nRCS0);
+    urj_part_set_signal_high (p, nFOE);
+}
+
 /**
  * bus->driver->(*read_start)
  *
@@ -535,16 +558,31 @@ mpc824x_bus_read_next (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 mpc824x_bus_read_end (urj_bus_t *bus)
 {
-    urj_part_t *p = bus->part;
-
-    urj_part_set_signal_high (p, nRCS0);
-    urj_part_set_signal_high (p, nFOE);
+    read_cycle_end (bus);
 
     urj_tap_chain_shift_data_registers (bus->chain, 1);
 
     return get_data (bus, LAST_ADR);
 }
 
+static const urj_bus_generic_pipeline_t mpc824x_pipeline = {
+    setup_address,
+    read_cycle_end,
+    get_data,
+};
+
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+mpc824x_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                        uint32_t len)
+{
+    return urj_bus_generic_read_pipelined (bus, adr, buf, len,
+                                           &mpc824x_pipeline);
+}
+
 /**
  * bus->driver->(*write)
  *
@@ -596,4 +634,6 @@ const urj_bus_driver_t urj_bus_mpc824x_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    mpc824x_bus_read_block,
+    NULL,
 };
@@ -46,6 +46,16 @@ typedef struct
     urj_part_signal_t *oe;
     int alsbi, amsbi, ai, aw, dlsbi, dmsbi, di, dw, csa, wea, oea;
     int ashift;
+    /* the signals above resolved to their BSR bits, buses in bus order */
+    urj_part_signal_vector_t va;
+    urj_part_signal_vector_t vd;
+    /* the levels of CS, WE, OE and the data bus direction in each step of
+       the bus cycles, compiled once */
+    urj_part_signal_template_t read_start;
+    urj_part_signal_template_t read_end;
+    urj_part_signal_template_t write_start;
+    urj_part_signal_template_t write_strobe;
+    urj_part_signal_template_t write_end;
 } bus_params_t;
 
 #define A       ((bus_params_t *) bus->params)->a
@@ -68,6 +78,14 @@ typedef struct
 
 #define ASHIFT ((bus_params_t *) bus->params)->ashift
 
+#define VA      (&((bus_params_t *) bus->params)->va)
+#define VD      (&((bus_params_t *) bus->params)->vd)
+#define T_READ_START    (&((bus_params_t *) bus->params)->read_start)
+#define T_READ_END      (&((bus_params_t *) bus->params)->read_end)
+#define T_WRITE_START   (&((bus_params_t *) bus->params)->write_start)
+#define T_WRITE_STROBE  (&((bus_params_t *) bus->params)->write_strobe)
+#define T_WRITE_END     (&((bus_params_t *) bus->params)->write_end)
+
 static void
 prototype_bus_signal_parse (const char *str, char *fmt, int *inst)
 {
@@ -87,6 +105,45 @@ prototype_bus_signal_parse (const char *str, char *fmt, int *inst)
     // @@@@ RFHH what about failure?
 }
 
+/* @return 0 on success; 1 on error */
+static int
+prototype_bus_resolve (urj_bus_t *bus, const char *name,
+                       urj_part_signal_t **sig)
+{
+    *sig = urj_part_find_signal (bus->part, name);
+    if (!*sig)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, _("signal '%s' not found"), name);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* record the levels of one bus cycle step, level < 0 leaves a signal out */
+static int
+prototype_bus_step (urj_bus_t *bus, urj_part_signal_template_t *t, int cs,
+                    int we, int oe, int data_in)
+{
+    urj_part_t *p = bus->part;
+
+    urj_part_signal_template_init (t);
+    if ((cs >= 0 && urj_part_signal_template_add (p, t, CS, 1,
+                                                  cs ? CSA : !CSA)
+         != URJ_STATUS_OK)
+        || (we >= 0 && urj_part_signal_template_add (p, t, WE, 1,
+                                                     we ? WEA : !WEA)
+            != URJ_STATUS_OK)
+        || (oe >= 0 && urj_part_signal_template_add (p, t, OE, 1,
+                                                     oe ? OEA : !OEA)
+            != URJ_STATUS_OK)
+        || (data_in && urj_part_signal_template_add_input (t, VD)
+            != URJ_STATUS_OK))
+        return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
 /**
  * bus->driver->(*new_bus)
  *
@@ -96,7 +153,7 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
                    const urj_param_t *cmd_params[])
 {
     urj_bus_t *bus;
-    urj_part_signal_t *sig;
+    urj_part_signal_t *sig, *bus_sig[32];
     char buff[16], fmt[16], afmt[16], dfmt[16];
     int i, j, inst, max, min;
     int failed = 0;
@@ -241,12 +298,16 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         }
         AI = (AMSBI > ALSBI ? 1 : -1);
         AW = (AMSBI > ALSBI ? AMSBI - ALSBI : ALSBI - AMSBI) + 1;
-        for (i = 0, j = ALSBI; i < AW; i++, j += AI)
+        for (i = 0, j = ALSBI; i < AW && !failed; i++, j += AI)
         {
             sprintf (buff, afmt, j);
-            // @@@@ RFHH check result
-            A[j] = urj_part_find_signal (bus->part, buff);
+            failed = prototype_bus_resolve (bus, buff, &A[j]);
+            bus_sig[i] = A[j];
         }
+        if (!failed
+            && urj_part_signal_vector_init (bus->part, VA, bus_sig,
+                                            AW) != URJ_STATUS_OK)
+            failed = 1;
     }
     else
     {
@@ -280,11 +341,16 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         }
         DI = (DMSBI > DLSBI ? 1 : -1);
         DW = (DMSBI > DLSBI ? DMSBI - DLSBI : DLSBI - DMSBI) + 1;
-        for (i = 0, j = DLSBI; i < DW; i++, j += DI)
+        for (i = 0, j = DLSBI; i < DW && !failed; i++, j += DI)
         {
             sprintf (buff, dfmt, j);
-            D[j] = urj_part_find_signal (bus->part, buff);
+            failed = prototype_bus_resolve (bus, buff, &D[j]);
+            bus_sig[i] = D[j];
         }
+        if (!failed
+            && urj_part_signal_vector_init (bus->part, VD, bus_sig,
+                                            DW) != URJ_STATUS_OK)
+            failed = 1;
 
         /* bus drivers are called with a byte address
            this address needs to be adjusted by setup_address() to the memory data width */
@@ -336,6 +402,19 @@ prototype_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
         failed = 1;
     }
 
+    if (!failed
+        && (prototype_bus_step (bus, T_READ_START, 1, 0, 1, 1)
+            != URJ_STATUS_OK
+            || prototype_bus_step (bus, T_READ_END, 0, -1, 0, 0)
+            != URJ_STATUS_OK
+            || prototype_bus_step (bus, T_WRITE_START, 1, 0, 0, 0)
+            != URJ_STATUS_OK
+            || prototype_bus_step (bus, T_WRITE_STROBE, -1, 1, -1, 0)
+            != URJ_STATUS_OK
+            || prototype_bus_step (bus, T_WRITE_END, 0, 0, -1, 0)
+            != URJ_STATUS_OK))
+        failed = 1;
+
     if (failed)
     {
         urj_bus_generic_free (bus);
@@ -380,39 +459,25 @@ prototype_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-
-    a >>= ASHIFT;
-
-    for (i = 0, j = ALSBI; i < AW; i++, j += AI)
-        urj_part_set_signal (p, A[j], 1, (a >> i) & 1);
+    urj_part_set_vector (bus->part, VA, a >> ASHIFT);
 }
 
 static void
-set_data_in (urj_bus_t *bus)
+setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
-
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal_input (p, D[j]);
+    urj_part_set_vector (bus->part, VD, d);
 }
 
 static void
-setup_data (urj_bus_t *bus, uint32_t d)
+read_cycle_end (urj_bus_t *bus)
 {
-    int i, j;
-    urj_part_t *p = bus->part;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
+    urj_part_set_template (bus->part, T_READ_END);
+}
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        urj_part_set_signal (p, D[j], 1, (d >> i) & 1);
+static uint32_t
+get_data (urj_bus_t *bus, uint32_t adr)
+{
+    return urj_part_get_vector (bus->part, VD);
 }
 
 /**
@@ -422,15 +487,10 @@ setup_data (urj_bus_t *bus, uint32_t d)
 static int
 prototype_bus_read_start (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, CS, 1, CSA);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA);
-
+    urj_part_set_template (bus->part, T_READ_START);
     setup_address (bus, adr);
-    set_data_in (bus);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 
@@ -444,21 +504,12 @@ prototype_bus_read_start (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, adr, &area);
 
     setup_address (bus, adr);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
-
-    return d;
+    return get_data (bus, adr);
 }
 
 /**
@@ -468,22 +519,30 @@ prototype_bus_read_next (urj_bus_t *bus, uint32_t adr)
 static uint32_t
 prototype_bus_read_end (urj_bus_t *bus)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i, j;
-    uint32_t d = 0;
-    urj_bus_area_t area;
-
-    prototype_bus_area (bus, 0, &area);
 
-    urj_part_set_signal (p, CS, 1, CSA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA ? 0 : 1);
+    read_cycle_end (bus);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0, j = DLSBI; i < DW; i++, j += DI)
-        d |= (uint32_t) (urj_part_get_signal (p, D[j]) << i);
+    return get_data (bus, 0);
+}
+
+static const urj_bus_generic_pipeline_t prototype_pipeline = {
+    setup_address,
+    read_cycle_end,
+    get_data,
+};
 
-    return d;
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+prototype_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                          uint32_t len)
+{
+    return urj_bus_generic_read_pipelined (bus, adr, buf, len,
+                                           &prototype_pipeline);
 }
 
 /**
@@ -493,22 +552,17 @@ prototype_bus_read_end (urj_bus_t *bus)
 static void
 prototype_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
 {
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, CS, 1, CSA);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, OE, 1, OEA ? 0 : 1);
-
+    urj_part_set_template (bus->part, T_WRITE_START);
     setup_address (bus, adr);
     setup_data (bus, data);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 
-    urj_part_set_signal (p, WE, 1, WEA);
+    urj_part_set_template (bus->part, T_WRITE_STROBE);
     urj_tap_chain_shift_data_registers (chain, 0);
-    urj_part_set_signal (p, WE, 1, WEA ? 0 : 1);
-    urj_part_set_signal (p, CS, 1, CSA ? 0 : 1);
+    urj_part_set_template (bus->part, T_WRITE_END);
     urj_tap_chain_shift_data_registers (chain, 0);
 }
 
@@ -532,4 +586,6 @@ const urj_bus_driver_t urj_bus_prototype_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    prototype_bus_read_block,
+    NULL,
 };
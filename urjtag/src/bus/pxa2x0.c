@@ -121,6 +121,8 @@ typedef struct
     int inited;
     int proc;
     ncs_map_entry ncs_map[nCS_TOTAL];
+    urj_part_signal_vector_t vma;
+    urj_part_signal_vector_t vmd;
 } bus_params_t;
 
 #define PROC            ((bus_params_t *) bus->params)->proc
@@ -133,6 +135,8 @@ typedef struct
 #define nWE             ((bus_params_t *) bus->params)->nwe
 #define nOE             ((bus_params_t *) bus->params)->noe
 #define nSDCAS          ((bus_params_t *) bus->params)->nsdcas
+#define VMA             (&((bus_params_t *) bus->params)->vma)
+#define VMD             (&((bus_params_t *) bus->params)->vmd)
 
 #define MC_pointer      (&((bus_params_t *) bus->params)->MC_registers)
 
@@ -232,6 +236,12 @@ pxa2xx_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
     failed |= urj_bus_generic_attach_sig (part, &(nSDCAS), "nSDCAS");
 
+    if (!failed
+        && (urj_part_signal_vector_init (part, VMA, MA, 26) != URJ_STATUS_OK
+            || urj_part_signal_vector_init (part, VMD, MD,
+                                            32) != URJ_STATUS_OK))
+        failed = 1;
+
     if (failed)
     {
         urj_bus_generic_free (bus);
@@ -537,37 +547,27 @@ pxa27x_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
 static void
 setup_address (urj_bus_t *bus, uint32_t a)
 {
-    int i;
-    urj_part_t *p = bus->part;
-
-    for (i = 0; i < 26; i++)
-        urj_part_set_signal (p, MA[i], 1, (a >> i) & 1);
+    urj_part_set_vector (bus->part, VMA, a);
 }
 
 static void
 set_data_in (urj_bus_t *bus, uint32_t adr)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     bus->driver->area (bus, adr, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, MD[i]);
+    urj_part_set_vector_input_n (bus->part, VMD, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t adr, uint32_t d)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     bus->driver->area (bus, adr, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, MD[i], 1, (d >> i) & 1);
+    urj_part_set_vector_n (bus->part, VMD, area.width, d);
 }
 
 /**
@@ -625,14 +625,12 @@ pxa2xx_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
     urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    uint32_t d;
     uint32_t old_last_adr = LAST_ADR;
 
     LAST_ADR = adr;
 
     if (adr < UINT32_C (0x18000000))
     {
-        int i;
         urj_bus_area_t area;
 
         if (nCS[adr >> 26] == NULL)     // avoid undefined nCS windows
@@ -644,11 +642,7 @@ pxa2xx_bus_read_next (urj_bus_t *bus, uint32_t adr)
         setup_address (bus, adr);
         urj_tap_chain_shift_data_registers (chain, 1);
 
-        d = 0;
-        for (i = 0; i < area.width; i++)
-            d |= (uint32_t) (urj_part_get_signal (p, MD[i]) << i);
-
-        return d;
+        return urj_part_get_vector_n (p, VMD, area.width);
     }
 
     // anything above 0x18000000 is essentially unreachable...
@@ -678,8 +672,6 @@ pxa2xx_bus_read_end (urj_bus_t *bus)
 
     if (LAST_ADR < UINT32_C (0x18000000))
     {
-        int i;
-        uint32_t d = 0;
         urj_bus_area_t area;
 
         if (nCS[LAST_ADR >> 26] == NULL)        // avoid undefined nCS windows
@@ -694,10 +686,7 @@ pxa2xx_bus_read_end (urj_bus_t *bus)
 
         urj_tap_chain_shift_data_registers (chain, 1);
 
-        for (i = 0; i < area.width; i++)
-            d |= (uint32_t) (urj_part_get_signal (p, MD[i]) << i);
-
-        return d;
+        return urj_part_get_vector_n (p, VMD, area.width);
     }
 
     // anything above 0x18000000 is essentially unreachable...
@@ -31,6 +31,7 @@
 #include <sysdep.h>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <urjtag/log.h>
@@ -38,17 +39,129 @@
 #include <urjtag/bus.h>
 #include <urjtag/flash.h>
 #include <urjtag/jtag.h>
+#include <urjtag/fclock.h>
 
-int
-urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
+/* bus words read per chunk, the bytes of a chunk are packed in place */
+#define CHUNK_WORDS     (64 * 1024)
+
+/* bus words read at a time within a chunk, between progress reports */
+#define BLOCK_WORDS     (4 * 1024)
+
+/* seconds between two progress log lines */
+#define PROGRESS_PERIOD 0.5
+
+static void
+readmem_log_progress (void *data, uint64_t done, uint64_t total,
+                      double elapsed)
+{
+    double *last = data;
+    double rate;
+
+    if (done < total && elapsed - *last < PROGRESS_PERIOD)
+        return;
+    *last = elapsed;
+
+    rate = elapsed > 0 ? done / elapsed : 0;
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("read: 0x%08llX of 0x%08llX  %6.1f KiB/s  ETA %4.0f s\r"),
+             (long long unsigned) done, (long long unsigned) total,
+             rate / 1024, rate > 0 ? (total - done) / rate : 0.0);
+}
+
+/*
+ * pack n bus words of step bytes into the bytes of the file at b, which
+ * may be w itself or lie before it in the same buffer
+ */
+static void
+pack_words (uint8_t *b, const uint32_t *w, uint32_t n, uint32_t step,
+            int big_endian)
+{
+    uint32_t i;
+
+    /* the bytes of word i never reach word i + 1 */
+    switch (step * 2 + big_endian)
+    {
+    case 2:
+    case 3:
+        for (i = 0; i < n; i++)
+            b[i] = w[i];
+        break;
+    case 4:
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = w[i];
+
+            b[2 * i] = d;
+            b[2 * i + 1] = d >> 8;
+        }
+        break;
+    case 5:
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = w[i];
+
+            b[2 * i] = d >> 8;
+            b[2 * i + 1] = d;
+        }
+        break;
+    case 8:
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = w[i];
+
+            b[4 * i] = d;
+            b[4 * i + 1] = d >> 8;
+            b[4 * i + 2] = d >> 16;
+            b[4 * i + 3] = d >> 24;
+        }
+        break;
+    case 9:
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = w[i];
+
+            b[4 * i] = d >> 24;
+            b[4 * i + 1] = d >> 16;
+            b[4 * i + 2] = d >> 8;
+            b[4 * i + 3] = d;
+        }
+        break;
+    default:
+        /* 24 bit buses */
+        for (i = 0; i < n; i++)
+        {
+            uint32_t d = w[i];
+            uint32_t j;
+
+            for (j = 0; j < step; j++)
+                b[step * i + j] = d >> (8 * (big_endian ? step - 1 - j : j));
+        }
+        break;
+    }
+}
+
+/* the file bytes of bus address a onwards, n of them */
+typedef int (*readmem_sink_t) (void *sink_data, const uint8_t *b, uint32_t n,
+                               uint64_t a);
+
+/*
+ * read memory as urj_bus_readmem() does, handing each block to block_sink
+ * as soon as it has been read and each chunk to chunk_sink; either may be
+ * NULL
+ */
+static int
+readmem_stream (urj_bus_t *bus, uint32_t addr, uint32_t len,
+                readmem_sink_t block_sink, readmem_sink_t chunk_sink,
+                void *sink_data, urj_bus_progress_func_t progress, void *data)
 {
     uint32_t step;
     uint64_t a;
-    size_t bc = 0;
-#define BSIZE 4096
-    uint8_t b[BSIZE];
+    uint32_t *w;
     urj_bus_area_t area;
     uint64_t end;
+    long double start;
+    int big_endian;
+    int r = URJ_STATUS_OK;
 
     if (!bus)
     {
@@ -63,17 +176,11 @@ urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
 
     step = area.width / 8;
 
-    if (step == 0)
+    if (step == 0 || step > 4)
     {
         urj_error_set (URJ_ERROR_INVALID,  _("Unknown bus width"));
         return URJ_STATUS_FAIL;
     }
-    if (BSIZE % step != 0)
-    {
-        urj_error_set (URJ_ERROR_INVALID, "step %lu must divide BSIZE %d",
-                       (long unsigned) step, BSIZE);
-        return URJ_STATUS_FAIL;
-    }
 
     addr = addr & (~(step - 1));
     len = (len + step - 1) & (~(step - 1));
@@ -89,48 +196,272 @@ urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
         return URJ_STATUS_FAIL;
     }
 
+    w = malloc (CHUNK_WORDS * sizeof *w);
+    if (w == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       CHUNK_WORDS * sizeof *w);
+        return URJ_STATUS_FAIL;
+    }
+
     a = addr;
     end = a + len;
     urj_log (URJ_LOG_LEVEL_NORMAL, _("reading:\n"));
+    big_endian = urj_get_file_endian () == URJ_ENDIAN_BIG;
+    start = urj_lib_frealtime ();
 
-    if (URJ_BUS_READ_START (bus, addr) != URJ_STATUS_OK)
-        return URJ_STATUS_FAIL;
-
-    for (a += step; a <= end; a += step)
+    while (a < end && r == URJ_STATUS_OK)
     {
-        uint32_t data;
-        int j;
+        uint32_t n = CHUNK_WORDS;
+        uint32_t k, m;
 
-        if (a < end)
-            data = URJ_BUS_READ_NEXT (bus, a);
-        else
-            data = URJ_BUS_READ_END (bus);
+        if (n > (end - a) / step)
+            n = (end - a) / step;
+
+        /* the packed bytes of the blocks before k end below word k */
+        for (k = 0; k < n; k += m)
+        {
+            m = n - k < BLOCK_WORDS ? n - k : BLOCK_WORDS;
 
-        for (j = step; j > 0; j--)
-            if (urj_get_file_endian () == URJ_ENDIAN_BIG)
-                b[bc++] = (data >> ((j - 1) * 8)) & 0xFF;
-            else
+            if (URJ_BUS_READ_BLOCK (bus, a + k * step, w + k, m)
+                != URJ_STATUS_OK)
             {
-                b[bc++] = data & 0xFF;
-                data >>= 8;
+                r = URJ_STATUS_FAIL;
+                break;
             }
-
-        if ((bc >= BSIZE) || (a >= end))
-        {
-            urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
-                     (long long unsigned) a);
-            if (fwrite (b, bc, 1, f) != 1)
+            pack_words ((uint8_t *) w + k * step, w + k, m, step, big_endian);
+            if (block_sink
+                && block_sink (sink_data, (uint8_t *) w + k * step, m * step,
+                               a + k * step) != URJ_STATUS_OK)
             {
-                urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
-                urj_error_state.sys_errno = ferror(f);
-                clearerr(f);
-                return URJ_STATUS_FAIL;
+                r = URJ_STATUS_FAIL;
+                break;
             }
-            bc = 0;
+
+            if (progress)
+                progress (data, a + (k + m) * step - addr, len,
+                          urj_lib_frealtime () - start);
         }
+
+        if (r == URJ_STATUS_OK && chunk_sink
+            && chunk_sink (sink_data, (uint8_t *) w, n * step, a)
+            != URJ_STATUS_OK)
+            r = URJ_STATUS_FAIL;
+        a += n * step;
     }
 
-    urj_log (URJ_LOG_LEVEL_NORMAL, _("\nDone.\n"));
+    free (w);
+
+    return r;
+}
+
+static int
+readmem_write (void *sink_data, const uint8_t *b, uint32_t n, uint64_t a)
+{
+    FILE *f = sink_data;
+
+    if (fwrite (b, n, 1, f) != 1)
+    {
+        urj_error_set (URJ_ERROR_FILEIO, "fwrite fails");
+        urj_error_state.sys_errno = ferror(f);
+        clearerr(f);
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_bus_readmem_progress (urj_bus_t *bus, FILE *f, uint32_t addr,
+                          uint32_t len, urj_bus_progress_func_t progress,
+                          void *data)
+{
+    return readmem_stream (bus, addr, len, NULL, readmem_write, f, progress,
+                           data);
+}
+
+int
+urj_bus_readmem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
+{
+    double last = 0;
+    int r;
+
+    r = urj_bus_readmem_progress (bus, f, addr, len, readmem_log_progress,
+                                  &last);
+    if (r == URJ_STATUS_OK)
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("\nDone.\n"));
+
+    return r;
+}
+
+/* mismatching ranges listed by urj_bus_verifymem */
+#define VERIFY_RANGES   32
+
+typedef struct
+{
+    FILE *f;
+    int flags;
+    uint8_t *buf;               /* file bytes of a block */
+    uint64_t left;              /* file bytes not compared yet */
+    uint64_t differ;            /* number of differing bytes */
+    uint64_t last;              /* address of the last one */
+    int ranges;                 /* number of differing ranges */
+    uint64_t range[VERIFY_RANGES][2];
+}
+verify_t;
+
+static int
+verify_block (void *sink_data, const uint8_t *b, uint32_t n, uint64_t a)
+{
+    verify_t *v = sink_data;
+    size_t got;
+    uint32_t i;
+
+    /* the bus width may round the length up past the end of the file */
+    if (n > v->left)
+        n = v->left;
+    got = fread (v->buf, 1, n, v->f);
+    if (got != n)
+    {
+        if (ferror (v->f))
+        {
+            urj_error_set (URJ_ERROR_FILEIO, "fread fails");
+            urj_error_state.sys_errno = ferror (v->f);
+            clearerr (v->f);
+        }
+        else
+            urj_error_set (URJ_ERROR_FILEIO,
+                           _("file ends before address 0x%08llX"),
+                           (long long unsigned) (a + got));
+        return URJ_STATUS_FAIL;
+    }
+    v->left -= n;
+
+    if (memcmp (b, v->buf, n) == 0)
+        return URJ_STATUS_OK;
+
+    for (i = 0; i < n; i++)
+    {
+        if (b[i] == v->buf[i])
+            continue;
+
+        if (v->flags & URJ_BUS_VERIFY_STOP)
+        {
+            urj_error_set (URJ_ERROR_BUS,
+                           _("verify error at 0x%08llX: read 0x%02X, expected 0x%02X"),
+                           (long long unsigned) (a + i), b[i], v->buf[i]);
+            return URJ_STATUS_FAIL;
+        }
+
+        if (v->differ == 0 || v->last != a + i - 1)
+        {
+            if (v->ranges < VERIFY_RANGES)
+                v->range[v->ranges][0] = a + i;
+            v->ranges++;
+        }
+        if (v->ranges <= VERIFY_RANGES)
+            v->range[v->ranges - 1][1] = a + i;
+        v->last = a + i;
+        v->differ++;
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_bus_verifymem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len,
+                   int flags)
+{
+    verify_t v;
+    double last = 0;
+    int r, i;
+
+    v.buf = malloc (BLOCK_WORDS * sizeof (uint32_t));
+    if (v.buf == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       BLOCK_WORDS * sizeof (uint32_t));
+        return URJ_STATUS_FAIL;
+    }
+    v.f = f;
+    v.flags = flags;
+    v.left = len;
+    v.differ = 0;
+    v.ranges = 0;
+
+    r = readmem_stream (bus, addr, len, verify_block, NULL, &v,
+                        readmem_log_progress, &last);
+    free (v.buf);
+    if (r != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, "\n");
+    if (v.differ == 0)
+    {
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("Memory matches the file.\n"));
+        return URJ_STATUS_OK;
+    }
+
+    for (i = 0; i < v.ranges && i < VERIFY_RANGES; i++)
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("differs: 0x%08llX - 0x%08llX\n"),
+                 (long long unsigned) v.range[i][0],
+                 (long long unsigned) v.range[i][1]);
+    if (v.ranges > VERIFY_RANGES)
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("... and %d more ranges\n"),
+                 v.ranges - VERIFY_RANGES);
+
+    urj_error_set (URJ_ERROR_BUS,
+                   _("verify error: %llu bytes differ in %d ranges"),
+                   (long long unsigned) v.differ, v.ranges);
+    return URJ_STATUS_FAIL;
+}
+
+/* CRC-32 as in zlib and PNG, reflected polynomial 0xEDB88320 */
+static uint32_t crc_table[256];
+
+static void
+crc_table_init (void)
+{
+    uint32_t i, j, c;
+
+    for (i = 0; i < 256; i++)
+    {
+        c = i;
+        for (j = 0; j < 8; j++)
+            c = (c & 1) ? (c >> 1) ^ UINT32_C (0xEDB88320) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static int
+crc_block (void *sink_data, const uint8_t *b, uint32_t n, uint64_t a)
+{
+    uint32_t *crc = sink_data;
+    uint32_t c = *crc;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+        c = crc_table[(c ^ b[i]) & 0xFF] ^ (c >> 8);
+    *crc = c;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_bus_crcmem (urj_bus_t *bus, uint32_t addr, uint32_t len, uint32_t *crc)
+{
+    uint32_t c = ~UINT32_C (0);
+    double last = 0;
+
+    if (crc_table[1] == 0)
+        crc_table_init ();
+
+    if (readmem_stream (bus, addr, len, crc_block, NULL, &c,
+                        readmem_log_progress, &last) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, "\n");
+    *crc = ~c;
 
     return URJ_STATUS_OK;
 }
@@ -48,6 +48,15 @@ typedef struct
     urj_part_signal_t *rd_nwr;
     urj_part_signal_t *nwe;
     urj_part_signal_t *noe;
+    urj_part_signal_vector_t va;
+    urj_part_signal_vector_t vd;
+    urj_part_signal_vector_t vcs;
+    /* levels of RD_nWR, nWE and nOE in the steps of the bus cycles */
+    urj_part_signal_template_t read_start;
+    urj_part_signal_template_t read_end;
+    urj_part_signal_template_t write_start;
+    urj_part_signal_template_t write_strobe;
+    urj_part_signal_template_t write_end;
 } bus_params_t;
 
 #define A       ((bus_params_t *) bus->params)->a
@@ -56,6 +65,34 @@ typedef struct
 #define RD_nWR  ((bus_params_t *) bus->params)->rd_nwr
 #define nWE     ((bus_params_t *) bus->params)->nwe
 #define nOE     ((bus_params_t *) bus->params)->noe
+#define VA      (&((bus_params_t *) bus->params)->va)
+#define VD      (&((bus_params_t *) bus->params)->vd)
+#define VCS     (&((bus_params_t *) bus->params)->vcs)
+
+#define T_READ_START    (&((bus_params_t *) bus->params)->read_start)
+#define T_READ_END      (&((bus_params_t *) bus->params)->read_end)
+#define T_WRITE_START   (&((bus_params_t *) bus->params)->write_start)
+#define T_WRITE_STROBE  (&((bus_params_t *) bus->params)->write_strobe)
+#define T_WRITE_END     (&((bus_params_t *) bus->params)->write_end)
+
+/* record the levels of one bus cycle step, level < 0 leaves a signal out */
+static int
+sa1110_bus_step (urj_bus_t *bus, urj_part_signal_template_t *t, int rd_nwr,
+                 int nwe, int noe)
+{
+    urj_part_t *p = bus->part;
+
+    urj_part_signal_template_init (t);
+    if ((rd_nwr >= 0 && urj_part_signal_template_add (p, t, RD_nWR, 1, rd_nwr)
+         != URJ_STATUS_OK)
+        || (nwe >= 0 && urj_part_signal_template_add (p, t, nWE, 1, nwe)
+            != URJ_STATUS_OK)
+        || (noe >= 0 && urj_part_signal_template_add (p, t, nOE, 1, noe)
+            != URJ_STATUS_OK))
+        return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
 
 /**
  * bus->driver->(*new_bus)
@@ -100,6 +137,19 @@ sa1110_bus_new (urj_chain_t *chain, const urj_bus_driver_t *driver,
 
     failed |= urj_bus_generic_attach_sig (part, &(nOE), "nOE");
 
+    if (!failed
+        && (urj_part_signal_vector_init (part, VA, A, 26) != URJ_STATUS_OK
+            || urj_part_signal_vector_init (part, VD, D, 32) != URJ_STATUS_OK
+            || urj_part_signal_vector_init (part, VCS, nCS, 6) != URJ_STATUS_OK
+            || sa1110_bus_step (bus, T_READ_START, 1, 1, 0) != URJ_STATUS_OK
+            || sa1110_bus_step (bus, T_READ_END, -1, -1, 1) != URJ_STATUS_OK
+            || sa1110_bus_step (bus, T_WRITE_START, 0, 1, 1) != URJ_STATUS_OK
+            || sa1110_bus_step (bus, T_WRITE_STROBE, -1, 0, -1)
+            != URJ_STATUS_OK
+            || sa1110_bus_step (bus, T_WRITE_END, -1, 1, -1)
+            != URJ_STATUS_OK))
+        failed = 1;
+
     if (failed)
     {
         urj_bus_generic_free (bus);
@@ -143,40 +193,62 @@ sa1110_bus_area (urj_bus_t *bus, uint32_t adr, urj_bus_area_t *area)
     return URJ_STATUS_OK;
 }
 
+/* drive the nCS line of the bank of adr low and the others high */
 static void
-setup_address (urj_bus_t *bus, uint32_t a)
+select_chip (urj_bus_t *bus, uint32_t adr)
 {
-    int i;
-    urj_part_t *p = bus->part;
+    uint32_t bank = adr >> 27;
+    uint32_t ncs = 0x3f;
 
-    for (i = 0; i < 26; i++)
-        urj_part_set_signal (p, A[i], 1, (a >> i) & 1);
+    if (bank < 4)
+        ncs &= ~(1 << bank);
+    else if (bank == 8 || bank == 9)
+        ncs &= ~(1 << (bank - 4));
+
+    urj_part_set_vector (bus->part, VCS, ncs);
+}
+
+static void
+setup_address (urj_bus_t *bus, uint32_t a)
+{
+    urj_part_set_vector (bus->part, VA, a);
 }
 
 static void
 set_data_in (urj_bus_t *bus)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     sa1110_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal_input (p, D[i]);
+    urj_part_set_vector_input_n (bus->part, VD, area.width);
 }
 
 static void
 setup_data (urj_bus_t *bus, uint32_t d)
 {
-    int i;
-    urj_part_t *p = bus->part;
     urj_bus_area_t area;
 
     sa1110_bus_area (bus, 0, &area);
 
-    for (i = 0; i < area.width; i++)
-        urj_part_set_signal (p, D[i], 1, (d >> i) & 1);
+    urj_part_set_vector_n (bus->part, VD, area.width, d);
+}
+
+static void
+read_cycle_end (urj_bus_t *bus)
+{
+    urj_part_set_vector (bus->part, VCS, 0x3f);
+    urj_part_set_template (bus->part, T_READ_END);
+}
+
+static uint32_t
+get_data (urj_bus_t *bus, uint32_t adr)
+{
+    urj_bus_area_t area;
+
+    sa1110_bus_area (bus, adr, &area);
+
+    return urj_part_get_vector_n (bus->part, VD, area.width);
 }
 
 /**
@@ -187,18 +259,10 @@ static int
 sa1110_bus_read_start (urj_bus_t *bus, uint32_t adr)
 {
     /* see Figure 10-12 in [1] */
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, nCS[0], 1, (adr >> 27) != 0);
-    urj_part_set_signal (p, nCS[1], 1, (adr >> 27) != 1);
-    urj_part_set_signal (p, nCS[2], 1, (adr >> 27) != 2);
-    urj_part_set_signal (p, nCS[3], 1, (adr >> 27) != 3);
-    urj_part_set_signal (p, nCS[4], 1, (adr >> 27) != 8);
-    urj_part_set_signal (p, nCS[5], 1, (adr >> 27) != 9);
-    urj_part_set_signal_high (p, RD_nWR);
-    urj_part_set_signal_high (p, nWE);
-    urj_part_set_signal_low (p, nOE);
+    select_chip (bus, adr);
+    urj_part_set_template (bus->part, T_READ_START);
 
     setup_address (bus, adr);
     set_data_in (bus);
@@ -216,21 +280,12 @@ static uint32_t
 sa1110_bus_read_next (urj_bus_t *bus, uint32_t adr)
 {
     /* see Figure 10-12 in [1] */
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i;
-    uint32_t d = 0;
-    urj_bus_area_t area;
-
-    sa1110_bus_area (bus, adr, &area);
 
     setup_address (bus, adr);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, D[i]) << i);
-
-    return d;
+    return get_data (bus, adr);
 }
 
 /**
@@ -241,27 +296,30 @@ static uint32_t
 sa1110_bus_read_end (urj_bus_t *bus)
 {
     /* see Figure 10-12 in [1] */
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
-    int i;
-    uint32_t d = 0;
-    urj_bus_area_t area;
 
-    sa1110_bus_area (bus, 0, &area);
-
-    urj_part_set_signal_high (p, nCS[0]);
-    urj_part_set_signal_high (p, nCS[1]);
-    urj_part_set_signal_high (p, nCS[2]);
-    urj_part_set_signal_high (p, nCS[3]);
-    urj_part_set_signal_high (p, nCS[4]);
-    urj_part_set_signal_high (p, nCS[5]);
-    urj_part_set_signal_high (p, nOE);
+    read_cycle_end (bus);
     urj_tap_chain_shift_data_registers (chain, 1);
 
-    for (i = 0; i < area.width; i++)
-        d |= (uint32_t) (urj_part_get_signal (p, D[i]) << i);
+    return get_data (bus, 0);
+}
+
+static const urj_bus_generic_pipeline_t sa1110_pipeline = {
+    setup_address,
+    read_cycle_end,
+    get_data,
+};
 
-    return d;
+/**
+ * bus->driver->(*read_block)
+ *
+ */
+static int
+sa1110_bus_read_block (urj_bus_t *bus, uint32_t adr, uint32_t *buf,
+                       uint32_t len)
+{
+    return urj_bus_generic_read_pipelined (bus, adr, buf, len,
+                                           &sa1110_pipeline);
 }
 
 /**
@@ -272,33 +330,20 @@ static void
 sa1110_bus_write (urj_bus_t *bus, uint32_t adr, uint32_t data)
 {
     /* see Figure 10-16 in [1] */
-    urj_part_t *p = bus->part;
     urj_chain_t *chain = bus->chain;
 
-    urj_part_set_signal (p, nCS[0], 1, (adr >> 27) != 0);
-    urj_part_set_signal (p, nCS[1], 1, (adr >> 27) != 1);
-    urj_part_set_signal (p, nCS[2], 1, (adr >> 27) != 2);
-    urj_part_set_signal (p, nCS[3], 1, (adr >> 27) != 3);
-    urj_part_set_signal (p, nCS[4], 1, (adr >> 27) != 8);
-    urj_part_set_signal (p, nCS[5], 1, (adr >> 27) != 9);
-    urj_part_set_signal_low (p, RD_nWR);
-    urj_part_set_signal_high (p, nWE);
-    urj_part_set_signal_high (p, nOE);
+    select_chip (bus, adr);
+    urj_part_set_template (bus->part, T_WRITE_START);
 
     setup_address (bus, adr);
     setup_data (bus, data);
 
     urj_tap_chain_shift_data_registers (chain, 0);
 
-    urj_part_set_signal_low (p, nWE);
+    urj_part_set_template (bus->part, T_WRITE_STROBE);
     urj_tap_chain_shift_data_registers (chain, 0);
-    urj_part_set_signal_high (p, nWE);
-    urj_part_set_signal_high (p, nCS[0]);
-    urj_part_set_signal_high (p, nCS[1]);
-    urj_part_set_signal_high (p, nCS[2]);
-    urj_part_set_signal_high (p, nCS[3]);
-    urj_part_set_signal_high (p, nCS[4]);
-    urj_part_set_signal_high (p, nCS[5]);
+    urj_part_set_template (bus->part, T_WRITE_END);
+    urj_part_set_vector (bus->part, VCS, 0x3f);
     urj_tap_chain_shift_data_registers (chain, 0);
 }
 
@@ -320,4 +365,6 @@ const urj_bus_driver_t urj_bus_sa1110_bus = {
     urj_bus_generic_no_enable,
     urj_bus_generic_no_disable,
     URJ_BUS_TYPE_PARALLEL,
+    sa1110_bus_read_block,
+    NULL,
 };
@@ -41,6 +41,7 @@ urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
     int bidx = 0;
 #define BSIZE 4096
     uint8_t b[BSIZE];
+    uint32_t w[BSIZE];
     urj_bus_area_t area;
     uint64_t end;
 
@@ -87,59 +88,68 @@ urj_bus_writemem (urj_bus_t *bus, FILE *f, uint32_t addr, uint32_t len)
     end = a + len;
     urj_log (URJ_LOG_LEVEL_NORMAL, _("writing:\n"));
 
-    for (; a < end; a += step)
+    while (a < end)
     {
-        uint32_t data;
-        int j;
+        size_t want = BSIZE;
+        uint32_t n, i;
+
+        if (want > end - a)
+            want = end - a;
 
         /* Read one block of data */
-        if (bc == 0)
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
+                 (long long unsigned) a);
+        bc = fread (b, 1, want, f);
+        if (bc != want)
         {
-            urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08llX\r"),
-                     (long long unsigned) a);
-            bc = fread (b, 1, BSIZE, f);
-            if (bc != BSIZE)
+            urj_log (URJ_LOG_LEVEL_NORMAL, _("Short read: bc=0x%zX\n"), bc);
+            if (bc < step)
             {
-                urj_log (URJ_LOG_LEVEL_NORMAL, _("Short read: bc=0x%zX\n"), bc);
-                if (bc < step)
+                // Not even enough for one step. Something is wrong. Check
+                // the file state and bail out.
+                if (feof (f))
+                    urj_error_set (URJ_ERROR_FILEIO,
+                        _("Unexpected end of file; Addr: 0x%08llX\n"),
+                        (long long unsigned) a);
+                else
                 {
-                    // Not even enough for one step. Something is wrong. Check
-                    // the file state and bail out.
-                    if (feof (f))
-                        urj_error_set (URJ_ERROR_FILEIO,
-                            _("Unexpected end of file; Addr: 0x%08llX\n"),
-                            (long long unsigned) a);
-                    else
-                    {
-                        urj_error_set (URJ_ERROR_FILEIO, "fread fails");
-                        urj_error_state.sys_errno = ferror(f);
-                        clearerr(f);
-                    }
-
-                    return URJ_STATUS_FAIL;
+                    urj_error_set (URJ_ERROR_FILEIO, "fread fails");
+                    urj_error_state.sys_errno = ferror(f);
+                    clearerr(f);
                 }
-                /* else, process what we have read, then return to fread() to
-                 * meet the error condition (again) */
+
+                return URJ_STATUS_FAIL;
             }
-            bidx = 0;
+            /* else, process what we have read, then return to fread() to
+             * meet the error condition (again) */
         }
 
-        /* Write a word at a time */
-        data = 0;
-        for (j = step; j > 0 && bc > 0; j--)
+        /* Assemble the bus words of the block */
+        n = (bc + step - 1) / step;
+        bidx = 0;
+        for (i = 0; i < n; i++)
         {
-            if (urj_get_file_endian () == URJ_ENDIAN_BIG)
+            uint32_t data = 0;
+            int j;
+
+            for (j = step; j > 0 && bc > 0; j--)
             {
-                /* first shift doesn't matter: data = 0 */
-                data <<= 8;
-                data |= b[bidx++];
+                if (urj_get_file_endian () == URJ_ENDIAN_BIG)
+                {
+                    /* first shift doesn't matter: data = 0 */
+                    data <<= 8;
+                    data |= b[bidx++];
+                }
+                else
+                    data |= (b[bidx++] << ((step - j) * 8));
+                bc--;
             }
-            else
-                data |= (b[bidx++] << ((step - j) * 8));
-            bc--;
+            w[i] = data;
         }
 
-        URJ_BUS_WRITE (bus, a, data);
+        if (URJ_BUS_WRITE_BLOCK (bus, a, w, n) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        a += n * step;
     }
 
     urj_log (URJ_LOG_LEVEL_NORMAL, _("\nDone.\n"));
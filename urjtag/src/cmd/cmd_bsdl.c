@@ -83,6 +83,9 @@ cmd_bsdl_run (urj_chain_t *chain, char *params[])
         }
     }
 
+    if (strcmp (params[1], "index") == 0 && num_params == 2)
+        result = urj_bsdl_index (chain) == URJ_STATUS_OK ? 1 : -1;
+
     if (num_params == 3)
     {
         if (strcmp (params[1], "path") == 0)
@@ -91,6 +94,16 @@ cmd_bsdl_run (urj_chain_t *chain, char *params[])
             result = 1;
         }
 
+        if (strcmp (params[1], "jobs") == 0)
+        {
+            long unsigned jobs;
+
+            if (urj_cmd_get_number (params[2], &jobs) != URJ_STATUS_OK)
+                return URJ_STATUS_FAIL;
+            globs->jobs = jobs;
+            result = 1;
+        }
+
         if (strcmp (params[1], "debug") == 0)
         {
             if (strcmp (params[2], "on") == 0)
@@ -125,6 +138,8 @@ cmd_bsdl_complete (urj_chain_t *chain, char ***matches, size_t *match_cnt,
         "path",
         "test",
         "dump",
+        "index",
+        "jobs",
         "debug",
     };
 
@@ -158,12 +173,19 @@ cmd_bsdl_help (void)
              _("Usage: %s path PATHLIST\n"
                "Usage: %s test [FILE]\n"
                "Usage: %s dump [FILE]\n"
+               "Usage: %s index\n"
+               "Usage: %s jobs N\n"
                "Usage: %s debug on|off\n"
                "Manage BSDL files\n"
                "\n"
                "PATHLIST semicolon separated list of directory paths to search for BSDL files\n"
-               "FILE file containing part description in BSDL format\n"),
-            "bsdl", "bsdl", "bsdl", "bsdl");
+               "FILE file containing part description in BSDL format\n"
+               "\n"
+               "index creates or updates the IDCODE index in each directory of PATHLIST.\n"
+               "detect does so as well when it looks for a part.\n"
+               "jobs sets the number of threads that read files for index, test and\n"
+               "dump; 0 uses one per CPU.\n"),
+            "bsdl", "bsdl", "bsdl", "bsdl", "bsdl", "bsdl");
 }
 
 const urj_cmd_t urj_cmd_bsdl = {
@@ -125,6 +125,10 @@ cmd_cable_help (void)
                "DRIVER_OPTS options for the selected cable\n"
                "\n"
                "Type \"cable DRIVER help\" for info about options for cable DRIVER.\n"
+               "All drivers also accept queue=N, the initial number of entries\n"
+               "in the JTAG activity queue (rounded up to a power of two).\n"
+               "USB cables built on FT2232 or USB-Blaster take iothread to send\n"
+               "data from a background thread.\n"
                "You can also use the driver \"probe\" to attempt autodetection.\n"
                "\n" "List of supported cables:\n"),
              "cable");
@@ -0,0 +1,88 @@
+/*
+ * $Id$
+ *
+ * Compute the CRC-32 of memory content
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdint.h>
+
+#include <urjtag/error.h>
+#include <urjtag/bus.h>
+
+#include <urjtag/cmd.h>
+
+#include "cmd.h"
+
+static int
+cmd_crcmem_run (urj_chain_t *chain, char *params[])
+{
+    long unsigned adr;
+    long unsigned len;
+    uint32_t crc;
+    int r;
+
+    if (urj_cmd_params (params) != 3)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: #parameters should be %d, not %d",
+                       params[0], 3, urj_cmd_params (params));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (!urj_bus)
+    {
+        urj_error_set (URJ_ERROR_ILLEGAL_STATE, _("Bus missing"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (urj_cmd_get_number (params[1], &adr) != URJ_STATUS_OK
+        || urj_cmd_get_number (params[2], &len) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    r = urj_bus_crcmem (urj_bus, adr, len, &crc);
+    if (r == URJ_STATUS_OK)
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("CRC-32: 0x%08lX\n"),
+                 (long unsigned) crc);
+
+    return r;
+}
+
+static void
+cmd_crcmem_help (void)
+{
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Usage: %s ADDR LEN\n"
+               "Print the CRC-32 (as zlib) of device memory content starting with ADDR,\n"
+               "i.e. of the file readmem would write.\n"
+               "\n"
+               "ADDR       start address of the memory area\n"
+               "LEN        memory length\n"
+               "\n"
+               "ADDR and LEN could be in decimal or hexadecimal (prefixed with 0x) form.\n"),
+             "crcmem");
+}
+
+const urj_cmd_t urj_cmd_crcmem = {
+    "crcmem",
+    N_("print the CRC-32 of the memory content"),
+    cmd_crcmem_help,
+    cmd_crcmem_run,
+};
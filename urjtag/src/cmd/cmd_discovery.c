@@ -62,8 +62,15 @@ cmd_discovery_help (void)
                " 1. IR (instruction register) length\n"
                " 2. DR (data register) length for all possible instructions\n"
                "\n"
+               "The results are printed as a table with one line per instruction:\n"
+               "IR value, DR length and the value captured in the DR, separated by\n"
+               "tabs.  The DR length is -1 and the captured value '-' where they\n"
+               "could not be found.\n"
+               "\n"
                "Warning: This may be dangerous for some parts (especially if the\n"
-               "part doesn't have TRST signal).\n"), "discovery",
+               "part doesn't have TRST signal).  Instructions are surveyed in\n"
+               "batches; within a batch the TAP is reset by TMS, which updates the\n"
+               "data registers with zeros.\n"), "discovery",
             "discovery");
 }
 
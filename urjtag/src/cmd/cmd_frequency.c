@@ -52,8 +52,15 @@ cmd_frequency_run (urj_chain_t *chain, char *params[])
 
     if (urj_cmd_params (params) == 1)
     {
+        uint32_t requested;
+
         urj_log (URJ_LOG_LEVEL_NORMAL, _("Current TCK frequency is %lu Hz\n"),
                  (long unsigned) urj_tap_cable_get_frequency (chain->cable));
+        requested = urj_tap_cable_get_requested_frequency (chain->cable);
+        if (requested != 0
+            && requested != urj_tap_cable_get_frequency (chain->cable))
+            urj_log (URJ_LOG_LEVEL_NORMAL, _("Requested TCK frequency is %lu Hz\n"),
+                     (long unsigned) requested);
         return URJ_STATUS_OK;
     }
 
@@ -80,7 +87,10 @@ cmd_frequency_help (void)
                "adapter.\n"
                "\n"
                "FREQ must be an unsigned integer. Minimum allowed frequency is 1 Hz.\n"
-               "Use 0 for FREQ to disable frequency limit.\n"),
+               "Use 0 for FREQ to disable frequency limit.\n"
+               "\n"
+               "Without FREQ, the frequency the cable achieves is printed, along with\n"
+               "the requested one where the two differ.\n"),
              "frequency");
 }
 
@@ -70,7 +70,8 @@ cmd_peek_run (urj_chain_t *chain, char *params[])
 
         URJ_BUS_PREPARE (urj_bus);
         URJ_BUS_AREA (urj_bus, adr, &area);
-        val = URJ_BUS_READ (urj_bus, adr);
+        if (URJ_BUS_READ_BLOCK (urj_bus, adr, &val, 1) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
 
         switch (area.width)
         {
@@ -122,6 +123,7 @@ static int
 cmd_poke_run (urj_chain_t *chain, char *params[])
 {
     long unsigned adr, val;
+    uint32_t data;
     urj_bus_area_t area;
     /*urj_bus_t *bus = part_get_active_bus(chain); */
     int k = 1, pars = urj_cmd_params (params);
@@ -153,7 +155,9 @@ cmd_poke_run (urj_chain_t *chain, char *params[])
             || urj_cmd_get_number (params[k + 1], &val) != URJ_STATUS_OK)
             return URJ_STATUS_FAIL;
         URJ_BUS_AREA (urj_bus, adr, &area);
-        URJ_BUS_WRITE (urj_bus, adr, val);
+        data = val;
+        if (URJ_BUS_WRITE_BLOCK (urj_bus, adr, &data, 1) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
         k += 2;
     }
 
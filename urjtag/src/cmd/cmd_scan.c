@@ -64,7 +64,7 @@ cmd_scan_run (urj_chain_t *chain, char *params[])
         return URJ_STATUS_FAIL;
 
     /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (part, "BSR");
+    bsr = urj_part_find_bsr (part);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -101,8 +101,8 @@ cmd_scan_run (urj_chain_t *chain, char *params[])
     {
         if (s->input != NULL)
         {
-            int old = obsr->data[s->input->bit];
-            int new = bsr->out->data[s->input->bit];
+            int old = urj_tap_register_get_bit (obsr, s->input->bit);
+            int new = urj_tap_register_get_bit (bsr->out, s->input->bit);
             if (old != new)
             {
                 urj_part_salias_t *a;
@@ -0,0 +1,155 @@
+/*
+ * $Id$
+ *
+ * Compare memory content with a file
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <urjtag/error.h>
+#include <urjtag/bus.h>
+
+#include <urjtag/cmd.h>
+
+#include "cmd.h"
+
+static int
+cmd_verifymem_run (urj_chain_t *chain, char *params[])
+{
+    long unsigned adr;
+    long unsigned len = 0;
+    int paramc = urj_cmd_params (params);
+    int flags = 0;
+    int have_len = 0;
+    int i, r;
+    FILE *f;
+
+    if (paramc < 3 || paramc > 5)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       "%s: #parameters should be >= %d and <= %d, not %d",
+                       params[0], 3, 5, paramc);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (!urj_bus)
+    {
+        urj_error_set (URJ_ERROR_ILLEGAL_STATE, _("Bus missing"));
+        return URJ_STATUS_FAIL;
+    }
+
+    if (urj_cmd_get_number (params[1], &adr) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    for (i = 3; i < paramc; i++)
+    {
+        if (strcasecmp (params[i], "stop") == 0)
+            flags |= URJ_BUS_VERIFY_STOP;
+        else if (have_len)
+        {
+            urj_error_set (URJ_ERROR_SYNTAX, "%s: unknown parameter '%s'",
+                           params[0], params[i]);
+            return URJ_STATUS_FAIL;
+        }
+        else if (urj_cmd_get_number (params[i], &len) == URJ_STATUS_OK)
+            have_len = 1;
+        else
+            return URJ_STATUS_FAIL;
+    }
+
+    f = fopen (params[2], FOPEN_R);
+    if (!f)
+    {
+        urj_error_IO_set (_("Unable to open file `%s'"), params[2]);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (!have_len)
+    {
+        long size;
+
+        if (fseek (f, 0, SEEK_END) != 0 || (size = ftell (f)) < 0
+            || fseek (f, 0, SEEK_SET) != 0)
+        {
+            urj_error_IO_set (_("Unable to get the size of file `%s'"),
+                              params[2]);
+            fclose (f);
+            return URJ_STATUS_FAIL;
+        }
+        len = size;
+    }
+
+    r = urj_bus_verifymem (urj_bus, f, adr, len, flags);
+    fclose (f);
+
+    return r;
+}
+
+static void
+cmd_verifymem_help (void)
+{
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             _("Usage: %s ADDR FILENAME [LEN] [%s]\n"
+               "Compare device memory content starting with ADDR to FILENAME file.\n"
+               "\n"
+               "ADDR       start address of the compared memory area\n"
+               "FILENAME   name of the file, as written by readmem\n"
+               "LEN        compared memory length, the file length by default\n"
+               "%-10s stop at the first difference instead of listing them all\n"
+               "\n"
+               "ADDR and LEN could be in decimal or hexadecimal (prefixed with 0x) form.\n"),
+             "verifymem", "stop", "stop");
+}
+
+static void
+cmd_verifymem_complete (urj_chain_t *chain, char ***matches,
+                        size_t *match_cnt, char * const *tokens,
+                        const char *text, size_t text_len,
+                        size_t token_point)
+{
+    switch (token_point)
+    {
+    case 1: /* addr */
+        break;
+
+    case 2: /* filename */
+        urj_completion_mayben_add_file (matches, match_cnt, text,
+                                        text_len, false);
+        break;
+
+    case 3: /* len or stop */
+    case 4:
+        urj_completion_mayben_add_match (matches, match_cnt, text, text_len,
+                                         "stop");
+        break;
+    }
+}
+
+const urj_cmd_t urj_cmd_verifymem = {
+    "verifymem",
+    N_("compare content of the memory with a file"),
+    cmd_verifymem_help,
+    cmd_verifymem_run,
+    cmd_verifymem_complete,
+};
@@ -421,24 +421,23 @@ urj_flashmem (urj_bus_t *bus, FILE *f, uint32_t addr, int noverify)
         uint32_t data, readed;
         uint8_t b[BSIZE];
         int bc = 0, bn = 0, btr = BSIZE;
+        int n;
 
         // @@@@ RFHH check error state?
         bn = fread (b, 1, btr, f);
+        n = (bn + flash_driver->bus_width - 1) / flash_driver->bus_width;
 
-        /* start consecutive read */
-        URJ_BUS_READ_START (bus, adr);
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08lX"),
+                 (long unsigned) adr);
+        urj_log (URJ_LOG_LEVEL_NORMAL, "\r");
 
-        for (bc = 0; bc < bn; bc += flash_driver->bus_width)
+        /* read the whole block back, into the now unused write buffer */
+        if (URJ_BUS_READ_BLOCK (bus, adr, write_buffer, n) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        for (i = 0, bc = 0; i < n; i++, bc += flash_driver->bus_width)
         {
             int j;
-            uint32_t next_adr = adr + flash_driver->bus_width;
-
-            if ((adr & 0xFF) == 0)
-            {
-                urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08lX"),
-                         (long unsigned) adr);
-                urj_log (URJ_LOG_LEVEL_NORMAL, "\r");
-            }
 
             data = 0;
             for (j = 0; j < flash_driver->bus_width; j++)
@@ -447,25 +446,17 @@ urj_flashmem (urj_bus_t *bus, FILE *f, uint32_t addr, int noverify)
                 else
                     data |= b[bc + j] << (j * 8);
 
-            readed = URJ_BUS_READ_NEXT (bus, next_adr);
+            readed = write_buffer[i];
             if (data != readed)
             {
-                /* end consecutive read */
-                (void) URJ_BUS_READ_END (bus);
-
                 urj_error_set (URJ_ERROR_FLASH_PROGRAM,
                                _("addr: 0x%08lX\n verify error:\nread: 0x%08lX\nexpected: 0x%08lX\n"),
                                  (long unsigned) adr, (long unsigned) readed,
                                  (long unsigned) data);
                 return URJ_STATUS_FAIL;
             }
-            adr = next_adr;
+            adr += flash_driver->bus_width;
         }
-
-        /* end consecutive read
-           this wastes one read access but saves us from determining the for-loop
-           finish condition twice within the loop */
-        (void) URJ_BUS_READ_END (bus);
     }
     urj_log (URJ_LOG_LEVEL_NORMAL, _("addr: 0x%08lX\nDone.\n"),
              (long unsigned) adr - flash_driver->bus_width);
@@ -24,6 +24,7 @@
 #include <sysdep.h>
 
 #include <stdarg.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <stdbool.h>
@@ -32,7 +33,10 @@
 #include <urjtag/error.h>
 #include <urjtag/jtag.h>
 
-urj_error_state_t urj_error_state;
+URJ_THREAD_LOCAL urj_error_state_t urj_error_state;
+
+/* where the log output of this thread is held back, if anywhere */
+static URJ_THREAD_LOCAL urj_log_capture_t *log_capture;
 
 static int stderr_vprintf (const char *fmt, va_list ap);
 static int stdout_vprintf (const char *fmt, va_list ap);
@@ -73,18 +77,84 @@ log_printf (int (*p) (const char *, va_list), const char *fmt, ...)
     return r;
 }
 
+/* append n bytes to the held back output; URJ_STATUS_FAIL drops them */
+static int
+log_capture_append (urj_log_capture_t *cap, const char *s, size_t n)
+{
+    if (cap->len + n > cap->size)
+    {
+        size_t size = cap->size ? cap->size : 256;
+        char *buf;
+
+        while (cap->len + n > size)
+            size *= 2;
+        buf = realloc (cap->buf, size);
+        if (buf == NULL)
+            return URJ_STATUS_FAIL;
+        cap->buf = buf;
+        cap->size = size;
+    }
+
+    memcpy (cap->buf + cap->len, s, n);
+    cap->len += n;
+
+    return URJ_STATUS_OK;
+}
+
+static int
+log_capture_vprintf (const char *fmt, va_list ap)
+{
+    char text[256];
+    char *s = text;
+    va_list aq;
+    int r;
+
+    va_copy (aq, ap);
+    r = vsnprintf (text, sizeof text, fmt, aq);
+    va_end (aq);
+    if (r < 0)
+        return r;
+
+    if ((size_t) r >= sizeof text)
+    {
+        s = malloc (r + 1);
+        if (s == NULL)
+            return -1;
+        vsnprintf (s, r + 1, fmt, ap);
+    }
+
+    if (log_capture_append (log_capture, s, r) != URJ_STATUS_OK)
+        r = -1;
+
+    if (s != text)
+        free (s);
+
+    return r;
+}
+
 int
 urj_do_log (urj_log_level_t level, const char *file, size_t line,
             const char *func, const char *fmt, ...)
 {
     int (*p) (const char *fmt, va_list ap);
     va_list ap;
+    size_t start = 0;
     int r = 0;
 
     if (level < urj_log_state.level)
         return 0;
 
-    if (level < URJ_LOG_LEVEL_WARNING)
+    if (log_capture != NULL)
+    {
+        /* each message is held back as its level byte and its text */
+        char l = level;
+
+        p = log_capture_vprintf;
+        start = log_capture->len;
+        if (log_capture_append (log_capture, &l, 1) != URJ_STATUS_OK)
+            return -1;
+    }
+    else if (level < URJ_LOG_LEVEL_WARNING)
         p = urj_log_state.out_vprintf;
     else
         p = urj_log_state.err_vprintf;
@@ -100,9 +170,62 @@ urj_do_log (urj_log_level_t level, const char *file, size_t line,
     r += (*p) (fmt, ap);
     va_end (ap);
 
+    if (log_capture != NULL
+        && log_capture_append (log_capture, "", 1) != URJ_STATUS_OK)
+    {
+        /* drop the message rather than leave half of it */
+        log_capture->len = start;
+        return -1;
+    }
+
     return r;
 }
 
+void
+urj_log_capture (urj_log_capture_t *cap)
+{
+    log_capture = cap;
+}
+
+void
+urj_log_capture_move (urj_log_capture_t *to, urj_log_capture_t *from)
+{
+    if (to->len == 0)
+    {
+        free (to->buf);
+        *to = *from;
+    }
+    else
+    {
+        log_capture_append (to, from->buf, from->len);
+        free (from->buf);
+    }
+
+    from->buf = NULL;
+    from->len = from->size = 0;
+}
+
+void
+urj_log_capture_replay (urj_log_capture_t *cap)
+{
+    size_t pos = 0;
+
+    while (pos < cap->len)
+    {
+        urj_log_level_t level = (unsigned char) cap->buf[pos];
+        const char *text = cap->buf + pos + 1;
+
+        log_printf (level < URJ_LOG_LEVEL_WARNING
+                    ? urj_log_state.out_vprintf : urj_log_state.err_vprintf,
+                    "%s", text);
+        pos += strlen (text) + 2;
+    }
+
+    free (cap->buf);
+    cap->buf = NULL;
+    cap->len = cap->size = 0;
+}
+
 urj_error_t
 urj_error_get (void)
 {
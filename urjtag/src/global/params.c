@@ -221,7 +221,7 @@ parse_param_bool(const char *eq, int *enabled)
         return URJ_STATUS_OK;
     }
 
-    if (sscanf(eq, "%d", enabled) == 1 && (*enabled == 0 || *enabled == 1))
+    if (sscanf(eq + 1, "%d", enabled) == 1 && (*enabled == 0 || *enabled == 1))
         return URJ_STATUS_OK;
 
     urj_error_set (URJ_ERROR_SYNTAX, "need unsigned int, not '%s'", eq + 1);
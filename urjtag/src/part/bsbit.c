@@ -35,21 +35,12 @@
 #include <urjtag/bsbit.h>
 
 int
-urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
-                              int type, int safe,
-                              int ctrl_num, int ctrl_val, int ctrl_state)
+urj_part_bsbit_define (urj_part_t *part, urj_data_register_t *bsr,
+                       urj_part_signal_t *signal, int bit, const char *name,
+                       int type, int safe,
+                       int ctrl_num, int ctrl_val, int ctrl_state)
 {
     urj_bsbit_t *b;
-    urj_data_register_t *bsr;
-    urj_part_signal_t *signal;
-
-    bsr = urj_part_find_data_register (part, "BSR");
-    if (bsr == NULL)
-    {
-        urj_error_set(URJ_ERROR_NOTFOUND,
-                      _("missing Boundary Scan Register (BSR)"));
-        return URJ_STATUS_FAIL;
-    }
 
     if (bit >= bsr->in->len)
     {
@@ -67,9 +58,7 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
         return URJ_STATUS_FAIL;
     }
 
-    signal = urj_part_find_signal (part, name);
-
-    bsr->in->data[bit] = safe;
+    urj_tap_register_set_bit (bsr->in, bit, safe);
 
     b = malloc (sizeof *b);
     if (!b)
@@ -121,6 +110,26 @@ urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
     return URJ_STATUS_OK;
 }
 
+int
+urj_part_bsbit_alloc_control (urj_part_t *part, int bit, const char *name,
+                              int type, int safe,
+                              int ctrl_num, int ctrl_val, int ctrl_state)
+{
+    urj_data_register_t *bsr;
+
+    bsr = urj_part_find_bsr (part);
+    if (bsr == NULL)
+    {
+        urj_error_set(URJ_ERROR_NOTFOUND,
+                      _("missing Boundary Scan Register (BSR)"));
+        return URJ_STATUS_FAIL;
+    }
+
+    return urj_part_bsbit_define (part, bsr, urj_part_find_signal (part, name),
+                                  bit, name, type, safe,
+                                  ctrl_num, ctrl_val, ctrl_state);
+}
+
 int
 urj_part_bsbit_alloc (urj_part_t *part, int bit, const char *name, int type,
                       int safe)
@@ -0,0 +1,550 @@
+/*
+ * $Id$
+ *
+ * Binary snapshot of the definitions of a part
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <urjtag/error.h>
+#include <urjtag/part.h>
+#include <urjtag/bssignal.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/part_instruction.h>
+#include <urjtag/data_register.h>
+#include <urjtag/bsbit.h>
+
+/*
+ * File layout, all numbers in host byte order:
+ *   header
+ *   u32 instruction_length, u32 boundary_length
+ *   u32 n, n signals:         str name, str pin
+ *   u32 n, n saliases:        str name, u32 signal
+ *   u32 n, n data registers:  str name, u32 len, in bits, out bits
+ *   u32 n, n instructions:    str name, value bits, str data register
+ *   u32 n, n boundary bits:   u32 bit, str name, u32 signal, i32 type,
+ *                             i32 safe, i32 control, i32 control_value,
+ *                             i32 control_state
+ * Lists are stored in the order of the part, signal references as the
+ * position in the signal list (NONE for none), strings as u32 length and
+ * characters (NONE for a NULL string) and register bits as packed bytes.
+ */
+#define MODEL_MAGIC             "URJPM1"
+#define MODEL_BYTE_ORDER        0x01020304
+#define MODEL_NONE              UINT32_MAX
+
+typedef struct
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t reserved;
+    uint64_t key;
+} model_header_t;
+
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    int error;
+} model_reader_t;
+
+/* save */
+
+static void
+put_u32 (FILE *f, uint32_t v)
+{
+    fwrite (&v, sizeof v, 1, f);
+}
+
+static void
+put_str (FILE *f, const char *s)
+{
+    if (s == NULL)
+    {
+        put_u32 (f, MODEL_NONE);
+        return;
+    }
+    put_u32 (f, strlen (s));
+    fwrite (s, 1, strlen (s), f);
+}
+
+static void
+put_bits (FILE *f, const urj_tap_register_t *tr)
+{
+    fwrite (tr->packed, 1, URJ_TAP_REGISTER_BYTES (tr->len), f);
+}
+
+static uint32_t
+signal_index (const urj_part_t *part, const urj_part_signal_t *signal)
+{
+    const urj_part_signal_t *s;
+    uint32_t n;
+
+    for (s = part->signals, n = 0; s; s = s->next, n++)
+        if (s == signal)
+            return n;
+
+    return MODEL_NONE;
+}
+
+int
+urj_part_model_save (const urj_part_t *part, const char *filename,
+                     uint64_t key)
+{
+    model_header_t header;
+    const urj_part_signal_t *s;
+    const urj_part_salias_t *sa;
+    const urj_data_register_t *dr;
+    const urj_part_instruction_t *in;
+    char tmpname[1024 + sizeof ".new"];
+    uint32_t n;
+    FILE *f;
+    int i;
+
+    snprintf (tmpname, sizeof tmpname, "%s.new", filename);
+    f = fopen (tmpname, FOPEN_W);
+    if (f == NULL)
+    {
+        urj_error_IO_set ("Unable to create file '%s.new'", filename);
+        return URJ_STATUS_FAIL;
+    }
+
+    memset (&header, 0, sizeof header);
+    strcpy (header.magic, MODEL_MAGIC);
+    header.byte_order = MODEL_BYTE_ORDER;
+    header.key = key;
+    fwrite (&header, sizeof header, 1, f);
+
+    put_u32 (f, part->instruction_length);
+    put_u32 (f, part->boundary_length);
+
+    for (s = part->signals, n = 0; s; s = s->next)
+        n++;
+    put_u32 (f, n);
+    for (s = part->signals; s; s = s->next)
+    {
+        put_str (f, s->name);
+        put_str (f, s->pin);
+    }
+
+    for (sa = part->saliases, n = 0; sa; sa = sa->next)
+        n++;
+    put_u32 (f, n);
+    for (sa = part->saliases; sa; sa = sa->next)
+    {
+        put_str (f, sa->name);
+        put_u32 (f, signal_index (part, sa->signal));
+    }
+
+    for (dr = part->data_registers, n = 0; dr; dr = dr->next)
+        n++;
+    put_u32 (f, n);
+    for (dr = part->data_registers; dr; dr = dr->next)
+    {
+        put_str (f, dr->name);
+        put_u32 (f, dr->in->len);
+        put_bits (f, dr->in);
+        put_bits (f, dr->out);
+    }
+
+    for (in = part->instructions, n = 0; in; in = in->next)
+        n++;
+    put_u32 (f, n);
+    for (in = part->instructions; in; in = in->next)
+    {
+        put_str (f, in->name);
+        put_bits (f, in->value);
+        put_str (f, in->data_register ? in->data_register->name : NULL);
+    }
+
+    for (i = 0, n = 0; i < part->boundary_length; i++)
+        if (part->bsbits[i])
+            n++;
+    put_u32 (f, n);
+    for (i = 0; i < part->boundary_length; i++)
+    {
+        const urj_bsbit_t *b = part->bsbits[i];
+
+        if (b == NULL)
+            continue;
+        put_u32 (f, b->bit);
+        put_str (f, b->name);
+        put_u32 (f, signal_index (part, b->signal));
+        put_u32 (f, b->type);
+        put_u32 (f, b->safe);
+        put_u32 (f, b->control);
+        put_u32 (f, b->control_value);
+        put_u32 (f, b->control_state);
+    }
+
+    i = ferror (f);
+    if (fclose (f) != 0 || i)
+    {
+        remove (tmpname);
+        urj_error_IO_set ("Unable to write file '%s.new'", filename);
+        return URJ_STATUS_FAIL;
+    }
+
+    /* rename() does not replace an existing file on all hosts */
+    if (rename (tmpname, filename) != 0)
+    {
+        remove (filename);
+        if (rename (tmpname, filename) != 0)
+        {
+            remove (tmpname);
+            urj_error_IO_set ("Unable to rename '%s.new'", filename);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    return URJ_STATUS_OK;
+}
+
+/* load */
+
+static uint32_t
+get_u32 (model_reader_t *r)
+{
+    uint32_t v;
+
+    if (r->error || r->end - r->p < (ptrdiff_t) sizeof v)
+    {
+        r->error = 1;
+        return 0;
+    }
+    memcpy (&v, r->p, sizeof v);
+    r->p += sizeof v;
+
+    return v;
+}
+
+/* @return malloc()ed string; NULL for none or on error */
+static char *
+get_str (model_reader_t *r)
+{
+    uint32_t len = get_u32 (r);
+    char *s;
+
+    if (r->error || len == MODEL_NONE)
+        return NULL;
+    if (r->end - r->p < (ptrdiff_t) len)
+    {
+        r->error = 1;
+        return NULL;
+    }
+    s = malloc (len + 1);
+    if (s == NULL)
+    {
+        r->error = 1;
+        return NULL;
+    }
+    memcpy (s, r->p, len);
+    s[len] = '\0';
+    r->p += len;
+
+    return s;
+}
+
+static void
+get_bits (model_reader_t *r, urj_tap_register_t *tr)
+{
+    size_t n = URJ_TAP_REGISTER_BYTES (tr->len);
+
+    if (r->error || r->end - r->p < (ptrdiff_t) n)
+    {
+        r->error = 1;
+        return;
+    }
+    memcpy (tr->packed, r->p, n);
+    r->p += n;
+
+    /* keep the padding bits clear */
+    if (tr->len % 8)
+        tr->packed[n - 1] &= (1 << (tr->len % 8)) - 1;
+}
+
+static int
+model_read (model_reader_t *r, urj_part_t *part, uint64_t key)
+{
+    model_header_t header;
+    urj_part_signal_t **signals = NULL;
+    urj_part_signal_t **signal_tail = &part->signals;
+    urj_part_salias_t **salias_tail = &part->saliases;
+    urj_data_register_t **dr_tail = &part->data_registers;
+    urj_part_instruction_t **in_tail = &part->instructions;
+    uint32_t nsignals, n, i;
+
+    if (r->end - r->p < (ptrdiff_t) sizeof header)
+        return URJ_STATUS_FAIL;
+    memcpy (&header, r->p, sizeof header);
+    r->p += sizeof header;
+    if (memcmp (header.magic, MODEL_MAGIC, sizeof MODEL_MAGIC) != 0
+        || header.byte_order != MODEL_BYTE_ORDER || header.key != key)
+        return URJ_STATUS_FAIL;
+
+    part->instruction_length = get_u32 (r);
+    part->boundary_length = get_u32 (r);
+    if (r->error || part->boundary_length < 0
+        || part->boundary_length > r->end - r->p)
+        return URJ_STATUS_FAIL;
+    if (part->boundary_length > 0)
+    {
+        part->bsbits = calloc (part->boundary_length, sizeof *part->bsbits);
+        if (part->bsbits == NULL)
+            return URJ_STATUS_FAIL;
+    }
+
+    nsignals = get_u32 (r);
+    if (r->error || nsignals > (uint32_t) (r->end - r->p) / 8)
+        return URJ_STATUS_FAIL;
+    signals = calloc (nsignals + 1, sizeof *signals);
+    if (signals == NULL)
+        return URJ_STATUS_FAIL;
+    for (i = 0; i < nsignals && !r->error; i++)
+    {
+        urj_part_signal_t *s;
+        char *name = get_str (r);
+
+        s = name ? urj_part_signal_alloc (name) : NULL;
+        free (name);
+        if (s == NULL)
+        {
+            r->error = 1;
+            break;
+        }
+        *signal_tail = signals[i] = s;
+        signal_tail = &s->next;
+        s->pin = get_str (r);
+    }
+
+    n = get_u32 (r);
+    for (i = 0; i < n && !r->error; i++)
+    {
+        urj_part_salias_t *sa;
+        char *name = get_str (r);
+        uint32_t signal = get_u32 (r);
+
+        sa = name && signal < nsignals
+            ? urj_part_salias_alloc (name, signals[signal]) : NULL;
+        free (name);
+        if (sa == NULL)
+        {
+            r->error = 1;
+            break;
+        }
+        *salias_tail = sa;
+        salias_tail = &sa->next;
+    }
+
+    n = get_u32 (r);
+    for (i = 0; i < n && !r->error; i++)
+    {
+        urj_data_register_t *dr;
+        char *name = get_str (r);
+        uint32_t len = get_u32 (r);
+
+        dr = name && len <= (uint32_t) (r->end - r->p) * 8
+            ? urj_part_data_register_alloc (name, len) : NULL;
+        free (name);
+        if (dr == NULL)
+        {
+            r->error = 1;
+            break;
+        }
+        *dr_tail = dr;
+        dr_tail = &dr->next;
+        get_bits (r, dr->in);
+        get_bits (r, dr->out);
+
+        /* the model may come from a device of another stepping */
+        if (strcasecmp (dr->name, "DIR") == 0)
+            urj_tap_register_init (dr->out,
+                                   urj_tap_register_get_string (part->id));
+    }
+
+    n = get_u32 (r);
+    for (i = 0; i < n && !r->error; i++)
+    {
+        urj_part_instruction_t *in;
+        char *name = get_str (r);
+        char *dr_name;
+
+        in = name ? urj_part_instruction_alloc (name,
+                                                part->instruction_length, "")
+            : NULL;
+        free (name);
+        if (in == NULL)
+        {
+            r->error = 1;
+            break;
+        }
+        *in_tail = in;
+        in_tail = &in->next;
+        get_bits (r, in->value);
+        dr_name = get_str (r);
+        if (dr_name)
+        {
+            in->data_register = urj_part_find_data_register (part, dr_name);
+            if (in->data_register == NULL)
+                r->error = 1;
+            free (dr_name);
+        }
+    }
+
+    n = get_u32 (r);
+    for (i = 0; i < n && !r->error; i++)
+    {
+        urj_bsbit_t *b;
+        uint32_t bit = get_u32 (r);
+        char *name = get_str (r);
+        uint32_t signal = get_u32 (r);
+
+        if (name == NULL || bit >= (uint32_t) part->boundary_length
+            || part->bsbits[bit] != NULL
+            || (signal != MODEL_NONE && signal >= nsignals)
+            || (b = malloc (sizeof *b)) == NULL)
+        {
+            free (name);
+            r->error = 1;
+            break;
+        }
+        b->bit = bit;
+        b->name = name;
+        b->signal = signal == MODEL_NONE ? NULL : signals[signal];
+        b->type = get_u32 (r);
+        b->safe = get_u32 (r);
+        b->control = get_u32 (r);
+        b->control_value = get_u32 (r);
+        b->control_state = get_u32 (r);
+        part->bsbits[bit] = b;
+
+        if (b->signal != NULL)
+        {
+            switch (b->type)
+            {
+            case URJ_BSBIT_INPUT:
+                b->signal->input = b;
+                break;
+            case URJ_BSBIT_OUTPUT:
+                b->signal->output = b;
+                break;
+            case URJ_BSBIT_BIDIR:
+                b->signal->input = b;
+                b->signal->output = b;
+                break;
+            }
+        }
+    }
+
+    free (signals);
+
+    return r->error || r->p != r->end ? URJ_STATUS_FAIL : URJ_STATUS_OK;
+}
+
+int
+urj_part_model_load (urj_part_t *part, const char *filename, uint64_t key)
+{
+    urj_part_t *model;
+    model_reader_t r;
+    uint8_t *buf;
+    long size;
+    FILE *f;
+    int result;
+
+    if (part->signals || part->saliases || part->instructions
+        || part->data_registers || part->bsbits)
+    {
+        urj_error_set (URJ_ERROR_ALREADY, _("part is already defined"));
+        return URJ_STATUS_FAIL;
+    }
+
+    f = fopen (filename, FOPEN_R);
+    if (f == NULL)
+    {
+        urj_error_IO_set ("Unable to open file '%s'", filename);
+        return URJ_STATUS_FAIL;
+    }
+    if (fseek (f, 0, SEEK_END) != 0 || (size = ftell (f)) < 0
+        || fseek (f, 0, SEEK_SET) != 0)
+    {
+        fclose (f);
+        urj_error_IO_set ("Unable to read file '%s'", filename);
+        return URJ_STATUS_FAIL;
+    }
+    buf = malloc (size ? size : 1);
+    if (buf == NULL)
+    {
+        fclose (f);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       (size_t) size);
+        return URJ_STATUS_FAIL;
+    }
+    if (fread (buf, 1, size, f) != (size_t) size)
+    {
+        free (buf);
+        fclose (f);
+        urj_error_IO_set ("Unable to read file '%s'", filename);
+        return URJ_STATUS_FAIL;
+    }
+    fclose (f);
+
+    /* build the definitions in a scratch part, so a damaged or stale file
+       leaves the part untouched */
+    model = urj_part_alloc (part->id);
+    if (model == NULL)
+    {
+        free (buf);
+        return URJ_STATUS_FAIL;
+    }
+    r.p = buf;
+    r.end = buf + size;
+    r.error = 0;
+    result = model_read (&r, model, key);
+    free (buf);
+
+    if (result != URJ_STATUS_OK)
+    {
+        urj_part_free (model);
+        urj_error_set (URJ_ERROR_INVALID, _("'%s' is not a valid model"),
+                       filename);
+        return URJ_STATUS_FAIL;
+    }
+
+    part->instruction_length = model->instruction_length;
+    part->signals = model->signals;
+    part->saliases = model->saliases;
+    part->instructions = model->instructions;
+    part->data_registers = model->data_registers;
+    part->boundary_length = model->boundary_length;
+    part->bsbits = model->bsbits;
+    model->signals = NULL;
+    model->saliases = NULL;
+    model->instructions = NULL;
+    model->data_registers = NULL;
+    model->boundary_length = 0;
+    model->bsbits = NULL;
+    urj_part_free (model);
+
+    return URJ_STATUS_OK;
+}
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <urjtag/error.h>
 #include <urjtag/part.h>
@@ -37,6 +38,213 @@
 
 urj_part_init_t *urj_part_inits = NULL;
 
+/*
+ * Name lookup
+ *
+ * Each list of a part is indexed by a case insensitive hash table.  The
+ * lists only grow at their head, so a table is brought up to date on
+ * lookup by adding the elements in front of the head it has seen last.
+ * If that head is gone from the list, the table is built anew.
+ */
+
+enum
+{
+    INDEX_SIGNAL,
+    INDEX_SALIAS,
+    INDEX_INSTRUCTION,
+    INDEX_DATA_REGISTER,
+    INDEX_NUM
+};
+
+typedef struct
+{
+    const void **slot;          /* open addressing, size is a power of 2 */
+    size_t size;
+    size_t used;
+    const void *head;           /* list head the table is up to date with */
+}
+name_index_t;
+
+struct URJ_PART_INDEX
+{
+    name_index_t list[INDEX_NUM];
+    urj_data_register_t *bsr;   /* BSR found in the data registers at */
+    const void *bsr_head;       /*   this head */
+};
+
+static const void *
+index_head (const urj_part_t *p, int kind)
+{
+    switch (kind)
+    {
+    case INDEX_SIGNAL:
+        return p->signals;
+    case INDEX_SALIAS:
+        return p->saliases;
+    case INDEX_INSTRUCTION:
+        return p->instructions;
+    default:
+        return p->data_registers;
+    }
+}
+
+static const void *
+index_next (int kind, const void *e)
+{
+    switch (kind)
+    {
+    case INDEX_SIGNAL:
+        return ((const urj_part_signal_t *) e)->next;
+    case INDEX_SALIAS:
+        return ((const urj_part_salias_t *) e)->next;
+    case INDEX_INSTRUCTION:
+        return ((const urj_part_instruction_t *) e)->next;
+    default:
+        return ((const urj_data_register_t *) e)->next;
+    }
+}
+
+static const char *
+index_name (int kind, const void *e)
+{
+    switch (kind)
+    {
+    case INDEX_SIGNAL:
+        return ((const urj_part_signal_t *) e)->name;
+    case INDEX_SALIAS:
+        return ((const urj_part_salias_t *) e)->name;
+    case INDEX_INSTRUCTION:
+        return ((const urj_part_instruction_t *) e)->name;
+    default:
+        return ((const urj_data_register_t *) e)->name;
+    }
+}
+
+static const void **
+index_slot (name_index_t *ix, int kind, const char *name)
+{
+    size_t mask = ix->size - 1;
+    size_t h = 5381;
+    const char *c;
+
+    for (c = name; *c; c++)
+        h = h * 33 + tolower ((unsigned char) *c);
+
+    for (h &= mask; ix->slot[h]; h = (h + 1) & mask)
+        if (strcasecmp (index_name (kind, ix->slot[h]), name) == 0)
+            break;
+
+    return &ix->slot[h];
+}
+
+static int
+index_resize (name_index_t *ix, int kind, size_t size)
+{
+    const void **old = ix->slot;
+    size_t old_size = ix->size;
+    size_t i;
+
+    ix->slot = calloc (size, sizeof *ix->slot);
+    if (ix->slot == NULL)
+    {
+        ix->slot = old;
+        return URJ_STATUS_FAIL;
+    }
+    ix->size = size;
+
+    for (i = 0; i < old_size; i++)
+        if (old[i])
+            *index_slot (ix, kind, index_name (kind, old[i])) = old[i];
+    free (old);
+
+    return URJ_STATUS_OK;
+}
+
+static int
+index_update (urj_part_t *p, int kind)
+{
+    name_index_t *ix;
+    const void *head = index_head (p, kind);
+    const void *e;
+    size_t n, size;
+
+    if (p->index == NULL)
+    {
+        p->index = calloc (1, sizeof *p->index);
+        if (p->index == NULL)
+            return URJ_STATUS_FAIL;
+    }
+    ix = &p->index->list[kind];
+
+    if (ix->slot != NULL && head == ix->head)
+        return URJ_STATUS_OK;
+
+    for (n = 0, e = head; e && e != ix->head; e = index_next (kind, e))
+        n++;
+    if (e == NULL && ix->used)
+    {
+        /* the list was replaced */
+        memset (ix->slot, 0, ix->size * sizeof *ix->slot);
+        ix->used = 0;
+    }
+
+    for (size = ix->size ? ix->size : 16; size < 2 * (ix->used + n);)
+        size *= 2;
+    if (size != ix->size && index_resize (ix, kind, size) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    for (e = head; n > 0; e = index_next (kind, e), n--)
+    {
+        const void **slot = index_slot (ix, kind, index_name (kind, e));
+
+        if (*slot == NULL)
+            ix->used++;
+        else
+        {
+            const void *f;
+
+            /* of equal names, the one nearest to the head is found */
+            for (f = head; f != e && f != *slot; f = index_next (kind, f))
+                ;
+            if (f != e)
+                continue;
+        }
+        *slot = e;
+    }
+    ix->head = head;
+
+    return URJ_STATUS_OK;
+}
+
+/* @return URJ_STATUS_OK with the element or NULL in *found; URJ_STATUS_FAIL
+ * if the index cannot be used */
+static int
+index_find (urj_part_t *p, int kind, const char *name, const void **found)
+{
+    name_index_t *ix;
+
+    if (index_update (p, kind) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    ix = &p->index->list[kind];
+    *found = *index_slot (ix, kind, name);
+
+    return URJ_STATUS_OK;
+}
+
+static void
+index_free (urj_part_index_t *index)
+{
+    int kind;
+
+    if (index == NULL)
+        return;
+
+    for (kind = 0; kind < INDEX_NUM; kind++)
+        free (index->list[kind].slot);
+    free (index);
+}
+
 /* part */
 
 urj_part_t *
@@ -64,6 +272,7 @@ urj_part_alloc (const urj_tap_register_t *id)
     p->boundary_length = 0;
     p->bsbits = NULL;
     p->params = NULL;
+    p->index = NULL;
 
     return p;
 }
@@ -123,6 +332,8 @@ urj_part_free (urj_part_t *p)
         p->params->free (p->params->data);
     free (p->params);
 
+    index_free (p->index);
+
     free (p);
 }
 
@@ -130,6 +341,7 @@ urj_part_instruction_t *
 urj_part_find_instruction (urj_part_t *p, const char *iname)
 {
     urj_part_instruction_t *i;
+    const void *e;
 
     if (!p || !iname)
     {
@@ -137,6 +349,9 @@ urj_part_find_instruction (urj_part_t *p, const char *iname)
         return NULL;
     }
 
+    if (index_find (p, INDEX_INSTRUCTION, iname, &e) == URJ_STATUS_OK)
+        return (urj_part_instruction_t *) e;
+
     i = p->instructions;
     while (i)
     {
@@ -152,6 +367,7 @@ urj_data_register_t *
 urj_part_find_data_register (urj_part_t *p, const char *drname)
 {
     urj_data_register_t *dr;
+    const void *e;
 
     if (!p || !drname)
     {
@@ -159,6 +375,9 @@ urj_part_find_data_register (urj_part_t *p, const char *drname)
         return NULL;
     }
 
+    if (index_find (p, INDEX_DATA_REGISTER, drname, &e) == URJ_STATUS_OK)
+        return (urj_data_register_t *) e;
+
     dr = p->data_registers;
     while (dr)
     {
@@ -175,6 +394,7 @@ urj_part_find_signal (urj_part_t *p, const char *signalname)
 {
     urj_part_signal_t *s;
     urj_part_salias_t *sa;
+    const void *e;
 
     if (!p || !signalname)
     {
@@ -182,6 +402,14 @@ urj_part_find_signal (urj_part_t *p, const char *signalname)
         return NULL;
     }
 
+    if (index_find (p, INDEX_SIGNAL, signalname, &e) == URJ_STATUS_OK)
+    {
+        if (e)
+            return (urj_part_signal_t *) e;
+        if (index_find (p, INDEX_SALIAS, signalname, &e) == URJ_STATUS_OK)
+            return e ? ((const urj_part_salias_t *) e)->signal : NULL;
+    }
+
     s = p->signals;
     while (s)
     {
@@ -201,6 +429,30 @@ urj_part_find_signal (urj_part_t *p, const char *signalname)
     return NULL;
 }
 
+urj_data_register_t *
+urj_part_find_bsr (urj_part_t *p)
+{
+    urj_data_register_t *bsr;
+
+    if (!p)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part");
+        return NULL;
+    }
+
+    if (p->index && p->index->bsr && p->index->bsr_head == p->data_registers)
+        return p->index->bsr;
+
+    bsr = urj_part_find_data_register (p, "BSR");
+    if (bsr && p->index)
+    {
+        p->index->bsr = bsr;
+        p->index->bsr_head = p->data_registers;
+    }
+
+    return bsr;
+}
+
 void
 urj_part_set_instruction (urj_part_t *p, const char *iname)
 {
@@ -219,8 +471,7 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
         return URJ_STATUS_FAIL;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = urj_part_find_bsr (p);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -238,12 +489,12 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
                            _("signal '%s' cannot be set as output"), s->name);
             return URJ_STATUS_FAIL;
         }
-        bsr->in->data[s->output->bit] = val & 1;
+        urj_tap_register_set_bit (bsr->in, s->output->bit, val & 1);
 
         control = p->bsbits[s->output->bit]->control;
         if (control >= 0)
-            bsr->in->data[control] =
-                p->bsbits[s->output->bit]->control_value ^ 1;
+            urj_tap_register_set_bit (bsr->in, control,
+                              p->bsbits[s->output->bit]->control_value ^ 1);
     }
     else
     {
@@ -254,10 +505,42 @@ urj_part_set_signal (urj_part_t *p, urj_part_signal_t *s, int out, int val)
             return URJ_STATUS_FAIL;
         }
         if (s->output)
-            bsr->in->data[s->output->control] =
-                p->bsbits[s->output->bit]->control_value;
+            urj_tap_register_set_bit (bsr->in, s->output->control,
+                                p->bsbits[s->output->bit]->control_value);
+    }
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_signal_resolve (urj_part_t *p, const urj_part_signal_t *s,
+                         urj_part_signal_handle_t *h)
+{
+    if (!p || !s || !h)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, signal or handle");
+        return URJ_STATUS_FAIL;
     }
 
+    h->bsr = urj_part_find_bsr (p);
+    if (!h->bsr)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return URJ_STATUS_FAIL;
+    }
+
+    h->output = -1;
+    h->control = -1;
+    h->control_value = 0;
+    if (s->output)
+    {
+        h->output = s->output->bit;
+        h->control = p->bsbits[h->output]->control;
+        h->control_value = p->bsbits[h->output]->control_value;
+    }
+    h->input = s->input ? s->input->bit : -1;
+
     return URJ_STATUS_OK;
 }
 
@@ -272,8 +555,7 @@ urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s)
         return -1;
     }
 
-    /* search for Boundary Scan Register */
-    bsr = urj_part_find_data_register (p, "BSR");
+    bsr = urj_part_find_bsr (p);
     if (!bsr)
     {
         urj_error_set (URJ_ERROR_NOTFOUND,
@@ -288,7 +570,7 @@ urj_part_get_signal (urj_part_t *p, const urj_part_signal_t *s)
         return -1;
     }
 
-    return bsr->out->data[s->input->bit];
+    return urj_tap_register_get_bit (bsr->out, s->input->bit);
 }
 
 int
@@ -0,0 +1,454 @@
+/*
+ * $Id$
+ *
+ * Buses of signals set and sampled as one value, and bus cycle templates
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <urjtag/error.h>
+#include <urjtag/part.h>
+#include <urjtag/bssignal.h>
+#include <urjtag/data_register.h>
+#include <urjtag/tap_register.h>
+
+/* compile the cells of width vector bits into runs of consecutive cells,
+ * bits without a cell (-1) are left out */
+static int
+vector_runs (const int *cell, int width, urj_part_signal_run_t *run)
+{
+    int i = 0, n = 0;
+
+    while (i < width)
+    {
+        int len = 1, step = 0;
+
+        if (cell[i] < 0)
+        {
+            i++;
+            continue;
+        }
+        if (i + 1 < width && cell[i + 1] >= 0
+            && (cell[i + 1] == cell[i] + 1 || cell[i + 1] == cell[i] - 1))
+            step = cell[i + 1] - cell[i];
+        while (step && i + len < width && cell[i + len] >= 0
+               && cell[i + len] == cell[i] + len * step)
+            len++;
+
+        run[n].first = i;
+        run[n].len = len;
+        run[n].reverse = step < 0;
+        run[n].cell = step < 0 ? cell[i] - len + 1 : cell[i];
+        n++;
+        i += len;
+    }
+
+    return n;
+}
+
+int
+urj_part_signal_vector_init (urj_part_t *p, urj_part_signal_vector_t *vec,
+                             urj_part_signal_t *const *signals, int width)
+{
+    int out[URJ_PART_VECTOR_MAX], in[URJ_PART_VECTOR_MAX];
+    int i, j;
+
+    if (!p || !vec || !signals)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL part, vector or signals");
+        return URJ_STATUS_FAIL;
+    }
+    if (width < 0 || width > URJ_PART_VECTOR_MAX)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                       _("vector of %d signals, at most %d allowed"),
+                       width, URJ_PART_VECTOR_MAX);
+        return URJ_STATUS_FAIL;
+    }
+
+    memset (vec, 0, sizeof *vec);
+    for (i = 0; i < width; i++)
+    {
+        urj_part_signal_handle_t h;
+
+        if (!signals[i])
+        {
+            urj_error_set (URJ_ERROR_INVALID, _("vector bit %d has no signal"),
+                           i);
+            return URJ_STATUS_FAIL;
+        }
+        if (urj_part_signal_resolve (p, signals[i], &h) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        out[i] = h.output;
+        in[i] = h.input;
+        if (h.control < 0)
+            continue;
+
+        /* a control cell shared by several signals is set once */
+        for (j = 0; j < vec->ctrls; j++)
+            if (vec->ctrl[j].byte == h.control >> 3
+                && vec->ctrl[j].mask == 1 << (h.control & 7))
+                break;
+        if (j == vec->ctrls)
+        {
+            uint8_t mask = 1 << (h.control & 7);
+
+            vec->ctrl[j].first = i;
+            vec->ctrl[j].byte = h.control >> 3;
+            vec->ctrl[j].mask = mask;
+            vec->ctrl[j].on = h.control_value ? 0 : mask;
+            vec->ctrl[j].off = h.control_value ? mask : 0;
+            vec->ctrls++;
+        }
+    }
+    vec->out_runs = vector_runs (out, width, vec->out_run);
+    vec->in_runs = vector_runs (in, width, vec->in_run);
+    vec->width = width;
+
+    return URJ_STATUS_OK;
+}
+
+/* split name into the text before and after its last number, *pad is the
+ * number of digits if the number has leading zeros ("BSC007") */
+static int
+vector_name_split (const char *name, size_t *pre_len, long *index, int *pad,
+                   const char **suffix)
+{
+    const char *end = name + strlen (name);
+    const char *digits;
+
+    while (end > name && !isdigit ((unsigned char) end[-1]))
+        end--;
+    digits = end;
+    while (digits > name && isdigit ((unsigned char) digits[-1]))
+        digits--;
+    if (digits == end)
+        return URJ_STATUS_FAIL;
+
+    *pre_len = digits - name;
+    *index = strtol (digits, NULL, 10);
+    *pad = (digits[0] == '0' && end - digits > 1) ? end - digits : 0;
+    *suffix = end;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_signal_vector_define (urj_part_t *p, urj_part_signal_vector_t *vec,
+                               const char *lsb, const char *msb)
+{
+    urj_part_signal_t *signals[URJ_PART_VECTOR_MAX];
+    const char *lsb_suffix, *msb_suffix;
+    size_t pre_len, msb_pre_len;
+    long first, last;
+    int pad, msb_pad, width, step, i;
+
+    if (!lsb || !msb)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL signal name");
+        return URJ_STATUS_FAIL;
+    }
+
+    if (vector_name_split (lsb, &pre_len, &first, &pad,
+                           &lsb_suffix) != URJ_STATUS_OK
+        || vector_name_split (msb, &msb_pre_len, &last, &msb_pad,
+                              &msb_suffix) != URJ_STATUS_OK
+        || pre_len != msb_pre_len || strncmp (lsb, msb, pre_len) != 0
+        || strcmp (lsb_suffix, msb_suffix) != 0)
+    {
+        urj_error_set (URJ_ERROR_SYNTAX,
+                       _("signals '%s' and '%s' do not form a vector"),
+                       lsb, msb);
+        return URJ_STATUS_FAIL;
+    }
+
+    if (msb_pad > pad)
+        pad = msb_pad;
+    step = last >= first ? 1 : -1;
+    width = (last - first) * step + 1;
+    if (width > URJ_PART_VECTOR_MAX)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                       _("vector of %d signals, at most %d allowed"),
+                       width, URJ_PART_VECTOR_MAX);
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < width; i++)
+    {
+        char name[64];
+
+        snprintf (name, sizeof name, "%.*s%0*ld%s", (int) pre_len, lsb,
+                  pad, first + i * step, lsb_suffix);
+        signals[i] = urj_part_find_signal (p, name);
+        if (!signals[i])
+        {
+            urj_error_set (URJ_ERROR_NOTFOUND, _("signal '%s' not found"),
+                           name);
+            return URJ_STATUS_FAIL;
+        }
+    }
+
+    return urj_part_signal_vector_init (p, vec, signals, width);
+}
+
+static uint8_t *
+vector_bsr (urj_part_t *p, int in)
+{
+    urj_data_register_t *bsr = urj_part_find_bsr (p);
+
+    if (!bsr)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND,
+                       _("Boundary Scan Register (BSR) not found"));
+        return NULL;
+    }
+
+    return in ? bsr->in->packed : bsr->out->packed;
+}
+
+static uint32_t
+low_bits (int len)
+{
+    return len < 32 ? (UINT32_C (1) << len) - 1 : ~UINT32_C (0);
+}
+
+static uint32_t
+reverse_bits (uint32_t v, int len)
+{
+    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+    v = ((v >> 4) & 0x0f0f0f0f) | ((v & 0x0f0f0f0f) << 4);
+    v = ((v >> 8) & 0x00ff00ff) | ((v & 0x00ff00ff) << 8);
+    v = (v >> 16) | (v << 16);
+
+    return v >> (32 - len);
+}
+
+/* the first n bits of a run as bits of the packed BSR, lowest cell first */
+static int
+run_clip (const urj_part_signal_run_t *r, int n, int *cell)
+{
+    int len = n - r->first;
+
+    if (len > r->len)
+        len = r->len;
+    *cell = r->reverse ? r->cell + r->len - len : r->cell;
+
+    return len;
+}
+
+static void
+put_bits (uint8_t *reg, int cell, int len, uint32_t v)
+{
+    uint8_t *b = reg + (cell >> 3);
+    uint64_t bits = (uint64_t) v << (cell & 7);
+    uint64_t mask = (uint64_t) low_bits (len) << (cell & 7);
+
+    for (; mask; mask >>= 8, bits >>= 8, b++)
+        *b = (*b & ~(uint8_t) mask) | ((uint8_t) bits & (uint8_t) mask);
+}
+
+static uint32_t
+get_bits (const uint8_t *reg, int cell, int len)
+{
+    const uint8_t *b = reg + (cell >> 3);
+    int k = ((cell & 7) + len + 7) >> 3;
+    uint64_t bits = 0;
+
+    while (k--)
+        bits = (bits << 8) | b[k];
+
+    return (uint32_t) (bits >> (cell & 7)) & low_bits (len);
+}
+
+int
+urj_part_set_vector_n (urj_part_t *p, const urj_part_signal_vector_t *vec,
+                       int n, uint32_t value)
+{
+    uint8_t *in = vector_bsr (p, 1);
+    int i;
+
+    if (!in)
+        return URJ_STATUS_FAIL;
+    if (n > vec->width)
+        n = vec->width;
+
+    for (i = 0; i < vec->out_runs && vec->out_run[i].first < n; i++)
+    {
+        const urj_part_signal_run_t *r = &vec->out_run[i];
+        int cell, len = run_clip (r, n, &cell);
+        uint32_t v = (value >> r->first) & low_bits (len);
+
+        put_bits (in, cell, len, r->reverse ? reverse_bits (v, len) : v);
+    }
+    for (i = 0; i < vec->ctrls && vec->ctrl[i].first < n; i++)
+        in[vec->ctrl[i].byte] = (in[vec->ctrl[i].byte] & ~vec->ctrl[i].mask)
+            | vec->ctrl[i].on;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_set_vector_input_n (urj_part_t *p,
+                             const urj_part_signal_vector_t *vec, int n)
+{
+    uint8_t *in = vector_bsr (p, 1);
+    int i;
+
+    if (!in)
+        return URJ_STATUS_FAIL;
+
+    for (i = 0; i < vec->ctrls && vec->ctrl[i].first < n; i++)
+        in[vec->ctrl[i].byte] = (in[vec->ctrl[i].byte] & ~vec->ctrl[i].mask)
+            | vec->ctrl[i].off;
+
+    return URJ_STATUS_OK;
+}
+
+uint32_t
+urj_part_get_vector_n (urj_part_t *p, const urj_part_signal_vector_t *vec,
+                       int n)
+{
+    const uint8_t *out = vector_bsr (p, 0);
+    uint32_t value = 0;
+    int i;
+
+    if (!out)
+        return 0;
+    if (n > vec->width)
+        n = vec->width;
+
+    for (i = 0; i < vec->in_runs && vec->in_run[i].first < n; i++)
+    {
+        const urj_part_signal_run_t *r = &vec->in_run[i];
+        int cell, len = run_clip (r, n, &cell);
+        uint32_t v = get_bits (out, cell, len);
+
+        value |= (r->reverse ? reverse_bits (v, len) : v) << r->first;
+    }
+
+    return value;
+}
+
+void
+urj_part_signal_template_init (urj_part_signal_template_t *t)
+{
+    t->len = 0;
+}
+
+/* record mask bits of BSR byte byte at value */
+static int
+template_patch (urj_part_signal_template_t *t, int byte, uint8_t mask,
+                uint8_t value)
+{
+    int i;
+
+    for (i = 0; i < t->len; i++)
+        if (t->patch[i].byte == byte)
+            break;
+    if (i == t->len)
+    {
+        if (t->len == URJ_PART_TEMPLATE_MAX)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_BOUNDS,
+                           _("template of more than %d BSR bytes"),
+                           URJ_PART_TEMPLATE_MAX);
+            return URJ_STATUS_FAIL;
+        }
+        t->patch[i].byte = byte;
+        t->patch[i].mask = 0;
+        t->patch[i].value = 0;
+        t->len++;
+    }
+    t->patch[i].mask |= mask;
+    t->patch[i].value = (t->patch[i].value & ~mask) | (value & mask);
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_signal_template_add (urj_part_t *p, urj_part_signal_template_t *t,
+                              urj_part_signal_t *s, int out, int val)
+{
+    urj_part_signal_handle_t h;
+
+    if (!t)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL template");
+        return URJ_STATUS_FAIL;
+    }
+    if (urj_part_signal_resolve (p, s, &h) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* same cells as urj_part_set_resolved() */
+    if (out && h.output >= 0
+        && template_patch (t, h.output >> 3, 1 << (h.output & 7),
+                           val ? 0xff : 0) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+    if (h.control >= 0
+        && template_patch (t, h.control >> 3, 1 << (h.control & 7),
+                           (out ? h.control_value ^ 1 : h.control_value)
+                           ? 0xff : 0) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_signal_template_add_input (urj_part_signal_template_t *t,
+                                    const urj_part_signal_vector_t *vec)
+{
+    int i;
+
+    if (!t || !vec)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "NULL template or vector");
+        return URJ_STATUS_FAIL;
+    }
+
+    for (i = 0; i < vec->ctrls; i++)
+        if (template_patch (t, vec->ctrl[i].byte, vec->ctrl[i].mask,
+                            vec->ctrl[i].off) != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_part_set_template (urj_part_t *p, const urj_part_signal_template_t *t)
+{
+    uint8_t *in = vector_bsr (p, 1);
+    int i;
+
+    if (!in)
+        return URJ_STATUS_FAIL;
+
+    for (i = 0; i < t->len; i++)
+        in[t->patch[i].byte] = (in[t->patch[i].byte] & ~t->patch[i].mask)
+            | t->patch[i].value;
+
+    return URJ_STATUS_OK;
+}
@@ -570,7 +570,7 @@ xlx_configure (urj_pld_t *pld, FILE *bit_file)
     xlx_bitstream_t *bs;
     uint32_t u;
     int dr_len;
-    char *dr_data;
+    uint8_t *dr_data;
     int status = URJ_STATUS_OK;
 
     /* set all devices in bypass mode */
@@ -608,18 +608,16 @@ xlx_configure (urj_pld_t *pld, FILE *bit_file)
     i = urj_part_find_instruction (part, "CFG_IN");
 
     /* copy data into shift register */
-    dr_data = i->data_register->in->data;
+    dr_data = i->data_register->in->packed;
     for (u = 0; u < bs->length; u++)
     {
+        uint8_t b = bs->data[u];
+
         /* flip bits */
-        dr_data[8*u+0] = (bs->data[u] & 0x80) ? 1 : 0;
-        dr_data[8*u+1] = (bs->data[u] & 0x40) ? 1 : 0;
-        dr_data[8*u+2] = (bs->data[u] & 0x20) ? 1 : 0;
-        dr_data[8*u+3] = (bs->data[u] & 0x10) ? 1 : 0;
-        dr_data[8*u+4] = (bs->data[u] & 0x08) ? 1 : 0;
-        dr_data[8*u+5] = (bs->data[u] & 0x04) ? 1 : 0;
-        dr_data[8*u+6] = (bs->data[u] & 0x02) ? 1 : 0;
-        dr_data[8*u+7] = (bs->data[u] & 0x01) ? 1 : 0;
+        b = ((b & 0xf0) >> 4) | ((b & 0x0f) << 4);
+        b = ((b & 0xcc) >> 2) | ((b & 0x33) << 2);
+        b = ((b & 0xaa) >> 1) | ((b & 0x55) << 1);
+        dr_data[u] = b;
     }
 
     if (xlx_set_ir_and_shift (chain, part, "JPROGRAM") != URJ_STATUS_OK)
@@ -49,6 +49,7 @@ typedef enum
 } JAME_JTAG_STATE;
 
 extern int urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo);
+extern int urj_jam_jtag_io_goto (JAME_JTAG_STATE state);
 extern void urj_jam_flush_and_delay (int32_t microseconds);
 
 /****************************************************************************/
@@ -29,8 +29,10 @@
 
 #include "jamexprt.h"
 #include "jamutil.h"
+#include "jamjtag.h"
 #include <urjtag/chain.h>
 #include <urjtag/cable.h>
+#include <urjtag/tap_state.h>
 
 /***********************************************************************
 *   Global variables
@@ -48,6 +50,7 @@ int urj_jam_getc (void);
 int urj_jam_seek (int32_t offset);
 int urj_jam_jtag_io (int tms, int tdi, int read_tdo);
 int urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo);
+int urj_jam_jtag_io_goto (JAME_JTAG_STATE state);
 void urj_jam_message (const char *message_text);
 void urj_jam_export_integer (const char *key, int32_t value);
 void urj_jam_export_boolean_array (char *key, unsigned char *data, int32_t count);
@@ -100,6 +103,28 @@ urj_jam_jtag_io (int tms, int tdi, int read_tdo)
     return tdo;
 }
 
+// State walk as one TMS sequence via UrJTAG
+int
+urj_jam_jtag_io_goto (JAME_JTAG_STATE state)
+{
+    static const int tap_state[] = {
+        URJ_TAP_STATE_TEST_LOGIC_RESET, URJ_TAP_STATE_RUN_TEST_IDLE,
+        URJ_TAP_STATE_SELECT_DR_SCAN, URJ_TAP_STATE_CAPTURE_DR,
+        URJ_TAP_STATE_SHIFT_DR, URJ_TAP_STATE_EXIT1_DR,
+        URJ_TAP_STATE_PAUSE_DR, URJ_TAP_STATE_EXIT2_DR,
+        URJ_TAP_STATE_UPDATE_DR, URJ_TAP_STATE_SELECT_IR_SCAN,
+        URJ_TAP_STATE_CAPTURE_IR, URJ_TAP_STATE_SHIFT_IR,
+        URJ_TAP_STATE_EXIT1_IR, URJ_TAP_STATE_PAUSE_IR,
+        URJ_TAP_STATE_EXIT2_IR, URJ_TAP_STATE_UPDATE_IR
+    };
+
+    if (state < RESET || state > IRUPDATE)
+        return 0;
+
+    return urj_tap_goto_state (current_chain, tap_state[state])
+        == URJ_STATUS_OK;
+}
+
 // Vector-based JTAG communication via UrJTAG
 int
 urj_jam_jtag_io_transfer (int count, char *tdi, char *tdo)
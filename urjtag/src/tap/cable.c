@@ -42,8 +42,11 @@
 #include <urjtag/chain.h>
 #include <urjtag/tap.h>
 #include <urjtag/cable.h>
+#include <urjtag/tap_register.h>
 
 #include "cable.h"
+#include "cable/generic.h"
+#include "cable/pace.h"
 
 const urj_cable_driver_t * const urj_tap_cable_drivers[] = {
 #define _URJ_CABLE(cable) &urj_tap_cable_##cable##_driver,
@@ -69,36 +72,213 @@ urj_tap_cable_free (urj_cable_t *cable)
     cable->driver->cable_free (cable);
 }
 
+/* queue capacities; see URJ_CABLE_PARAM_KEY_QUEUE */
+#define CABLE_QUEUE_DEFAULT_SIZE 128
+#define CABLE_QUEUE_MAX_SIZE    (1 << 20)
+
+/* TMS bits per URJ_TAP_CABLE_CLOCK_COMPACT item */
+#define CABLE_TMS_BITS          7
+
+/* first block of the payload arena; grows to the demand of a flush round */
+#define CABLE_ARENA_MIN_SIZE    4096
+/* payloads start on a word boundary */
+#define CABLE_ARENA_ALIGN(n)    (((n) + sizeof (unsigned long) - 1) \
+                                 & ~(sizeof (unsigned long) - 1))
+
+typedef struct arena_block arena_block_t;
+
+struct arena_block
+{
+    arena_block_t *next;
+    uint8_t *base;
+    size_t size;
+};
+
+static int
+arena_in_block (const uint8_t *p, const uint8_t *base, size_t size)
+{
+    return base != NULL && p >= base && p < base + size;
+}
+
+static int
+arena_owns (const urj_cable_arena_t *a, const uint8_t *p)
+{
+    const arena_block_t *b;
+
+    if (arena_in_block (p, a->base, a->size))
+        return 1;
+    for (b = a->retired; b; b = b->next)
+        if (arena_in_block (p, b->base, b->size))
+            return 1;
+    return 0;
+}
+
+static void
+arena_free_retired (urj_cable_arena_t *a)
+{
+    arena_block_t *b, *next;
+
+    for (b = a->retired; b; b = next)
+    {
+        next = b->next;
+        free (b->base);
+        free (b);
+    }
+    a->retired = NULL;
+}
+
+/* no payload is live anymore: start over at the beginning, sized so that
+ * the last round would have fit in one block */
+static void
+arena_rewind (urj_cable_arena_t *a)
+{
+    if (a->retired != NULL)
+    {
+        uint8_t *base;
+
+        arena_free_retired (a);
+        base = realloc (a->base, a->demand);
+        if (base != NULL)
+        {
+            a->base = base;
+            a->size = a->demand;
+        }
+    }
+    a->used = 0;
+    a->demand = 0;
+}
+
+static uint8_t *
+arena_alloc (urj_cable_arena_t *a, size_t n)
+{
+    uint8_t *p;
+
+    /* hand out at least one byte so every payload has a distinct address */
+    n = CABLE_ARENA_ALIGN (n ? n : 1);
+
+    if (a->used + n > a->size)
+    {
+        size_t size = a->size ? 2 * a->size : CABLE_ARENA_MIN_SIZE;
+        uint8_t *base;
+
+        while (size < n)
+            size *= 2;
+
+        if (a->live == 0)
+        {
+            /* nothing refers into the current block, just replace it */
+            base = realloc (a->base, size);
+            if (base == NULL)
+            {
+                urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%s,%zd) fails",
+                               "a->base", size);
+                return NULL;
+            }
+        }
+        else
+        {
+            arena_block_t *b = malloc (sizeof (arena_block_t));
+
+            base = malloc (size);
+            if (b == NULL || base == NULL)
+            {
+                free (b);
+                free (base);
+                urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                               size);
+                return NULL;
+            }
+            b->base = a->base;
+            b->size = a->size;
+            b->next = a->retired;
+            a->retired = b;
+        }
+
+        a->base = base;
+        a->size = size;
+        a->used = 0;
+    }
+
+    p = a->base + a->used;
+    a->used += n;
+    a->demand += n;
+    a->live++;
+
+    return p;
+}
+
+static void
+arena_done (urj_cable_arena_t *a)
+{
+    arena_free_retired (a);
+    free (a->base);
+    a->base = NULL;
+    a->size = a->used = a->demand = 0;
+    a->live = 0;
+}
+
+void
+urj_tap_cable_release_payload (urj_cable_queue_info_t *q, uint8_t *payload)
+{
+    urj_cable_arena_t *a = q->arena;
+
+    if (payload == NULL || !arena_owns (a, payload))
+        return;
+
+    if (--a->live == 0)
+        arena_rewind (a);
+}
+
+static int
+queue_init (urj_cable_queue_info_t *q, int size)
+{
+    q->max_items = size;
+    q->num_items = 0;
+    q->next_item = 0;
+    q->next_free = 0;
+    memset (&q->stats, 0, sizeof (q->stats));
+    q->data = malloc (size * sizeof (urj_cable_queue_t));
+    if (q->data == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("malloc(%zd) fails"),
+                       size * sizeof (urj_cable_queue_t));
+        return URJ_STATUS_FAIL;
+    }
+
+    return URJ_STATUS_OK;
+}
+
 int
 urj_tap_cable_init (urj_cable_t *cable)
 {
-    cable->delay = 0;
+    int size;
+
+    memset (&cable->pace, 0, sizeof cable->pace);
     cable->frequency = 0;
+    cable->requested_frequency = 0;
+
+    cable->todo.arena = &cable->payload;
+    cable->done.arena = &cable->payload;
+
+    /* the ring indices wrap by masking, so round up to a power of two */
+    size = cable->queue_size ? 1 : CABLE_QUEUE_DEFAULT_SIZE;
+    while (size < cable->queue_size && size < CABLE_QUEUE_MAX_SIZE)
+        size *= 2;
+
+    cable->tickets.slot = NULL;
+    cable->tickets.max_slots = 0;
+    cable->tickets.first = cable->tickets.next = URJ_CABLE_NO_TICKET + 1;
+    cable->tickets.pending = 0;
 
-    cable->todo.max_items = 128;
-    cable->todo.num_items = 0;
-    cable->todo.next_item = 0;
-    cable->todo.next_free = 0;
-    cable->todo.data =
-        malloc (cable->todo.max_items * sizeof (urj_cable_queue_t));
-
-    cable->done.max_items = 128;
-    cable->done.num_items = 0;
-    cable->done.next_item = 0;
-    cable->done.next_free = 0;
-    cable->done.data =
-        malloc (cable->done.max_items * sizeof (urj_cable_queue_t));
-
-    if (cable->todo.data == NULL || cable->done.data == NULL)
-    {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY,
-                       _("malloc(%zd)/malloc(%zd) fails"),
-                       cable->todo.max_items * sizeof (urj_cable_queue_t),
-                       cable->done.max_items * sizeof (urj_cable_queue_t));
-        if (cable->todo.data != NULL)
-            free (cable->todo.data);
-        if (cable->done.data != NULL)
-            free (cable->done.data);
+    cable->todo.data = NULL;
+    cable->done.data = NULL;
+    if (queue_init (&cable->todo, size) != URJ_STATUS_OK
+        || queue_init (&cable->done, size) != URJ_STATUS_OK)
+    {
+        free (cable->todo.data);
+        free (cable->done.data);
+        cable->todo.data = NULL;
+        cable->done.data = NULL;
         return URJ_STATUS_FAIL;
     }
 
@@ -117,16 +297,45 @@ urj_tap_cable_done (urj_cable_t *cable)
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
     if (cable->todo.data != NULL)
     {
+        urj_log (URJ_LOG_LEVEL_DETAIL,
+                 "Queue statistics: todo %lu items, max %d, %d resizes; "
+                 "done %lu items, max %d, %d resizes\n",
+                 cable->todo.stats.added, cable->todo.stats.high_water,
+                 cable->todo.stats.resizes, cable->done.stats.added,
+                 cable->done.stats.high_water, cable->done.stats.resizes);
         free (cable->todo.data);
         free (cable->done.data);
     }
+    free (cable->tickets.slot);
+    cable->tickets.slot = NULL;
+    arena_done (&cable->payload);
     cable->driver->done (cable);
 }
 
+void
+urj_tap_cable_get_queue_stats (urj_cable_t *cable,
+                               urj_cable_queue_stats_t *todo,
+                               urj_cable_queue_stats_t *done)
+{
+    if (todo != NULL)
+        *todo = cable->todo.stats;
+    if (done != NULL)
+        *done = cable->done.stats;
+}
+
+void
+urj_tap_cable_reset_queue_stats (urj_cable_t *cable)
+{
+    memset (&cable->todo.stats, 0, sizeof (cable->todo.stats));
+    memset (&cable->done.stats, 0, sizeof (cable->done.stats));
+    cable->todo.stats.high_water = cable->todo.num_items;
+    cable->done.stats.high_water = cable->done.num_items;
+}
+
 int
 urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
 {
-    int i, j;
+    int i;
     if (q->num_items >= q->max_items)   /* queue full? */
     {
         int new_max_items;
@@ -136,7 +345,7 @@ urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
             "Queue %p needs resizing; n(%d) >= max(%d); free=%d, next=%d\n",
              q, q->num_items, q->max_items, q->next_free, q->next_item);
 
-        new_max_items = q->max_items + 128;
+        new_max_items = 2 * q->max_items;
         resized = realloc (q->data, new_max_items * sizeof (urj_cable_queue_t));
         if (resized == NULL)
         {
@@ -150,80 +359,18 @@ urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
                  new_max_items);
         q->data = resized;
 
-        /* The queue was full. Except for the special case when next_item is 0,
-         * resizing just introduced a gap between old and new max, which has to
-         * be filled; either by moving data from next_item .. max_items, or
-         * from 0 .. next_free (whatever is smaller). */
-
-#define CHOOSE_SMALLEST_AREA_TO_MOVE 1
-
+        /* The queue was full, so next_free == next_item.  Unless that is 0,
+         * the items wrapped around: 3456|12 -> ____|123456__.  Doubling adds
+         * exactly as much room as the wrapped part can take, so appending
+         * it behind the old end closes the gap with a single copy and keeps
+         * the amortised cost per item constant. */
         if (q->next_item != 0)
-        {
-            int added_space = new_max_items - q->max_items;
-            int num_to_move = q->max_items - q->next_item;
-
-#ifdef CHOOSE_SMALLEST_AREA_TO_MOVE
-            if (num_to_move <= q->next_free)
-#endif /* def CHOOSE_SMALLEST_AREA_TO_MOVE */
-            {
-                /* Move queue items at end of old array
-                 * towards end of new array: 345612__ -> 3456__12 */
+            memcpy (&q->data[q->max_items], &q->data[0],
+                    q->next_free * sizeof (urj_cable_queue_t));
 
-                int dest = new_max_items - num_to_move;
-                urj_log (URJ_LOG_LEVEL_DETAIL,
-                    "Resize: Move %d items towards end of queue memory (%d > %d)\n",
-                    num_to_move, q->next_item, dest);
-                memmove (&q->data[dest], &q->data[q->next_item],
-                         num_to_move * sizeof (urj_cable_queue_t));
-
-                q->next_item = dest;
-            }
-#ifdef CHOOSE_SMALLEST_AREA_TO_MOVE
-            else
-            {
-                if (q->next_free <= added_space)
-                {
-                    /* Relocate queue items at beginning of old array
-                     * to end of new array: 561234__ -> __123456 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                             "Resize: Move %d items from start to end\n",
-                             q->next_free);
-                    memcpy (&q->data[q->max_items], &q->data[0],
-                            q->next_free * sizeof (urj_cable_queue_t));
-
-                }
-                else
-                {
-                    /* Same as above, but for the case if new space
-                     * isn't large enough to hold all relocated items */
-
-                    /* Step 1: 456123__ -> __612345 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                             "Resize.A: Move %d items from start to end\n",
-                            added_space);
-
-                    memcpy (&q->data[q->max_items], &q->data[0],
-                            added_space * sizeof (urj_cable_queue_t));
-
-                    /* Step 2: __612345 -> 6__12345 */
-
-                    urj_log (URJ_LOG_LEVEL_DETAIL,
-                         "Resize.B: Move %d items towards start (offset %d)\n",
-                         (q->next_free - added_space), added_space);
-
-                    memmove (&q->data[0], &q->data[added_space],
-                             (q->next_free -
-                              added_space) * sizeof (urj_cable_queue_t));
-                }
-            }
-#endif /* def CHOOSE_SMALLEST_AREA_TO_MOVE */
-        }
-        q->max_items = new_max_items;
         q->next_free = q->next_item + q->num_items;
-        if (q->next_free >= new_max_items)
-            q->next_free -= new_max_items;
+        q->max_items = new_max_items;
+        q->stats.resizes++;
 
         urj_log (URJ_LOG_LEVEL_DETAIL,
              "Queue %p after resizing; n(%d) >= max(%d); free=%d, next=%d\n",
@@ -231,11 +378,12 @@ urj_tap_cable_add_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
     }
 
     i = q->next_free;
-    j = i + 1;
-    if (j >= q->max_items)
-        j = 0;
-    q->next_free = j;
+    q->data[i].ticket = URJ_CABLE_NO_TICKET;
+    q->next_free = (i + 1) & (q->max_items - 1);
     q->num_items++;
+    q->stats.added++;
+    if (q->num_items > q->stats.high_water)
+        q->stats.high_water = q->num_items;
 
     // urj_log (URJ_LOG_LEVEL_DEBUG, "add_queue_item to %p: %d\n", q, i);
     return i;
@@ -247,10 +395,7 @@ urj_tap_cable_get_queue_item (urj_cable_t *cable, urj_cable_queue_info_t *q)
     if (q->num_items > 0)
     {
         int i = q->next_item;
-        int j = i + 1;
-        if (j >= q->max_items)
-            j = 0;
-        q->next_item = j;
+        q->next_item = (i + 1) & (q->max_items - 1);
         q->num_items--;
         // urj_log (URJ_LOG_LEVEL_DEBUG, "get_queue_item from %p: %d\n", q, i);
         return i;
@@ -271,21 +416,17 @@ urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io)
         {
             if (io == 0)        /* todo queue */
             {
-                if (q->data[i].arg.transfer.in != NULL)
-                    free (q->data[i].arg.transfer.in);
-                if (q->data[i].arg.transfer.out != NULL)
-                    free (q->data[i].arg.transfer.out);
+                urj_tap_cable_release_payload (q, q->data[i].arg.transfer.in);
+                urj_tap_cable_release_payload (q,
+                                               q->data[i].arg.transfer.out);
             }
             else                /* done queue */
             {
-                if (q->data[i].arg.xferred.out != NULL)
-                    free (q->data[i].arg.xferred.out);
+                urj_tap_cable_release_payload (q, q->data[i].arg.xferred.out);
             }
         }
 
-        i++;
-        if (i >= q->max_items)
-            i = 0;
+        q->next_item = (i + 1) & (q->max_items - 1);
         q->num_items--;
     }
 
@@ -294,6 +435,96 @@ urj_tap_cable_purge_queue (urj_cable_queue_info_t *q, int io)
     q->next_free = 0;
 }
 
+enum
+{
+    TICKET_FREE,
+    TICKET_PENDING,
+    TICKET_READY,
+};
+
+struct URJ_CABLE_TICKET_SLOT
+{
+    int state;
+    /** result once state is TICKET_READY */
+    int val;
+    /** where transfer results go */
+    uint8_t *out;
+};
+
+static struct URJ_CABLE_TICKET_SLOT *
+ticket_slot (urj_cable_tickets_t *t, urj_cable_ticket_t ticket)
+{
+    if (ticket - t->first >= t->next - t->first)
+        return NULL;
+
+    return &t->slot[ticket & (t->max_slots - 1)];
+}
+
+/**
+ * Move the results of ticketed operations from the done queue into their
+ * slots.  The remaining items keep their order for the _late functions.
+ */
+static void
+cable_collect_tickets (urj_cable_t *cable)
+{
+    urj_cable_queue_info_t *q = &cable->done;
+    int mask = q->max_items - 1;
+    int k, n;
+
+    if (cable->tickets.pending == 0)
+        return;
+
+    for (k = n = 0; k < q->num_items; k++)
+    {
+        urj_cable_queue_t *item = &q->data[(q->next_item + k) & mask];
+        struct URJ_CABLE_TICKET_SLOT *slot;
+
+        if (item->ticket == URJ_CABLE_NO_TICKET)
+        {
+            q->data[(q->next_item + n++) & mask] = *item;
+            continue;
+        }
+
+        slot = ticket_slot (&cable->tickets, item->ticket);
+        if (item->action == URJ_TAP_CABLE_TRANSFER)
+        {
+            if (slot != NULL && slot->out != item->arg.xferred.out)
+                urj_tap_bits_copy (slot->out, 0, item->arg.xferred.out, 0,
+                                   item->arg.xferred.len);
+            urj_tap_cable_release_payload (q, item->arg.xferred.out);
+            if (slot != NULL)
+                slot->val = item->arg.xferred.res;
+        }
+        else if (slot != NULL)
+            slot->val = item->arg.value.val;
+
+        if (slot != NULL && slot->state == TICKET_PENDING)
+        {
+            slot->state = TICKET_READY;
+            cable->tickets.pending--;
+        }
+    }
+
+    q->num_items = n;
+    q->next_free = (q->next_item + n) & mask;
+}
+
+/* flush until the done queue has a result for the _late functions */
+static void
+cable_flush_to_output (urj_cable_t *cable)
+{
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+    if (cable->tickets.pending == 0)
+        return;
+
+    cable_collect_tickets (cable);
+    if (cable->done.num_items == 0 && cable->todo.num_items > 0)
+    {
+        urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+        cable_collect_tickets (cable);
+    }
+}
+
 void
 urj_tap_cable_clock (urj_cable_t *cable, int tms, int tdi, int n)
 {
@@ -315,6 +546,26 @@ urj_tap_cable_defer_clock (urj_cable_t *cable, int tms, int tdi, int n)
     return URJ_STATUS_OK;                   /* success */
 }
 
+int
+urj_tap_cable_defer_tms (urj_cable_t *cable, uint32_t tms, int tdi, int n)
+{
+    while (n > 0)
+    {
+        int k = n < CABLE_TMS_BITS ? n : CABLE_TMS_BITS;
+        int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
+        if (i < 0)
+            return URJ_STATUS_FAIL;           /* report failure */
+        cable->todo.data[i].action = URJ_TAP_CABLE_CLOCK_COMPACT;
+        cable->todo.data[i].arg.clock.tms = tms & ((1 << k) - 1);
+        cable->todo.data[i].arg.clock.tdi = tdi;
+        cable->todo.data[i].arg.clock.n = k;
+        tms >>= k;
+        n -= k;
+    }
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    return URJ_STATUS_OK;                   /* success */
+}
+
 int
 urj_tap_cable_get_tdo (urj_cable_t *cable)
 {
@@ -326,7 +577,7 @@ int
 urj_tap_cable_get_tdo_late (urj_cable_t *cable)
 {
     int i;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+    cable_flush_to_output (cable);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
     if (i >= 0)
     {
@@ -387,7 +638,7 @@ int
 urj_tap_cable_get_signal_late (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
     int i;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+    cable_flush_to_output (cable);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
     if (i >= 0)
     {
@@ -433,10 +684,26 @@ urj_tap_cable_transfer (urj_cable_t *cable, int len, char *in, char *out)
 }
 
 int
-urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
+urj_tap_cable_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                               uint8_t *out)
+{
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    return urj_tap_cable_generic_transfer_packed (cable, len, in, out);
+}
+
+int
+urj_tap_cable_transfer_exit (urj_cable_t *cable, int len, const uint8_t *in,
+                             uint8_t *out)
+{
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    return urj_tap_cable_generic_transfer_exit (cable, len, in, out);
+}
+
+static int
+cable_transfer_result (urj_cable_t *cable)
 {
     int i;
-    urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+    cable_flush_to_output (cable);
     i = urj_tap_cable_get_queue_item (cable, &cable->done);
 
     if (i >= 0 && cable->done.data[i].action == URJ_TAP_CABLE_TRANSFER)
@@ -447,79 +714,393 @@ urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
                 cable->done.data[i].arg.xferred.len,
                 cable->done.data[i].arg.xferred.out);
 #endif
-        if (out)
-            memcpy (out,
-                    cable->done.data[i].arg.xferred.out,
-                    cable->done.data[i].arg.xferred.len);
-        free (cable->done.data[i].arg.xferred.out);
-        return cable->done.data[i].arg.xferred.res;
+        return i;
     }
 
-    if (cable->done.data[i].action != URJ_TAP_CABLE_TRANSFER)
+    if (i < 0)
+    {
+        urj_warning (
+             _("Internal error: Wanted transfer result but none was queued\n"));
+    }
+    else
     {
         urj_warning (
              _("Internal error: Got wrong type of result from queue (#%d %p.%d)\n"),
              cable->done.data[i].action, &cable->done, i);
         urj_tap_cable_purge_queue (&cable->done, 1);
     }
-    else
+    return -1;
+}
+
+int
+urj_tap_cable_transfer_late (urj_cable_t *cable, char *out)
+{
+    int i = cable_transfer_result (cable);
+
+    if (i < 0)
+        return 0;
+
+    if (out)
+        urj_tap_bits_unpack (out, cable->done.data[i].arg.xferred.out, 0,
+                             cable->done.data[i].arg.xferred.len);
+    urj_tap_cable_release_payload (&cable->done,
+                                   cable->done.data[i].arg.xferred.out);
+    return cable->done.data[i].arg.xferred.res;
+}
+
+int
+urj_tap_cable_transfer_packed_late (urj_cable_t *cable, uint8_t *out)
+{
+    int i = cable_transfer_result (cable);
+
+    if (i < 0)
+        return 0;
+
+    if (out)
+        urj_tap_bits_copy (out, 0, cable->done.data[i].arg.xferred.out, 0,
+                           cable->done.data[i].arg.xferred.len);
+    urj_tap_cable_release_payload (&cable->done,
+                                   cable->done.data[i].arg.xferred.out);
+    return cable->done.data[i].arg.xferred.res;
+}
+
+/* queue a transfer of len bits with the given payload buffers */
+static int
+cable_queue_transfer (urj_cable_t *cable, int len, uint8_t *ibuf,
+                      uint8_t *obuf, int exit, urj_cable_ticket_t ticket)
+{
+    int i = urj_tap_cable_add_queue_item (cable, &cable->todo);
+    if (i < 0)
+        return URJ_STATUS_FAIL;               /* report failure */
+
+    cable->todo.data[i].action = URJ_TAP_CABLE_TRANSFER;
+    cable->todo.data[i].ticket = ticket;
+    cable->todo.data[i].arg.transfer.len = len;
+    cable->todo.data[i].arg.transfer.in = ibuf;
+    cable->todo.data[i].arg.transfer.out = obuf;
+    cable->todo.data[i].arg.transfer.exit = exit;
+    return URJ_STATUS_OK;
+}
+
+/* take the payload buffers for a transfer of len bits from the arena */
+static int
+cable_alloc_payload (urj_cable_t *cable, int len, uint8_t **ibuf,
+                     uint8_t **obuf)
+{
+    size_t bytes = URJ_TAP_REGISTER_BYTES (len);
+
+    *ibuf = arena_alloc (&cable->payload, bytes);
+    if (*ibuf == NULL)
+        return URJ_STATUS_FAIL;
+
+    if (obuf != NULL)
     {
-        urj_warning (
-             _("Internal error: Wanted transfer result but none was queued\n"));
+        *obuf = arena_alloc (&cable->payload, bytes);
+        if (*obuf == NULL)
+        {
+            urj_tap_cable_release_payload (&cable->todo, *ibuf);
+            return URJ_STATUS_FAIL;
+        }
     }
-    return 0;
+
+    return URJ_STATUS_OK;
 }
 
 int
 urj_tap_cable_defer_transfer (urj_cable_t *cable, int len, char *in,
                               char *out)
 {
-    char *ibuf, *obuf = NULL;
-    int i;
+    uint8_t *ibuf, *obuf = NULL;
+
+    if (cable_alloc_payload (cable, len, &ibuf, out ? &obuf : NULL)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if (in)
+        urj_tap_bits_pack (ibuf, 0, in, len);
+    else
+        memset (ibuf, 0, URJ_TAP_REGISTER_BYTES (len));
 
-    ibuf = malloc (len);
-    if (ibuf == NULL)
+    if (cable_queue_transfer (cable, len, ibuf, obuf, 0, URJ_CABLE_NO_TICKET)
+        != URJ_STATUS_OK)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) len);
+        urj_tap_cable_release_payload (&cable->todo, ibuf);
+        urj_tap_cable_release_payload (&cable->todo, obuf);
         return URJ_STATUS_FAIL;
     }
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    return URJ_STATUS_OK;                   /* success */
+}
 
-    if (out)
+static int
+cable_defer_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                             uint8_t *out, int exit, urj_cable_ticket_t ticket,
+                             int zero_copy)
+{
+    uint8_t *ibuf, *obuf = NULL;
+
+    if (zero_copy && in != NULL)
+    {
+        /* the caller keeps both buffers alive until the result is in */
+        ibuf = (uint8_t *) in;
+        obuf = out;
+    }
+    else
+    {
+        if (cable_alloc_payload (cable, len, &ibuf, out ? &obuf : NULL)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+
+        if (in)
+            urj_tap_bits_copy (ibuf, 0, in, 0, len);
+        else
+            memset (ibuf, 0, URJ_TAP_REGISTER_BYTES (len));
+    }
+
+    if (cable_queue_transfer (cable, len, ibuf, obuf, exit, ticket)
+        != URJ_STATUS_OK)
     {
-        obuf = malloc (len);
-        if (obuf == NULL)
+        urj_tap_cable_release_payload (&cable->todo, ibuf);
+        urj_tap_cable_release_payload (&cable->todo, obuf);
+        return URJ_STATUS_FAIL;
+    }
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    return URJ_STATUS_OK;                   /* success */
+}
+
+int
+urj_tap_cable_defer_transfer_packed (urj_cable_t *cable, int len,
+                                     const uint8_t *in, uint8_t *out)
+{
+    return cable_defer_transfer_packed (cable, len, in, out, 0,
+                                        URJ_CABLE_NO_TICKET, 0);
+}
+
+int
+urj_tap_cable_defer_transfer_exit (urj_cable_t *cable, int len,
+                                   const uint8_t *in, uint8_t *out)
+{
+    return cable_defer_transfer_packed (cable, len, in, out, 1,
+                                        URJ_CABLE_NO_TICKET, 0);
+}
+
+/** @return a pending ticket for a result going to out; NO_TICKET on failure */
+static urj_cable_ticket_t
+ticket_issue (urj_cable_t *cable, uint8_t *out)
+{
+    urj_cable_tickets_t *t = &cable->tickets;
+    struct URJ_CABLE_TICKET_SLOT *slot;
+
+    if (t->next - t->first >= t->max_slots)
+    {
+        unsigned long max_slots = t->max_slots ? 2 * t->max_slots : 64;
+        struct URJ_CABLE_TICKET_SLOT *resized;
+        urj_cable_ticket_t i;
+
+        resized = malloc (max_slots * sizeof (*resized));
+        if (resized == NULL)
         {
-            free (ibuf);
             urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                           (size_t) len);
-            return URJ_STATUS_FAIL;
+                           max_slots * sizeof (*resized));
+            return URJ_CABLE_NO_TICKET;
         }
+        for (i = t->first; i != t->next; i++)
+            resized[i & (max_slots - 1)] = t->slot[i & (t->max_slots - 1)];
+        free (t->slot);
+        t->slot = resized;
+        t->max_slots = max_slots;
     }
 
+    slot = &t->slot[t->next & (t->max_slots - 1)];
+    slot->state = TICKET_PENDING;
+    slot->val = -1;
+    slot->out = out;
+    t->pending++;
+
+    return t->next++;
+}
+
+/* give a slot up and drop the tickets that are done with from the front */
+static void
+ticket_release (urj_cable_tickets_t *t, struct URJ_CABLE_TICKET_SLOT *slot)
+{
+    if (slot->state == TICKET_PENDING)
+        t->pending--;
+    slot->state = TICKET_FREE;
+
+    while (t->first != t->next
+           && t->slot[t->first & (t->max_slots - 1)].state == TICKET_FREE)
+        t->first++;
+}
+
+/* undo ticket_issue when the operation could not be queued */
+static void
+ticket_cancel (urj_cable_t *cable, urj_cable_ticket_t ticket)
+{
+    struct URJ_CABLE_TICKET_SLOT *slot = ticket_slot (&cable->tickets, ticket);
+
+    /* it is always the ticket handed out last */
+    cable->tickets.next = ticket;
+    ticket_release (&cable->tickets, slot);
+}
+
+static urj_cable_ticket_t
+cable_defer_transfer_ticket (urj_cable_t *cable, int len, const uint8_t *in,
+                             uint8_t *out, int exit, int zero_copy)
+{
+    urj_cable_ticket_t ticket;
+
+    if (out == NULL)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "out == NULL");
+        return URJ_CABLE_NO_TICKET;
+    }
+
+    ticket = ticket_issue (cable, out);
+    if (ticket == URJ_CABLE_NO_TICKET)
+        return URJ_CABLE_NO_TICKET;
+
+    if (cable_defer_transfer_packed (cable, len, in, out, exit, ticket,
+                                     zero_copy) != URJ_STATUS_OK)
+    {
+        ticket_cancel (cable, ticket);
+        return URJ_CABLE_NO_TICKET;
+    }
+
+    return ticket;
+}
+
+urj_cable_ticket_t
+urj_tap_cable_defer_transfer_ticket (urj_cable_t *cable, int len,
+                                     const uint8_t *in, uint8_t *out)
+{
+    return cable_defer_transfer_ticket (cable, len, in, out, 0, 0);
+}
+
+urj_cable_ticket_t
+urj_tap_cable_defer_transfer_exit_ticket (urj_cable_t *cable, int len,
+                                          const uint8_t *in, uint8_t *out)
+{
+    return cable_defer_transfer_ticket (cable, len, in, out, 1, 0);
+}
+
+urj_cable_ticket_t
+urj_tap_cable_defer_transfer_exit_zero_copy (urj_cable_t *cable, int len,
+                                             const uint8_t *in, uint8_t *out)
+{
+    return cable_defer_transfer_ticket (cable, len, in, out, 1, 1);
+}
+
+urj_cable_ticket_t
+urj_tap_cable_defer_get_tdo_ticket (urj_cable_t *cable)
+{
+    urj_cable_ticket_t ticket;
+    int i;
+
+    ticket = ticket_issue (cable, NULL);
+    if (ticket == URJ_CABLE_NO_TICKET)
+        return URJ_CABLE_NO_TICKET;
+
     i = urj_tap_cable_add_queue_item (cable, &cable->todo);
     if (i < 0)
     {
-        free (ibuf);
-        if (obuf)
-            free (obuf);
-        return URJ_STATUS_FAIL;               /* report failure */
+        ticket_cancel (cable, ticket);
+        return URJ_CABLE_NO_TICKET;
     }
+    cable->todo.data[i].action = URJ_TAP_CABLE_GET_TDO;
+    cable->todo.data[i].ticket = ticket;
+    urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+    return ticket;
+}
 
-    cable->todo.data[i].action = URJ_TAP_CABLE_TRANSFER;
-    cable->todo.data[i].arg.transfer.len = len;
-    if (in)
-        memcpy (ibuf, in, len);
-    cable->todo.data[i].arg.transfer.in = ibuf;
-    cable->todo.data[i].arg.transfer.out = obuf;
+urj_cable_ticket_t
+urj_tap_cable_defer_get_signal_ticket (urj_cable_t *cable,
+                                       urj_pod_sigsel_t sig)
+{
+    urj_cable_ticket_t ticket;
+    int i;
+
+    ticket = ticket_issue (cable, NULL);
+    if (ticket == URJ_CABLE_NO_TICKET)
+        return URJ_CABLE_NO_TICKET;
+
+    i = urj_tap_cable_add_queue_item (cable, &cable->todo);
+    if (i < 0)
+    {
+        ticket_cancel (cable, ticket);
+        return URJ_CABLE_NO_TICKET;
+    }
+    cable->todo.data[i].action = URJ_TAP_CABLE_GET_SIGNAL;
+    cable->todo.data[i].arg.value.sig = sig;
+    cable->todo.data[i].ticket = ticket;
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
-    return URJ_STATUS_OK;                   /* success */
+    return ticket;
+}
+
+int
+urj_tap_cable_ticket_poll (urj_cable_t *cable, urj_cable_ticket_t ticket)
+{
+    struct URJ_CABLE_TICKET_SLOT *slot;
+
+    slot = ticket_slot (&cable->tickets, ticket);
+    if (slot == NULL || slot->state == TICKET_FREE)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, "unknown ticket %lu", ticket);
+        return -1;
+    }
+
+    if (slot->state == TICKET_PENDING)
+    {
+        urj_tap_cable_flush (cable, URJ_TAP_CABLE_OPTIONALLY);
+        cable_collect_tickets (cable);
+    }
+
+    return slot->state == TICKET_READY;
+}
+
+int
+urj_tap_cable_ticket_wait (urj_cable_t *cable, urj_cable_ticket_t ticket)
+{
+    struct URJ_CABLE_TICKET_SLOT *slot;
+    int val;
+
+    slot = ticket_slot (&cable->tickets, ticket);
+    if (slot == NULL || slot->state == TICKET_FREE)
+    {
+        urj_error_set (URJ_ERROR_NOTFOUND, "unknown ticket %lu", ticket);
+        return -1;
+    }
+
+    if (slot->state == TICKET_PENDING)
+    {
+        urj_tap_cable_flush (cable, URJ_TAP_CABLE_TO_OUTPUT);
+        cable_collect_tickets (cable);
+    }
+    if (slot->state == TICKET_PENDING)
+    {
+        urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+        cable_collect_tickets (cable);
+    }
+
+    if (slot->state == TICKET_READY)
+        val = slot->val;
+    else
+    {
+        /* the result got purged from the done queue */
+        urj_error_set (URJ_ERROR_NOTFOUND, "result of ticket %lu was lost",
+                       ticket);
+        val = -1;
+    }
+    ticket_release (&cable->tickets, slot);
+
+    return val;
 }
 
 void
 urj_tap_cable_set_frequency (urj_cable_t *cable, uint32_t new_frequency)
 {
     urj_tap_cable_flush (cable, URJ_TAP_CABLE_COMPLETELY);
+    cable->requested_frequency = new_frequency;
     cable->driver->set_frequency (cable, new_frequency);
 }
 
@@ -529,18 +1110,16 @@ urj_tap_cable_get_frequency (urj_cable_t *cable)
     return cable->frequency;
 }
 
+uint32_t
+urj_tap_cable_get_requested_frequency (urj_cable_t *cable)
+{
+    return cable->requested_frequency;
+}
+
 void
 urj_tap_cable_wait (urj_cable_t *cable)
 {
-    int i;
-    volatile int j;
-
-    j = 0;
-    for (i = 0; i < cable->delay; ++i)
-        j = i;
-
-    /* Avoid gcc set-but-unused warnings */
-    cable->delay = j + 1;
+    urj_tap_cable_pace_wait (cable);
 }
 
 static urj_cable_t *
@@ -566,6 +1145,52 @@ urj_tap_cable_create (urj_chain_t *chain, const urj_cable_driver_t *driver)
     return cable;
 }
 
+/**
+ * Pick the parameters handled here for all cables and hand the rest on to
+ * the driver, so that drivers without own parameters still accept them.
+ * @return the parameters for the driver (free() with the pointer only);
+ *      NULL on failure
+ */
+static const urj_param_t **
+urj_tap_cable_common_params (urj_cable_t *cable, const urj_param_t *params[])
+{
+    const urj_param_t **rest;
+    size_t i, n;
+
+    n = urj_param_num (params);
+    rest = calloc (n + 1, sizeof (*rest));
+    if (rest == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       n + 1, sizeof (*rest));
+        return NULL;
+    }
+
+    for (i = n = 0; params != NULL && params[i] != NULL; i++)
+    {
+        switch (params[i]->key)
+        {
+        case URJ_CABLE_PARAM_KEY_QUEUE:
+            cable->queue_size = params[i]->value.lu > CABLE_QUEUE_MAX_SIZE
+                ? CABLE_QUEUE_MAX_SIZE : params[i]->value.lu;
+            break;
+        case URJ_CABLE_PARAM_KEY_IOTHREAD:
+#ifdef HAVE_PTHREAD
+            cable->io_thread = params[i]->value.enabled;
+#else
+            if (params[i]->value.enabled)
+                urj_warning (_("No thread support, ignoring iothread\n"));
+#endif
+            break;
+        default:
+            rest[n++] = params[i];
+            break;
+        }
+    }
+
+    return rest;
+}
+
 static int
 urj_tap_cable_start (urj_chain_t *chain, urj_cable_t *cable)
 {
@@ -588,6 +1213,8 @@ urj_tap_cable_parport_connect (urj_chain_t *chain, const urj_cable_driver_t *dri
                                const char *devname, const urj_param_t *params[])
 {
     urj_cable_t *cable;
+    const urj_param_t **driver_params;
+    int ret;
 
     if (driver->device_type != URJ_CABLE_DEVICE_PARPORT)
     {
@@ -600,8 +1227,17 @@ urj_tap_cable_parport_connect (urj_chain_t *chain, const urj_cable_driver_t *dri
     if (cable == NULL)
         return NULL;
 
-    if (cable->driver->connect.parport (cable, devtype, devname,
-                                        params) != URJ_STATUS_OK)
+    driver_params = urj_tap_cable_common_params (cable, params);
+    if (driver_params == NULL)
+    {
+        free (cable);
+        return NULL;
+    }
+
+    ret = cable->driver->connect.parport (cable, devtype, devname,
+                                          driver_params);
+    free (driver_params);
+    if (ret != URJ_STATUS_OK)
     {
         free (cable);
         return NULL;
@@ -618,6 +1254,8 @@ urj_tap_cable_usb_connect (urj_chain_t *chain, const urj_cable_driver_t *driver,
                            const urj_param_t *params[])
 {
     urj_cable_t *cable;
+    const urj_param_t **driver_params;
+    int ret;
 
     if (driver->device_type != URJ_CABLE_DEVICE_USB)
     {
@@ -629,7 +1267,16 @@ urj_tap_cable_usb_connect (urj_chain_t *chain, const urj_cable_driver_t *driver,
     if (cable == NULL)
         return NULL;
 
-    if (cable->driver->connect.usb (cable, params) != URJ_STATUS_OK)
+    driver_params = urj_tap_cable_common_params (cable, params);
+    if (driver_params == NULL)
+    {
+        free (cable);
+        return NULL;
+    }
+
+    ret = cable->driver->connect.usb (cable, driver_params);
+    free (driver_params);
+    if (ret != URJ_STATUS_OK)
     {
         free (cable);
         return NULL;
@@ -646,6 +1293,8 @@ urj_tap_cable_other_connect (urj_chain_t *chain, const urj_cable_driver_t *drive
                              const urj_param_t *params[])
 {
     urj_cable_t *cable;
+    const urj_param_t **driver_params;
+    int ret;
 
     if (driver->device_type != URJ_CABLE_DEVICE_OTHER)
     {
@@ -657,7 +1306,16 @@ urj_tap_cable_other_connect (urj_chain_t *chain, const urj_cable_driver_t *drive
     if (cable == NULL)
         return NULL;
 
-    if (cable->driver->connect.other (cable, params) != URJ_STATUS_OK)
+    driver_params = urj_tap_cable_common_params (cable, params);
+    if (driver_params == NULL)
+    {
+        free (cable);
+        return NULL;
+    }
+
+    ret = cable->driver->connect.other (cable, driver_params);
+    free (driver_params);
+    if (ret != URJ_STATUS_OK)
     {
         free (cable);
         return NULL;
@@ -683,6 +1341,8 @@ static const urj_param_descr_t cable_param[] =
     { URJ_CABLE_PARAM_KEY_INTERFACE,    URJ_PARAM_TYPE_LU,      "interface", },
     { URJ_CABLE_PARAM_KEY_FIRMWARE,     URJ_PARAM_TYPE_STRING,  "firmware", },
     { URJ_CABLE_PARAM_KEY_INDEX,        URJ_PARAM_TYPE_LU,      "index", },
+    { URJ_CABLE_PARAM_KEY_QUEUE,        URJ_PARAM_TYPE_LU,      "queue", },
+    { URJ_CABLE_PARAM_KEY_IOTHREAD,     URJ_PARAM_TYPE_BOOL,    "iothread", },
 };
 
 const urj_param_list_t urj_cable_param_list =
@@ -26,8 +26,12 @@
 
 #include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include <urjtag/error.h>
+#include <urjtag/log.h>
 
 #include "generic.h"
 #include "generic_usbconn.h"
@@ -235,6 +239,345 @@ urj_tap_cable_cx_cmd_queue (urj_tap_cable_cx_cmd_root_t *cmd_root,
 }
 
 
+#ifdef HAVE_PTHREAD
+
+/* upper limit for the bytes handed to the worker but not yet written */
+#define CX_WORKER_MAX_PENDING   (1024 * 1024)
+
+struct URJ_TAP_CABLE_CX_WORKER
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* signalled on new jobs and on stop */
+    pthread_cond_t idle;        /* signalled when jobs have been written */
+    urj_usbconn_t *conn;
+    urj_tap_cable_cx_cmd_root_t jobs;
+    uint32_t pending;           /* payload bytes in jobs and in flight */
+    int flush;                  /* flush the usbconn after the jobs */
+    int busy;
+    int stop;
+    int status;                 /* URJ_STATUS_FAIL once a write failed */
+    urj_error_state_t error;    /* the error of the failed write */
+    urj_log_capture_t log;      /* log output of the worker */
+};
+
+
+/*****************************************************************************
+ * cx_cmd_drop( cmd_root )
+ *
+ * Frees all queued commands without sending them.
+ *
+ * cmd_root : pointer to urj_tap_cable_cx_cmd_root_t struct
+ *
+ * Return value:
+ * none
+ *
+ ****************************************************************************/
+static void
+cx_cmd_drop (urj_tap_cable_cx_cmd_root_t *cmd_root)
+{
+    urj_tap_cable_cx_cmd_t *cmd;
+
+    while ((cmd = urj_tap_cable_cx_cmd_dequeue (cmd_root)) != NULL)
+        urj_tap_cable_cx_cmd_free (cmd);
+}
+
+
+/*****************************************************************************
+ * cx_worker_run( arg )
+ *
+ * Thread function of the worker.  Takes over all queued jobs at once,
+ * writes them to the usbconn driver and flushes it if requested, while
+ * the cable driver goes on filling the next commands.
+ *
+ * Error and log state of the usbconn driver stay in this thread; a failed
+ * write is recorded in the worker and the jobs are dropped until the
+ * caller has taken it over with cx_worker_take.
+ *
+ * arg : pointer to urj_tap_cable_cx_worker_t
+ *
+ * Return value:
+ * NULL
+ *
+ ****************************************************************************/
+static void *
+cx_worker_run (void *arg)
+{
+    struct URJ_TAP_CABLE_CX_WORKER *w = arg;
+    urj_log_capture_t log = { NULL, 0, 0 };
+
+    urj_log_capture (&log);
+
+    pthread_mutex_lock (&w->lock);
+    for (;;)
+    {
+        urj_tap_cable_cx_cmd_root_t batch;
+        urj_tap_cable_cx_cmd_t *cmd;
+        uint32_t written = 0;
+        int status = URJ_STATUS_OK;
+        int drop;
+        int flush;
+
+        while (w->jobs.first == NULL && !w->stop)
+            pthread_cond_wait (&w->wake, &w->lock);
+        if (w->jobs.first == NULL)
+            break;
+
+        batch = w->jobs;
+        w->jobs.first = w->jobs.last = NULL;
+        flush = w->flush;
+        w->flush = 0;
+        w->busy = 1;
+        drop = w->status != URJ_STATUS_OK;
+        pthread_mutex_unlock (&w->lock);
+
+        while ((cmd = urj_tap_cable_cx_cmd_dequeue (&batch)) != NULL)
+        {
+            if (!drop && status == URJ_STATUS_OK
+                && urj_tap_usbconn_write (w->conn, cmd->buf, cmd->buf_pos,
+                                          0) < 0)
+                status = URJ_STATUS_FAIL;
+            written += cmd->buf_pos;
+            urj_tap_cable_cx_cmd_free (cmd);
+        }
+        if (flush && !drop && status == URJ_STATUS_OK
+            && urj_tap_usbconn_read (w->conn, NULL, 0) < 0)
+            status = URJ_STATUS_FAIL;
+
+        pthread_mutex_lock (&w->lock);
+        if (status != URJ_STATUS_OK)
+        {
+            w->status = status;
+            w->error = urj_error_state;
+        }
+        urj_log_capture_move (&w->log, &log);
+        w->busy = 0;
+        w->pending -= written;
+        pthread_cond_broadcast (&w->idle);
+    }
+    pthread_mutex_unlock (&w->lock);
+
+    urj_log_capture (NULL);
+
+    return NULL;
+}
+
+
+/*****************************************************************************
+ * cx_worker_start( cmd_root, cable )
+ *
+ * Starts the worker thread for the given command root.
+ *
+ * Return value:
+ * 0 : Error occured, stay synchronous
+ * 1 : All ok
+ *
+ ****************************************************************************/
+static int
+cx_worker_start (urj_tap_cable_cx_cmd_root_t *cmd_root, urj_cable_t *cable)
+{
+    struct URJ_TAP_CABLE_CX_WORKER *w = calloc (1, sizeof (*w));
+
+    if (w == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd,%zd) fails",
+                       (size_t) 1, sizeof (*w));
+        return 0;
+    }
+
+    w->conn = cable->link.usb;
+    w->status = URJ_STATUS_OK;
+    pthread_mutex_init (&w->lock, NULL);
+    pthread_cond_init (&w->wake, NULL);
+    pthread_cond_init (&w->idle, NULL);
+
+    if (pthread_create (&w->thread, NULL, cx_worker_run, w) != 0)
+    {
+        urj_error_set (URJ_ERROR_IO, "pthread_create() fails");
+        pthread_cond_destroy (&w->idle);
+        pthread_cond_destroy (&w->wake);
+        pthread_mutex_destroy (&w->lock);
+        free (w);
+        return 0;
+    }
+
+    urj_log (URJ_LOG_LEVEL_DETAIL, "Started I/O thread for cable %s\n",
+             cable->driver->name);
+    cmd_root->worker = w;
+
+    return 1;
+}
+
+
+/*****************************************************************************
+ * cx_worker_take( w, log )
+ *
+ * Takes over the status and the log output of the worker into the calling
+ * thread.  The worker's error becomes the caller's error state.  To be
+ * called with the lock held; log is to be replayed once it is released.
+ *
+ * w   : pointer to the worker
+ * log : receives the log output of the worker
+ *
+ * Return value:
+ * URJ_STATUS_OK   : All writes succeeded
+ * URJ_STATUS_FAIL : A write failed since the last call
+ *
+ ****************************************************************************/
+static int
+cx_worker_take (struct URJ_TAP_CABLE_CX_WORKER *w, urj_log_capture_t *log)
+{
+    int status = w->status;
+
+    urj_log_capture_move (log, &w->log);
+    if (status != URJ_STATUS_OK)
+    {
+        urj_error_state = w->error;
+        w->status = URJ_STATUS_OK;
+    }
+
+    return status;
+}
+
+
+/*****************************************************************************
+ * cx_worker_sync( cmd_root )
+ *
+ * Waits until the worker has written everything handed to it, so that
+ * the caller may use the usbconn driver itself.
+ *
+ * cmd_root : pointer to urj_tap_cable_cx_cmd_root_t struct
+ *
+ * Return value:
+ * URJ_STATUS_OK   : All ok
+ * URJ_STATUS_FAIL : A write of the worker failed, error state is set
+ *
+ ****************************************************************************/
+static int
+cx_worker_sync (urj_tap_cable_cx_cmd_root_t *cmd_root)
+{
+    struct URJ_TAP_CABLE_CX_WORKER *w = cmd_root->worker;
+    urj_log_capture_t log = { NULL, 0, 0 };
+    int status;
+
+    if (w == NULL)
+        return URJ_STATUS_OK;
+
+    pthread_mutex_lock (&w->lock);
+    while (w->jobs.first != NULL || w->busy)
+        pthread_cond_wait (&w->idle, &w->lock);
+    status = cx_worker_take (w, &log);
+    pthread_mutex_unlock (&w->lock);
+
+    urj_log_capture_replay (&log);
+
+    return status;
+}
+
+
+/*****************************************************************************
+ * cx_worker_post( cmd_root, flush )
+ *
+ * Moves all queued commands over to the worker.  Blocks while the worker
+ * lags behind by more than CX_WORKER_MAX_PENDING bytes.  If one of the
+ * earlier writes failed, the commands are dropped instead.
+ *
+ * cmd_root : pointer to urj_tap_cable_cx_cmd_root_t struct
+ * flush    : let the worker flush the usbconn driver afterwards
+ *
+ * Return value:
+ * URJ_STATUS_OK   : All ok
+ * URJ_STATUS_FAIL : A write of the worker failed, error state is set
+ *
+ ****************************************************************************/
+static int
+cx_worker_post (urj_tap_cable_cx_cmd_root_t *cmd_root, int flush)
+{
+    struct URJ_TAP_CABLE_CX_WORKER *w = cmd_root->worker;
+    urj_log_capture_t log = { NULL, 0, 0 };
+    urj_tap_cable_cx_cmd_t *cmd;
+    uint32_t bytes = 0;
+    int status;
+
+    for (cmd = cmd_root->first; cmd; cmd = cmd->next)
+        bytes += cmd->buf_pos;
+
+    pthread_mutex_lock (&w->lock);
+    while (w->pending > CX_WORKER_MAX_PENDING)
+        pthread_cond_wait (&w->idle, &w->lock);
+
+    status = cx_worker_take (w, &log);
+    if (status == URJ_STATUS_OK)
+    {
+        if (w->jobs.last)
+            w->jobs.last->next = cmd_root->first;
+        else
+            w->jobs.first = cmd_root->first;
+        w->jobs.last = cmd_root->last;
+        w->pending += bytes;
+        w->flush |= flush;
+        cmd_root->first = cmd_root->last = NULL;
+
+        pthread_cond_signal (&w->wake);
+    }
+    pthread_mutex_unlock (&w->lock);
+
+    urj_log_capture_replay (&log);
+    if (status != URJ_STATUS_OK)
+        cx_cmd_drop (cmd_root);
+
+    return status;
+}
+
+
+/*****************************************************************************
+ * cx_worker_stop( cmd_root )
+ *
+ * Lets the worker finish its jobs and terminates it.  A failure of the
+ * last writes can only be logged here.
+ *
+ * cmd_root : pointer to urj_tap_cable_cx_cmd_root_t struct
+ *
+ * Return value:
+ * none
+ *
+ ****************************************************************************/
+static void
+cx_worker_stop (urj_tap_cable_cx_cmd_root_t *cmd_root)
+{
+    struct URJ_TAP_CABLE_CX_WORKER *w = cmd_root->worker;
+    urj_log_capture_t log = { NULL, 0, 0 };
+    int status;
+
+    if (w == NULL)
+        return;
+
+    pthread_mutex_lock (&w->lock);
+    w->stop = 1;
+    pthread_cond_signal (&w->wake);
+    pthread_mutex_unlock (&w->lock);
+    pthread_join (w->thread, NULL);
+
+    status = cx_worker_take (w, &log);
+    urj_log_capture_replay (&log);
+    if (status != URJ_STATUS_OK)
+        urj_log_error_describe (URJ_LOG_LEVEL_ERROR);
+
+    pthread_cond_destroy (&w->idle);
+    pthread_cond_destroy (&w->wake);
+    pthread_mutex_destroy (&w->lock);
+    free (w);
+    cmd_root->worker = NULL;
+}
+
+#else /* HAVE_PTHREAD */
+
+#define cx_worker_sync(cmd_root)        URJ_STATUS_OK
+#define cx_worker_stop(cmd_root)        do { } while (0)
+
+#endif /* HAVE_PTHREAD */
+
+
 /*****************************************************************************
  * urj_tap_cable_cx_cmd_init( cmd_root )
  *
@@ -251,6 +594,7 @@ urj_tap_cable_cx_cmd_init (urj_tap_cable_cx_cmd_root_t *cmd_root)
 {
     cmd_root->first = NULL;
     cmd_root->last = NULL;
+    cmd_root->worker = NULL;
 }
 
 
@@ -258,6 +602,7 @@ urj_tap_cable_cx_cmd_init (urj_tap_cable_cx_cmd_root_t *cmd_root)
  * urj_tap_cable_cx_cmd_deinit( cmd_root )
  *
  * Deinitialzes and frees all elements from the command root structure.
+ * Stops the I/O thread, if any.
  *
  * cmd_root : pointer to urj_tap_cable_cx_cmd_root_t
  *
@@ -268,12 +613,8 @@ urj_tap_cable_cx_cmd_init (urj_tap_cable_cx_cmd_root_t *cmd_root)
 void
 urj_tap_cable_cx_cmd_deinit (urj_tap_cable_cx_cmd_root_t *cmd_root)
 {
-    urj_tap_cable_cx_cmd_t *cmd;
-    while (cmd_root->first)
-    {
-        cmd = urj_tap_cable_cx_cmd_dequeue (cmd_root);
-        urj_tap_cable_cx_cmd_free (cmd);
-    }
+    cx_worker_stop (cmd_root);
+    cx_cmd_drop (cmd_root);
 }
 
 
@@ -294,19 +635,55 @@ urj_tap_cable_cx_cmd_deinit (urj_tap_cable_cx_cmd_root_t *cmd_root)
  * cable    : current urj_cable_t
  * how_much : urj_cable_flush_amount_t value specifying the flush strategy
  *
+ * Once a write fails, the remaining commands are dropped.  A failed write
+ * of the I/O thread is reported by the next call.
+ *
  * Return value:
- * none
+ * URJ_STATUS_OK   : All ok
+ * URJ_STATUS_FAIL : A write or the flush failed, error state is set
  *
  ****************************************************************************/
-void
+int
 urj_tap_cable_cx_xfer (urj_tap_cable_cx_cmd_root_t *cmd_root,
                        const urj_tap_cable_cx_cmd_t *out_cmd,
                        urj_cable_t *cable, urj_cable_flush_amount_t how_much)
 {
-    urj_tap_cable_cx_cmd_t *cmd = urj_tap_cable_cx_cmd_dequeue (cmd_root);
+    urj_tap_cable_cx_cmd_t *cmd;
     uint32_t bytes_to_recv;
+    int status;
+
+    bytes_to_recv = 0;
+    for (cmd = cmd_root->first; cmd; cmd = cmd->next)
+        bytes_to_recv += cmd->to_recv;
+
+#ifdef HAVE_PTHREAD
+    /* Commands that don't return data can go to the wire in the background
+       while the caller assembles the next ones.  A complete flush still
+       waits for them, just like reading does. */
+    if (cable->io_thread && bytes_to_recv == 0 && cmd_root->first)
+    {
+        if (cmd_root->worker || cx_worker_start (cmd_root, cable))
+        {
+            status = cx_worker_post (cmd_root,
+                                     how_much != URJ_TAP_CABLE_TO_OUTPUT);
+            if (status == URJ_STATUS_OK
+                && how_much == URJ_TAP_CABLE_COMPLETELY)
+                status = cx_worker_sync (cmd_root);
+            return status;
+        }
+        cable->io_thread = 0;
+    }
+#endif
+
+    /* the usbconn driver must be all ours from here on */
+    if (cx_worker_sync (cmd_root) != URJ_STATUS_OK)
+    {
+        cx_cmd_drop (cmd_root);
+        return URJ_STATUS_FAIL;
+    }
 
     bytes_to_recv = 0;
+    cmd = urj_tap_cable_cx_cmd_dequeue (cmd_root);
 
     while (cmd)
     {
@@ -314,8 +691,13 @@ urj_tap_cable_cx_xfer (urj_tap_cable_cx_cmd_root_t *cmd_root,
            through the usbconn driver */
         bytes_to_recv += cmd->to_recv;
         /* write command data (buffered) */
-        urj_tap_usbconn_write (cable->link.usb, cmd->buf, cmd->buf_pos,
-                               cmd->to_recv);
+        if (urj_tap_usbconn_write (cable->link.usb, cmd->buf, cmd->buf_pos,
+                                   cmd->to_recv) < 0)
+        {
+            urj_tap_cable_cx_cmd_free (cmd);
+            cx_cmd_drop (cmd_root);
+            return URJ_STATUS_FAIL;
+        }
         urj_tap_cable_cx_cmd_free (cmd);
         cmd = urj_tap_cable_cx_cmd_dequeue (cmd_root);
     }
@@ -325,18 +707,22 @@ urj_tap_cable_cx_xfer (urj_tap_cable_cx_cmd_root_t *cmd_root,
        data is expected */
     if (bytes_to_recv && out_cmd)
     {
-        urj_tap_usbconn_write (cable->link.usb, out_cmd->buf,
-                               out_cmd->buf_pos, out_cmd->to_recv);
+        if (urj_tap_usbconn_write (cable->link.usb, out_cmd->buf,
+                                   out_cmd->buf_pos, out_cmd->to_recv) < 0)
+            return URJ_STATUS_FAIL;
         bytes_to_recv += out_cmd->to_recv;
     }
 
     if (bytes_to_recv || (how_much != URJ_TAP_CABLE_TO_OUTPUT))
     {
         /* Step 2: flush scheduled bytes */
-        urj_tap_usbconn_read (cable->link.usb, NULL, 0);
+        if (urj_tap_usbconn_read (cable->link.usb, NULL, 0) < 0)
+            return URJ_STATUS_FAIL;
 
         bytes_to_recv = 0;
     }
+
+    return URJ_STATUS_OK;
 }
 
 
@@ -46,6 +46,8 @@ struct URJ_TAP_CABLE_CX_CMD_ROOT
 {
     urj_tap_cable_cx_cmd_t *first;
     urj_tap_cable_cx_cmd_t *last;
+    /* background writer, started on demand when cable->io_thread is set */
+    struct URJ_TAP_CABLE_CX_WORKER *worker;
 };
 typedef struct URJ_TAP_CABLE_CX_CMD_ROOT urj_tap_cable_cx_cmd_root_t;
 
@@ -62,10 +64,10 @@ urj_tap_cable_cx_cmd_t
 void urj_tap_cable_cx_cmd_init (urj_tap_cable_cx_cmd_root_t *cmd_root);
 void urj_tap_cable_cx_cmd_deinit (urj_tap_cable_cx_cmd_root_t *cmd_root);
 
-void urj_tap_cable_cx_xfer (urj_tap_cable_cx_cmd_root_t *cmd_root,
-                            const urj_tap_cable_cx_cmd_t *out_cmd,
-                            urj_cable_t *cable,
-                            urj_cable_flush_amount_t how_much);
+int urj_tap_cable_cx_xfer (urj_tap_cable_cx_cmd_root_t *cmd_root,
+                           const urj_tap_cable_cx_cmd_t *out_cmd,
+                           urj_cable_t *cable,
+                           urj_cable_flush_amount_t how_much);
 uint8_t urj_tap_cable_cx_xfer_recv (urj_cable_t *cable);
 
 #endif /* URJ_TAP_CABLE_CMD_XFER_H */
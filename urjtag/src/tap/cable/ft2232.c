@@ -886,8 +886,9 @@ ft2232_usbscarab2_init (urj_cable_t *cable)
     /* Check if cable is connected to the target and the target is powered on */
     urj_tap_cable_cx_cmd_queue (cmd_root, 1);
     urj_tap_cable_cx_cmd_push (cmd_root, GET_BITS_LOW);
-    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
     if ((urj_tap_cable_cx_xfer_recv (cable) & BITMASK_USBSCARAB2_nCONNECTED)
         != 0)
     {
@@ -947,8 +948,9 @@ ft2232_ktlink_init (urj_cable_t *cable)
     /* Check the SRST state (KT-LINK specific, direct input). */
     urj_tap_cable_cx_cmd_queue (cmd_root, 1);
     urj_tap_cable_cx_cmd_push (cmd_root, GET_BITS_LOW);
-    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
     if ((urj_tap_cable_cx_xfer_recv (cable) & BITMASK_KTLINK_SRSTin) == 0)
         urj_log (URJ_LOG_LEVEL_NORMAL, "nSRST pin state is low. Active?\n");
     else
@@ -1018,8 +1020,9 @@ ft2232_milkymist_init (urj_cable_t *cable)
     /* Check if cable is connected to the target and the target is powered on */
     urj_tap_cable_cx_cmd_queue (cmd_root, 1);
     urj_tap_cable_cx_cmd_push (cmd_root, GET_BITS_LOW);
-    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
     if ((urj_tap_cable_cx_xfer_recv (cable) & BITMASK_MILKYMIST_VREF) == 0)
     {
         urj_error_set (URJ_ERROR_ILLEGAL_STATE,
@@ -1639,8 +1642,9 @@ ft2232_get_tdo (urj_cable_t *cable)
     params_t *params = cable->params;
 
     ft2232_get_tdo_schedule (cable);
-    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
     return ft2232_get_tdo_finish (cable);
 }
 
@@ -1739,8 +1743,8 @@ ft2232_set_signal (urj_cable_t *cable, int mask, int val)
 
 
 static void
-ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
-                          char *out)
+ft2232_transfer_schedule (urj_cable_t *cable, int len, const uint8_t *in,
+                          uint8_t *out)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
@@ -1803,13 +1807,9 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
      *********************************************************************/
         for (byte_idx = 0; byte_idx < chunkbytes; byte_idx++)
         {
-            int bit_idx;
-            unsigned char b = 0;
-
-            for (bit_idx = 1; bit_idx < 256; bit_idx <<= 1)
-                if (in[in_offset++])
-                    b |= bit_idx;
-            urj_tap_cable_cx_cmd_push (cmd_root, b);
+            /* in_offset is byte aligned here */
+            urj_tap_cable_cx_cmd_push (cmd_root, in[in_offset >> 3]);
+            in_offset += 8;
         }
 
         /* recalc chunkbytes for next round */
@@ -1850,16 +1850,8 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
      * Step 4:
      * Write TDI data bitwise
      ***********************************************************************/
-        {
-            int bit_idx;
-            unsigned char b = 0;
-            for (bit_idx = 1; bit_idx < 1 << bitwise_len; bit_idx <<= 1)
-            {
-                if (in[in_offset++])
-                    b |= bit_idx;
-            }
-            urj_tap_cable_cx_cmd_push (cmd_root, b);
-        }
+        urj_tap_cable_cx_cmd_push (cmd_root, in[in_offset >> 3]
+                                   & ((1 << bitwise_len) - 1));
     }
 
     if (out)
@@ -1876,7 +1868,7 @@ ft2232_transfer_schedule (urj_cable_t *cable, int len, const char *in,
 
 
 static int
-ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
+ft2232_transfer_finish (urj_cable_t *cable, int len, uint8_t *out)
 {
     params_t *params = cable->params;
     int bitwise_len;
@@ -1899,12 +1891,8 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
             xferred = chunkbytes;
             for (; xferred > 0; xferred--)
             {
-                int bit_idx;
-                unsigned char b;
-
-                b = urj_tap_cable_cx_xfer_recv (cable);
-                for (bit_idx = 1; bit_idx < 256; bit_idx <<= 1)
-                    out[out_offset++] = (b & bit_idx) ? 1 : 0;
+                out[out_offset >> 3] = urj_tap_cable_cx_xfer_recv (cable);
+                out_offset += 8;
             }
         }
 
@@ -1914,14 +1902,12 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
        * Step 6:
        * Read TDO data bitwise if read is requested.
        ***********************************************************************/
-            int bit_idx;
-            unsigned char b;
-
-            b = urj_tap_cable_cx_xfer_recv (cable);
+            /* the bits arrive in the upper end of the byte */
+            uint8_t mask = (1 << bitwise_len) - 1;
+            uint8_t b = urj_tap_cable_cx_xfer_recv (cable)
+                >> (8 - bitwise_len);
 
-            for (bit_idx = (1 << (8 - bitwise_len)); bit_idx < 256;
-                 bit_idx <<= 1)
-                out[out_offset++] = (b & bit_idx) ? 1 : 0;
+            out[out_offset >> 3] = (out[out_offset >> 3] & ~mask) | b;
         }
 
         /* gather current TDO */
@@ -1937,17 +1923,89 @@ ft2232_transfer_finish (urj_cable_t *cable, int len, char *out)
 
 
 static int
-ft2232_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+ft2232_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                        uint8_t *out)
 {
     params_t *params = cable->params;
 
     ft2232_transfer_schedule (cable, len, in, out);
-    urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
     return ft2232_transfer_finish (cable, len, out);
 }
 
 
+static void
+ft2232_transfer_exit_schedule (urj_cable_t *cable, int len,
+                               const uint8_t *in, uint8_t *out)
+{
+    params_t *params = cable->params;
+    urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
+    int tdi;
+
+    if (len <= 0)
+        return;
+    if (len > 1)
+        ft2232_transfer_schedule (cable, len - 1, in, out);
+
+    /* the last bit goes out together with TMS high, reading TDO on the way */
+    tdi = (in[(len - 1) >> 3] >> ((len - 1) & 7)) & 1;
+    urj_tap_cable_cx_cmd_queue (cmd_root, out ? 1 : 0);
+    urj_tap_cable_cx_cmd_push (cmd_root, MPSSE_WRITE_TMS |
+                               (out ? MPSSE_DO_READ : 0) |
+                               MPSSE_LSB | MPSSE_BITMODE | MPSSE_WRITE_NEG);
+    urj_tap_cable_cx_cmd_push (cmd_root, 0);
+    urj_tap_cable_cx_cmd_push (cmd_root, (tdi << 7) | 1);
+
+    params->signals &= ~(URJ_POD_CS_TMS | URJ_POD_CS_TDI | URJ_POD_CS_TCK);
+    params->signals |= URJ_POD_CS_TMS;
+    if (tdi)
+        params->signals |= URJ_POD_CS_TDI;
+    params->last_tdo_valid = 0;
+}
+
+
+static int
+ft2232_transfer_exit_finish (urj_cable_t *cable, int len, uint8_t *out)
+{
+    params_t *params = cable->params;
+
+    if (len <= 0)
+        return 0;
+    if (len > 1)
+        ft2232_transfer_finish (cable, len - 1, out);
+
+    if (out)
+    {
+        /* the single bit arrives in the upper end of the byte */
+        uint8_t bit = 1 << ((len - 1) & 7);
+
+        if (urj_tap_cable_cx_xfer_recv (cable) & 0x80)
+            out[(len - 1) >> 3] |= bit;
+        else
+            out[(len - 1) >> 3] &= ~bit;
+    }
+    params->last_tdo_valid = 0;
+
+    return 0;
+}
+
+
+static int
+ft2232_transfer_exit (urj_cable_t *cable, int len, const uint8_t *in,
+                      uint8_t *out)
+{
+    params_t *params = cable->params;
+
+    ft2232_transfer_exit_schedule (cable, len, in, out);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
+    return ft2232_transfer_exit_finish (cable, len, out);
+}
+
+
 static void
 ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
 {
@@ -1966,6 +2024,7 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
         int post_signals = params->signals;
         int last_tdo_valid_schedule = params->last_tdo_valid;
         int last_tdo_valid_finish = params->last_tdo_valid;
+        int status;
 
         if (cable->todo.num_items == 1
             && cable->todo.data[cable->todo.next_item].action
@@ -2003,15 +2062,15 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     }
                     while (cn > 0)
                     {
-                        byte |= tms << length;
-                        cn--;
-                        length++;
                         if (length == 7)
                         {
                             ft2232_clock_compact_schedule (cable, 6, byte | tdi);
                             length = 0;
                             byte = 0;
                         }
+                        byte |= tms << length;
+                        cn--;
+                        length++;
                     }
                     if (n + 1 < cable->todo.num_items
                         && cable->todo.data[(i + 1) % cable->todo.max_items].action == URJ_TAP_CABLE_CLOCK
@@ -2061,12 +2120,22 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 break;
 
             case URJ_TAP_CABLE_TRANSFER:
-                ft2232_transfer_schedule (cable,
-                                          cable->todo.data[i].arg.transfer.
-                                          len,
-                                          cable->todo.data[i].arg.transfer.in,
-                                          cable->todo.data[i].arg.transfer.
-                                          out);
+                if (cable->todo.data[i].arg.transfer.exit)
+                    ft2232_transfer_exit_schedule (cable,
+                                                   cable->todo.data[i].arg.
+                                                   transfer.len,
+                                                   cable->todo.data[i].arg.
+                                                   transfer.in,
+                                                   cable->todo.data[i].arg.
+                                                   transfer.out);
+                else
+                    ft2232_transfer_schedule (cable,
+                                              cable->todo.data[i].arg.
+                                              transfer.len,
+                                              cable->todo.data[i].arg.
+                                              transfer.in,
+                                              cable->todo.data[i].arg.
+                                              transfer.out);
                 last_tdo_valid_schedule = params->last_tdo_valid;
                 break;
 
@@ -2079,8 +2148,8 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 i = 0;
         }
 
-        urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
-                               how_much);
+        status = urj_tap_cable_cx_xfer (&params->cmd_root, &imm_cmd, cable,
+                                        how_much);
 
         while (j != i)
         {
@@ -2104,9 +2173,9 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     post_signals &=
                         ~(URJ_POD_CS_TCK | URJ_POD_CS_TDI | URJ_POD_CS_TMS);
                     post_signals |=
-                        ((cable->todo.data[j].arg.clock.
-                          tms >> cable->todo.data[j].arg.clock.
-                          n) ? URJ_POD_CS_TMS : 0);
+                        (((cable->todo.data[j].arg.clock.
+                           tms >> (cable->todo.data[j].arg.clock.
+                                   n - 1)) & 1) ? URJ_POD_CS_TMS : 0);
                     post_signals |=
                         (cable->todo.data[j].arg.clock.
                          tdi ? URJ_POD_CS_TDI : 0);
@@ -2124,6 +2193,7 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     last_tdo_valid_finish = params->last_tdo_valid;
                     m = urj_tap_cable_add_queue_item (cable, &cable->done);
                     cable->done.data[m].action = URJ_TAP_CABLE_GET_TDO;
+                    cable->done.data[m].ticket = cable->todo.data[j].ticket;
                     cable->done.data[m].arg.value.val = tdo;
                     break;
                 }
@@ -2149,6 +2219,7 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     int m =
                         urj_tap_cable_add_queue_item (cable, &cable->done);
                     cable->done.data[m].action = URJ_TAP_CABLE_GET_SIGNAL;
+                    cable->done.data[m].ticket = cable->todo.data[j].ticket;
                     cable->done.data[m].arg.value.sig =
                         cable->todo.data[j].arg.value.sig;
                     cable->done.data[m].arg.value.val =
@@ -2158,13 +2229,27 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 }
             case URJ_TAP_CABLE_TRANSFER:
                 {
-                    int r = ft2232_transfer_finish (cable,
+                    int r;
+
+                    /* a failed write fails the transfers queued with it */
+                    if (status != URJ_STATUS_OK)
+                        r = -1;
+                    else if (cable->todo.data[j].arg.transfer.exit)
+                        r = ft2232_transfer_exit_finish (cable,
+                                                         cable->todo.data[j].
+                                                         arg.transfer.len,
+                                                         cable->todo.data[j].
+                                                         arg.transfer.out);
+                    else
+                        r = ft2232_transfer_finish (cable,
                                                     cable->todo.data[j].arg.
                                                     transfer.len,
                                                     cable->todo.data[j].arg.
                                                     transfer.out);
                     last_tdo_valid_finish = params->last_tdo_valid;
-                    free (cable->todo.data[j].arg.transfer.in);
+                    urj_tap_cable_release_payload (&cable->todo,
+                                                   cable->todo.data[j].arg.
+                                                   transfer.in);
                     if (cable->todo.data[j].arg.transfer.out)
                     {
                         int m = urj_tap_cable_add_queue_item (cable,
@@ -2175,6 +2260,8 @@ ft2232_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                             // urj_log (URJ_LOG_LEVEL_NORMAL, "out of memory!\n");
                         }
                         cable->done.data[m].action = URJ_TAP_CABLE_TRANSFER;
+                        cable->done.data[m].ticket =
+                            cable->todo.data[j].ticket;
                         cable->done.data[m].arg.xferred.len =
                             cable->todo.data[j].arg.transfer.len;
                         cable->done.data[m].arg.xferred.res = r;
@@ -2265,11 +2352,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0000, 0x0000, "-mpsse", "FT2232", ft2232)
 
@@ -2285,11 +2375,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_armusbocd_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x0003, "-mpsse", "ARM-USB-OCD", armusbocd)
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x0004, "-mpsse", "ARM-USB-OCD", armusbocdtiny)
@@ -2306,11 +2399,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_armusbtiny_h_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x002A, "-mpsse", "ARM-USB-TINY-H", armusbtiny_h)
 URJ_DECLARE_FTDX_CABLE(0x15BA, 0x002B, "-mpsse", "ARM-USB-OCD-H", armusbocd_h)
@@ -2327,11 +2423,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_gnice_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0456, 0xF000, "-mpsse", "gnICE", gnice)
 
@@ -2347,11 +2446,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_gniceplus_driver = {
     ft2232h_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0456, 0xF001, "-mpsse", "gnICE+", gniceplus)
 
@@ -2367,11 +2469,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_jtagkey_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xCFF8, "-mpsse", "JTAGkey", jtagkey)
 
@@ -2387,11 +2492,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_oocdlinks_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbaf8, "-mpsse", "OOCDLink-s", oocdlinks)
 
@@ -2407,11 +2515,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_turtelizer2_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xBDC8, "-mpsse", "Turtelizer2", turtelizer2)
 
@@ -2427,11 +2538,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbjtagrs232_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x1457, 0x5118, "-mpsse", "USB-JTAG-RS232", usbjtagrs232)
 
@@ -2447,11 +2561,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbtojtagif_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0000, 0x0000, "-mpsse", "USB-to-JTAG-IF", usbtojtagif)
 
@@ -2467,11 +2584,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_signalyzer_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbca1, "-mpsse", "Signalyzer", signalyzer)
 
@@ -2487,11 +2607,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_flyswatter_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0x6010, "-mpsse", "Flyswatter", flyswatter)
 
@@ -2507,11 +2630,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_usbscarab2_driver = {
     ft2232_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbbe0, "-mpsse", "usbScarab2", usbscarab2)
 
@@ -2527,11 +2653,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_ktlink_driver = {
     ft2232h_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x0403, 0xbbe2, "-mpsse", "KT-LINK", ktlink)
 
@@ -2547,11 +2676,14 @@ const urj_cable_driver_t urj_tap_cable_ft2232_milkymist_driver = {
     ft2232h_set_frequency,
     ft2232_clock,
     ft2232_get_tdo,
-    ft2232_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     ft2232_set_signal,
     urj_tap_cable_generic_get_signal,
     ft2232_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    ft2232_transfer_packed,
+    ft2232_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x20b7, 0x0713, "-mpsse", "milkymist", milkymist)
 
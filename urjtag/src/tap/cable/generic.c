@@ -33,18 +33,25 @@
 #include <urjtag/cable.h>
 #include <urjtag/parport.h>
 #include <urjtag/chain.h>
-#include <urjtag/fclock.h>
+#include <urjtag/tap_register.h>
 
 #include "generic.h"
+#include "pace.h"
 
 #include <urjtag/cmd.h>
 
+static int
+packed_bit (const uint8_t *vec, int n)
+{
+    return (vec[n >> 3] >> (n & 7)) & 1;
+}
+
 static void
-print_vector (urj_log_level_t ll, int len, char *vec)
+print_vector (urj_log_level_t ll, int len, const uint8_t *vec)
 {
     int i;
     for (i = 0; i < len; i++)
-        urj_log (ll, "%c", vec[i] ? '1' : '0');
+        urj_log (ll, "%c", packed_bit (vec, i) ? '1' : '0');
 }
 
 
@@ -77,6 +84,101 @@ urj_tap_cable_generic_transfer (urj_cable_t *cable, int len, const char *in,
     return i;
 }
 
+int
+urj_tap_cable_generic_transfer_packed (urj_cable_t *cable, int len,
+                                       const uint8_t *in, uint8_t *out)
+{
+    char *cin, *cout = NULL;
+    int r = -1;
+
+    if (cable->driver->transfer_packed)
+        return cable->driver->transfer_packed (cable, len, in, out);
+
+    /* the driver's transfer() wants one char per bit */
+    cin = malloc (len > 0 ? len : 1);
+    if (cin != NULL && out != NULL)
+        cout = malloc (len > 0 ? len : 1);
+    if (cin == NULL || (cout == NULL && out != NULL))
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                       (size_t) len);
+        free (cin);
+        return -1;
+    }
+
+    urj_tap_bits_unpack (cin, in, 0, len);
+    r = cable->driver->transfer (cable, len, cin, cout);
+    if (cout)
+        urj_tap_bits_pack (out, 0, cout, len);
+
+    free (cin);
+    free (cout);
+
+    return r;
+}
+
+int
+urj_tap_cable_generic_transfer_exit (urj_cable_t *cable, int len,
+                                     const uint8_t *in, uint8_t *out)
+{
+    int r = 0;
+
+    if (cable->driver->transfer_exit)
+        return cable->driver->transfer_exit (cable, len, in, out);
+
+    if (len <= 0)
+        return 0;
+
+    if (len > 1)
+    {
+        r = urj_tap_cable_generic_transfer_packed (cable, len - 1, in, out);
+        if (r < 0)
+            return r;
+    }
+
+    if (out)
+    {
+        uint8_t bit = 1 << ((len - 1) & 7);
+
+        if (cable->driver->get_tdo (cable))
+            out[(len - 1) >> 3] |= bit;
+        else
+            out[(len - 1) >> 3] &= ~bit;
+    }
+    cable->driver->clock (cable, 1, packed_bit (in, len - 1), 1);
+
+    return r + 1;
+}
+
+int
+urj_tap_cable_generic_transfer_unpacked (urj_cable_t *cable, int len,
+                                         const char *in, char *out)
+{
+    size_t bytes = URJ_TAP_REGISTER_BYTES (len);
+    uint8_t *pin, *pout = NULL;
+    int r;
+
+    pin = malloc (bytes ? bytes : 1);
+    if (pin != NULL && out != NULL)
+        pout = malloc (bytes ? bytes : 1);
+    if (pin == NULL || (pout == NULL && out != NULL))
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails", bytes);
+        free (pin);
+        return -1;
+    }
+
+    urj_tap_bits_pack (pin, 0, in, len);
+    r = cable->driver->transfer_packed (cable, len, pin, pout);
+    if (pout)
+        urj_tap_bits_unpack (out, pout, 0, len);
+
+    free (pin);
+    free (pout);
+
+    return r;
+}
+
 int
 urj_tap_cable_generic_get_signal (urj_cable_t *cable, urj_pod_sigsel_t sig)
 {
@@ -123,15 +225,22 @@ do_one_queued_action (urj_cable_t *cable)
         case URJ_TAP_CABLE_TRANSFER:
             {
                 /* @@@@ RFHH check result */
-                int r = cable->driver->transfer (cable,
-                                                 cable->todo.data[i].arg.
-                                                 transfer.len,
-                                                 cable->todo.data[i].arg.
-                                                 transfer.in,
-                                                 cable->todo.data[i].arg.
-                                                 transfer.out);
-
-                free (cable->todo.data[i].arg.transfer.in);
+                int r;
+
+                if (cable->todo.data[i].arg.transfer.exit)
+                    r = urj_tap_cable_generic_transfer_exit (cable,
+                            cable->todo.data[i].arg.transfer.len,
+                            cable->todo.data[i].arg.transfer.in,
+                            cable->todo.data[i].arg.transfer.out);
+                else
+                    r = urj_tap_cable_generic_transfer_packed (cable,
+                            cable->todo.data[i].arg.transfer.len,
+                            cable->todo.data[i].arg.transfer.in,
+                            cable->todo.data[i].arg.transfer.out);
+
+                urj_tap_cable_release_payload (&cable->todo,
+                                               cable->todo.data[i].arg.
+                                               transfer.in);
                 if (cable->todo.data[i].arg.transfer.out != NULL)
                 {
                     /* @@@@ RFHH check result */
@@ -141,6 +250,8 @@ do_one_queued_action (urj_cable_t *cable)
                              &cable->done, j,
                              cable->todo.data[i].arg.transfer.out);
                     cable->done.data[j].action = URJ_TAP_CABLE_TRANSFER;
+                    cable->done.data[j].ticket =
+                        cable->todo.data[i].ticket;
                     cable->done.data[j].arg.xferred.len =
                         cable->todo.data[i].arg.transfer.len;
                     cable->done.data[j].arg.xferred.res = r;
@@ -155,6 +266,7 @@ do_one_queued_action (urj_cable_t *cable)
             urj_log (URJ_LOG_LEVEL_DEBUG,
                      "add result from get_tdo to %p.%d\n", &cable->done, j);
             cable->done.data[j].action = URJ_TAP_CABLE_GET_TDO;
+            cable->done.data[j].ticket = cable->todo.data[i].ticket;
             cable->done.data[j].arg.value.val =
                 cable->driver->get_tdo (cable);
             break;
@@ -165,14 +277,33 @@ do_one_queued_action (urj_cable_t *cable)
                      "add result from get_signal to %p.%d\n", &cable->done,
                      j);
             cable->done.data[j].action = URJ_TAP_CABLE_GET_SIGNAL;
+            cable->done.data[j].ticket = cable->todo.data[i].ticket;
             cable->done.data[j].arg.value.sig =
                 cable->todo.data[i].arg.value.sig;
             cable->done.data[j].arg.value.val =
                 cable->driver->get_signal (cable,
                                            cable->todo.data[i].arg.value.sig);
             break;
-        case URJ_TAP_CABLE_CLOCK_COMPACT: /* Turn off GCC warning */
-            break;
+        case URJ_TAP_CABLE_CLOCK_COMPACT:
+            {
+                int tms = cable->todo.data[i].arg.clock.tms;
+                int n = cable->todo.data[i].arg.clock.n;
+
+                /* one clock() per run of equal TMS bits */
+                while (n > 0)
+                {
+                    int k = 1;
+
+                    while (k < n && ((tms >> k) & 1) == (tms & 1))
+                        k++;
+                    cable->driver->clock (cable, tms & 1,
+                                          cable->todo.data[i].arg.clock.tdi,
+                                          k);
+                    tms >>= k;
+                    n -= k;
+                }
+                break;
+            }
         }
         urj_log (URJ_LOG_LEVEL_DEBUG, "do_one_queued done\n");
 
@@ -198,7 +329,7 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                                             urj_cable_flush_amount_t how_much)
 {
     int i, j, n;
-    char *in, *out;
+    uint8_t *in, *out;
 
     if (how_much == URJ_TAP_CABLE_OPTIONALLY)
         return;
@@ -208,7 +339,7 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
 
     do
     {
-        int r, bits = 0, tdo = 0, savbits;
+        int r, bits = 0, tdo = 0, savbits, exit = 0;
 
         urj_log (URJ_LOG_LEVEL_DETAIL, "flush(%d)\n", cable->todo.num_items);
 
@@ -246,6 +377,16 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                 int k = cable->todo.data[i].arg.transfer.len;
                 urj_log (URJ_LOG_LEVEL_DETAIL, "%d transfer\n", k);
                 bits += k;
+                if (cable->todo.data[i].arg.transfer.exit && k > 0)
+                {
+                    /* TMS goes up on its last bit: nothing can follow */
+                    urj_log (URJ_LOG_LEVEL_DETAIL,
+                             "cutoff after n=%d because of transfer exit\n",
+                             n);
+                    exit = 1;
+                    n++;
+                    break;
+                }
             }
             i++;
             if (i >= cable->todo.max_items)
@@ -265,8 +406,8 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
         {
             /* Step 2: Combine into single transfer. */
 
-            in = malloc (bits);
-            out = malloc (bits);
+            in = calloc (1, URJ_TAP_REGISTER_BYTES (bits));
+            out = calloc (1, URJ_TAP_REGISTER_BYTES (bits));
 
             if (in == NULL || out == NULL)
             {
@@ -284,16 +425,20 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                 if (cable->todo.data[i].action == URJ_TAP_CABLE_CLOCK)
                 {
                     int k;
-                    for (k = 0; k < cable->todo.data[i].arg.clock.n; k++)
-                        in[bits++] = cable->todo.data[i].arg.clock.tdi;
+                    /* in starts out all zero */
+                    if (cable->todo.data[i].arg.clock.tdi)
+                        for (k = 0; k < cable->todo.data[i].arg.clock.n; k++)
+                            in[(bits + k) >> 3] |= 1 << ((bits + k) & 7);
+                    bits += cable->todo.data[i].arg.clock.n;
                 }
                 else if (cable->todo.data[i].action == URJ_TAP_CABLE_TRANSFER)
                 {
                     int len = cable->todo.data[i].arg.transfer.len;
                     if (len > 0)
                     {
-                        memcpy (in + bits,
-                                cable->todo.data[i].arg.transfer.in, len);
+                        urj_tap_bits_copy (in, bits,
+                                           cable->todo.data[i].arg.
+                                           transfer.in, 0, len);
                         bits += len;
                     }
                 }
@@ -305,7 +450,11 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
             /* Step 3: Do the transfer */
 
             /* @@@@ RFHH check result */
-            r = cable->driver->transfer (cable, bits, in, out);
+            if (exit)
+                r = urj_tap_cable_generic_transfer_exit (cable, bits, in, out);
+            else
+                r = urj_tap_cable_generic_transfer_packed (cable, bits, in,
+                                                           out);
             urj_log (URJ_LOG_LEVEL_DETAIL, "in: ");
             print_vector (URJ_LOG_LEVEL_DETAIL, bits, in);
             urj_log (URJ_LOG_LEVEL_DETAIL, "\n");
@@ -323,9 +472,9 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
             {
                 if (cable->todo.data[i].action == URJ_TAP_CABLE_CLOCK)
                 {
-                    int k;
-                    for (k = 0; k < cable->todo.data[i].arg.clock.n; k++)
-                        tdo = out[bits++];
+                    bits += cable->todo.data[i].arg.clock.n;
+                    if (cable->todo.data[i].arg.clock.n > 0)
+                        tdo = packed_bit (out, bits - 1);
                 }
                 else if (cable->todo.data[i].action == URJ_TAP_CABLE_GET_TDO)
                 {
@@ -335,17 +484,20 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                              "add result from transfer to %p.%d\n",
                              &cable->done, c);
                     cable->done.data[c].action = URJ_TAP_CABLE_GET_TDO;
+                    cable->done.data[c].ticket = cable->todo.data[i].ticket;
                     if (bits < savbits)
-                        tdo = out[bits];
+                        tdo = packed_bit (out, bits);
                     else
                         tdo = cable->driver->get_tdo(cable);
                     cable->done.data[c].arg.value.val = tdo;
                 }
                 else if (cable->todo.data[i].action == URJ_TAP_CABLE_TRANSFER)
                 {
-                    char *p = cable->todo.data[i].arg.transfer.out;
+                    uint8_t *p = cable->todo.data[i].arg.transfer.out;
                     int len = cable->todo.data[i].arg.transfer.len;
-                    free (cable->todo.data[i].arg.transfer.in);
+                    urj_tap_cable_release_payload (&cable->todo,
+                                                   cable->todo.data[i].arg.
+                                                   transfer.in);
                     if (p != NULL)
                     {
                         int c = urj_tap_cable_add_queue_item (cable,
@@ -354,16 +506,18 @@ urj_tap_cable_generic_flush_using_transfer (urj_cable_t *cable,
                                  "add result from transfer to %p.%d\n",
                                  &cable->done, c);
                         cable->done.data[c].action = URJ_TAP_CABLE_TRANSFER;
+                        cable->done.data[c].ticket =
+                            cable->todo.data[i].ticket;
                         cable->done.data[c].arg.xferred.len = len;
                         cable->done.data[c].arg.xferred.res = r;
                         cable->done.data[c].arg.xferred.out = p;
                         if (len > 0)
-                            memcpy (p, out + bits, len);
+                            urj_tap_bits_copy (p, 0, out, bits, len);
                     }
                     if (len > 0)
                         bits += len;
                     if (bits > 0)
-                        tdo = out[bits - 1];
+                        tdo = packed_bit (out, bits - 1);
                 }
                 i++;
                 if (i >= cable->todo.max_items)
@@ -384,100 +538,36 @@ void
 urj_tap_cable_generic_set_frequency (urj_cable_t *cable,
                                      uint32_t new_frequency)
 {
-    if (new_frequency == 0)
-    {
-        cable->delay = 0;
-        cable->frequency = 0;
-    }
-    else
-    {
-        const double tolerance = 0.1;
-        uint32_t loops = 2048;
-        uint32_t delay = cable->delay;
-        uint32_t frequency = cable->frequency;
+    uint32_t i, loops;
+    uint64_t start, end;
 
-        if (new_frequency > (1.0 - tolerance) * frequency &&
-            new_frequency < (1.0 + tolerance) * frequency)
-            return;
-
-        urj_log (URJ_LOG_LEVEL_NORMAL,
-                 "requested frequency %lu, now calibrating delay loop\n",
-                (long unsigned) new_frequency);
-
-        while (1)
-        {
-            uint32_t i, new_delay;
-            long double start, end, real_frequency;
+    urj_tap_cable_pace_set (cable, new_frequency);
+    if (new_frequency == 0)
+        return;
 
-            cable->delay = delay;
-            start = urj_lib_frealtime ();
-            for (i = 0; i < loops; ++i)
-            {
-                cable->driver->clock (cable, 0, 0, 1);
-            }
-            end = urj_lib_frealtime ();
+    urj_log (URJ_LOG_LEVEL_NORMAL,
+             "requested frequency %lu, now calibrating TCK pacing\n",
+             (long unsigned) new_frequency);
 
-            if (end < start)
-            {
-                urj_log (URJ_LOG_LEVEL_ERROR,
-                         _("calibration error, wall clock is not monotonically increasing\n"));
-                break;
-            }
-            if (end == start)
-            {
-                /* retry with higher loop count
-                   if the timer is not fine grained enough */
-                loops *= 2;
-                continue;
-            }
-            real_frequency = (long double) loops / (end - start);
-            urj_log (URJ_LOG_LEVEL_NORMAL,
-                     "new real frequency %Lg, delay %lu\n",
-                     real_frequency, (long unsigned) delay);
+    /* clock for some 20 ms to see what the port achieves; the pacing keeps
+       measuring while the cable is in use */
+    loops = new_frequency / 50 + 1;
+    if (loops > 2048)
+        loops = 2048;
 
-            new_delay = (long double) delay *real_frequency / new_frequency;
+    start = urj_tap_cable_pace_now ();
+    for (i = 0; i < loops; ++i)
+        cable->driver->clock (cable, 0, 0, 1);
+    end = urj_tap_cable_pace_now ();
 
-            if (real_frequency >= (1.0 - tolerance) * new_frequency)
-            {
-                if (real_frequency <= (1.0 + tolerance) * new_frequency)
-                {
-                    frequency = real_frequency;
-                    break;
-                }
-                if (new_delay > delay)
-                {
-                    delay = new_delay;
-                }
-                else
-                {
-                    delay++;
-                }
-
-            }
-            else
-            {
-                if (delay == 0)
-                {
-                    urj_log (URJ_LOG_LEVEL_NORMAL, "operating without delay\n");
-                    frequency = real_frequency;
-                    break;
-                }
-
-                if (new_delay < delay)
-                {
-                    delay = new_delay;
-                }
-                else
-                {
-                    if (delay > 0)
-                        delay--;
-                }
-            }
-        }
-
-        urj_log (URJ_LOG_LEVEL_NORMAL, "done\n");
+    if (end > start)
+    {
+        uint64_t real_frequency = (uint64_t) loops * 1000000000 / (end - start);
 
-        cable->delay = delay;
-        cable->frequency = frequency;
+        if (real_frequency < new_frequency)
+            cable->frequency = real_frequency;
     }
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, "achieved frequency %lu\n",
+             (long unsigned) cable->frequency);
 }
@@ -43,6 +43,28 @@ void urj_tap_cable_generic_set_frequency (urj_cable_t *cable,
 /** @return number of clocks on success; -1 on error */
 int urj_tap_cable_generic_transfer (urj_cable_t *cable, int len, const char *in,
                                     char *out);
+/**
+ * Run a transfer on packed bits through the driver: uses its
+ * transfer_packed() if there is one, else converts for transfer()
+ * @return number of clocks on success; -1 on error
+ */
+int urj_tap_cable_generic_transfer_packed (urj_cable_t *cable, int len,
+                                           const uint8_t *in, uint8_t *out);
+/**
+ * Run a transfer on packed bits with TMS raised on the last bit: uses the
+ * driver's transfer_exit() if there is one, else transfers all but the
+ * last bit and clocks that one out separately
+ * @return number of clocks on success; -1 on error
+ */
+int urj_tap_cable_generic_transfer_exit (urj_cable_t *cable, int len,
+                                         const uint8_t *in, uint8_t *out);
+/**
+ * transfer() for drivers that implement transfer_packed(): converts the
+ * one-char-per-bit buffers and calls the driver's transfer_packed()
+ * @return number of clocks on success; -1 on error
+ */
+int urj_tap_cable_generic_transfer_unpacked (urj_cable_t *cable, int len,
+                                             const char *in, char *out);
 int urj_tap_cable_generic_get_signal (urj_cable_t *cable,
                                       urj_pod_sigsel_t sig);
 void urj_tap_cable_generic_flush_one_by_one (urj_cable_t *cable,
@@ -262,7 +262,6 @@ gpio_connect (urj_cable_t *cable, const urj_param_t *params[])
 
     cable->params = cable_params;
     cable->chain = NULL;
-    cable->delay = 1000;
 
     return URJ_STATUS_OK;
 }
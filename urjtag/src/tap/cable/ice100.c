@@ -111,7 +111,8 @@ static int do_rawscan (urj_cable_t *cable, uint8_t firstpkt, uint8_t lastpkt,
                        int32_t collect_dof, int32_t dif_cnt, uint8_t *raw_buf,
                        uint8_t *out);
 static int build_clock_scan (urj_cable_t *cable, int32_t *start_idx, int32_t *num_todo_items);
-static int add_scan_data (urj_cable_t *cable, int32_t num_bits, char *in, char *out);
+static int add_scan_data (urj_cable_t *cable, int32_t num_bits,
+                          const uint8_t *in, uint8_t *out, int exit);
 static void get_recv_data (urj_cable_t *cable, int32_t idx, int32_t dat_idx, uint8_t **rcv_dataptr);
 static uint16_t do_host_cmd (urj_cable_t *cable, uint8_t cmd, uint8_t param, int32_t r_data);
 static uint32_t do_single_reg_value (urj_cable_t *cable, uint8_t reg, int32_t r_data,
@@ -1055,6 +1056,7 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
             switch (todo_data->action)
             {   /* build the scan */
             case URJ_TAP_CABLE_CLOCK:
+            case URJ_TAP_CABLE_CLOCK_COMPACT:
                 build_clock_scan (cable, &i, &n);
                 break;
             case URJ_TAP_CABLE_GET_TDO:
@@ -1070,7 +1072,8 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
             case URJ_TAP_CABLE_TRANSFER:
                 add_scan_data (cable, todo_data->arg.transfer.len,
                                todo_data->arg.transfer.in,
-                               todo_data->arg.transfer.out);
+                               todo_data->arg.transfer.out,
+                               todo_data->arg.transfer.exit);
                 if (!scan_out && todo_data->arg.transfer.out)
                     scan_out = 2;    /* Assigned a number for debug, !0 will do scan */
                 break;
@@ -1159,6 +1162,7 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
             switch (todo_data->action)
             {   /* Pick up data if need be */
             case URJ_TAP_CABLE_CLOCK:
+            case URJ_TAP_CABLE_CLOCK_COMPACT:
                 /* Nothing needs to be done */
                 break;
             case URJ_TAP_CABLE_GET_TDO:
@@ -1167,6 +1171,7 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     done_data = &ptr_done->data[k];
 
                     done_data->action = URJ_TAP_CABLE_GET_TDO;
+                    done_data->ticket = todo_data->ticket;
                     if (tdo_ptr && (tdo_idx != -1) && (tdo_idx <= tap_info->cur_dat))
                     {
                         int32_t dat_idx = tap_info->dat[tdo_idx].idx;
@@ -1200,12 +1205,13 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     done_data = &ptr_done->data[k];
 
                     done_data->action = URJ_TAP_CABLE_GET_SIGNAL;
+                    done_data->ticket = todo_data->ticket;
                     done_data->arg.value.sig = cable->driver->get_signal (cable, done_data->arg.value.sig);
                 }
                 break;
             case URJ_TAP_CABLE_TRANSFER:
                 /* set up the get data */
-                free (todo_data->arg.transfer.in);
+                urj_tap_cable_release_payload (ptr_todo, todo_data->arg.transfer.in);
                 todo_data->arg.transfer.in = NULL;
                 if ((todo_data->arg.transfer.out != NULL) && (tdo_ptr != NULL))
                 {
@@ -1215,6 +1221,7 @@ static void adi_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     get_recv_data (cable, j, tap_info->rcv_dat, &tdo_ptr);
                     tap_info->rcv_dat++;
                     done_data->action = URJ_TAP_CABLE_TRANSFER;
+                    done_data->ticket = todo_data->ticket;
                     done_data->arg.xferred.len = todo_data->arg.transfer.len;
                     done_data->arg.xferred.res = 0;
                     done_data->arg.xferred.out = todo_data->arg.transfer.out;
@@ -1301,7 +1308,7 @@ static void get_recv_data (urj_cable_t *cable, int32_t idx, int32_t idx_dat, uin
 {
     params_t *cable_params = cable->params;
     int32_t len = cable->todo.data[idx].arg.transfer.len;
-    char *buf = cable->todo.data[idx].arg.transfer.out;
+    uint8_t *buf = cable->todo.data[idx].arg.transfer.out;
     num_tap_pairs *tap_info = &cable_params->tap_info;
     int32_t dat_idx = tap_info->dat[idx_dat].idx;
     uint8_t *rcvBuf = (*rcv_dataptr) + cable_params->num_rcv_hdr_bytes+ dat_idx;
@@ -1320,10 +1327,14 @@ static void get_recv_data (urj_cable_t *cable, int32_t idx, int32_t idx_dat, uin
 
     for (i = 0; i < len; i++)
     {
-        *buf++ = (*rcvBuf & bit_set) ? 1 : 0;
+        /* transfer payloads are packed bits, LSB first */
+        if (*rcvBuf & bit_set)
+            buf[i >> 3] |= 1 << (i & 7);
+        else
+            buf[i >> 3] &= ~(1 << (i & 7));
 
 #ifdef DUMP_EACH_RCV_DATA
-        DEBUG ("%d", (int32_t)*(buf - 1));
+        DEBUG ("%d", (buf[i >> 3] >> (i & 7)) & 1);
         if (((i + 1) % 64) == 0)
             putchar ('\n');
         else if (((i + 1) % 8) == 0)
@@ -1355,8 +1366,10 @@ static void get_recv_data (urj_cable_t *cable, int32_t idx, int32_t idx_dat, uin
  * This function takes CABLE_TRANSFER todo data,
  * and adds it to the tms/tdi scan structure
  * If reading data, sets that up too
+ * If exit is set, TMS goes high with the last bit
  */
-static int add_scan_data (urj_cable_t *cable, int32_t num_bits, char *in, char *out)
+static int add_scan_data (urj_cable_t *cable, int32_t num_bits,
+                          const uint8_t *in, uint8_t *out, int exit)
 {
     params_t *cable_params = cable->params;
     int32_t bit_cnt  = num_bits % 8;
@@ -1453,10 +1466,12 @@ static int add_scan_data (urj_cable_t *cable, int32_t num_bits, char *in, char *
         tap_info->dat[tap_info->cur_dat].pos = bit_set;
     }
 
-    /* Build Scan.  TMS will always be zero! */
-    for (i = 0; i < num_bits; i++, in++)
+    /* Build Scan.  TMS is zero, except for the last bit on exit */
+    for (i = 0; i < num_bits; i++)
     {
-        tap_scan->tdi |= *in ? bit_set : 0;
+        tap_scan->tdi |= ((in[i >> 3] >> (i & 7)) & 1) ? bit_set : 0;
+        if (exit && i == num_bits - 1)
+            tap_scan->tms |= bit_set;
         bit_set >>= 1;
         if (!bit_set)
         {
@@ -1546,11 +1561,14 @@ static int build_clock_scan (urj_cable_t *cable, int32_t *start_idx, int32_t *nu
     bit_set = tap_info->bit_pos;
     scan_data = &ptr_todo->data[cur_idx];
 
-    for (n = *num_todo_items; (n < ptr_todo->num_items) && (scan_data->action == URJ_TAP_CABLE_CLOCK); n++)
+    for (n = *num_todo_items; (n < ptr_todo->num_items) && (scan_data->action == URJ_TAP_CABLE_CLOCK || scan_data->action == URJ_TAP_CABLE_CLOCK_COMPACT); n++)
     {   /* for each CABLE_CLOCK todo entry, create scan */
         for (i = 0; i < scan_data->arg.clock.n; i++)
         {
-            tap_scan->tms |= scan_data->arg.clock.tms ? bit_set : 0;
+            if (scan_data->action == URJ_TAP_CABLE_CLOCK_COMPACT)
+                tap_scan->tms |= ((scan_data->arg.clock.tms >> i) & 1) ? bit_set : 0;
+            else
+                tap_scan->tms |= scan_data->arg.clock.tms ? bit_set : 0;
             tap_scan->tdi |= scan_data->arg.clock.tdi ? bit_set : 0;
             bit_set >>= 1;
             if (!bit_set)
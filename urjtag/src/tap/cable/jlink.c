@@ -44,6 +44,7 @@
 
 #include <urjtag/cable.h>
 #include <urjtag/chain.h>
+#include <urjtag/tap_register.h>
 
 #include "usbconn/libusb.h"
 
@@ -545,46 +546,58 @@ jlink_get_tdo (urj_cable_t *cable)
 
 /* ---------------------------------------------------------------------- */
 
-static void
-jlink_copy_out_data (jlink_usbconn_data_t *data, int len, int offset,
-                     char *buf)
-{
-    int i;
-    for (i = 0; i < len; i++)
-    {
-        int bit = (1 << (i & 7));
-        int byte = i >> 3;
-        buf[offset + i] = (data->usb_in_buffer[byte] & bit) ? 1 : 0;
-    }
-}
-
+/* with exit set, TMS goes high on the last bit */
 static int
-jlink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+jlink_transfer_tms (urj_cable_t *cable, int len, const uint8_t *in,
+                    uint8_t *out, int exit)
 {
-    int i, j;
     urj_usbconn_libusb_param_t *params = cable->link.usb->params;
     jlink_usbconn_data_t *data = params->data;
+    int done = 0;
+
+    /* start on an empty tap buffer */
+    if (jlink_tap_execute (params) != 0)
+        return -1;
 
-    for (j = 0, i = 0; i < len; i++)
+    while (done < len)
     {
-        jlink_tap_append_step (data, 0, in[i]);
+        int n = len - done;
 
-        if (data->tap_length >= 8 * JLINK_TAP_BUFFER_SIZE)
+        if (n > 8 * JLINK_TAP_BUFFER_SIZE)
+            n = 8 * JLINK_TAP_BUFFER_SIZE;
+
+        /* TMS stays low but for an exit bit, TDI is taken over as is */
+        memset (data->tms_buffer, 0, (n + 7) >> 3);
+        if (exit && done + n == len)
+            data->tms_buffer[(n - 1) >> 3] |= 1 << ((n - 1) & 7);
+        urj_tap_bits_copy (data->tdi_buffer, 0, in, done, n);
+        data->tap_length = n;
+
+        if (jlink_tap_execute (params) != 0)
         {
-            jlink_tap_execute (params);
-            if (out)
-                jlink_copy_out_data (data, i - j, j, out);
-            j = i;
+            jlink_tap_init (data);
+            return -1;
         }
-    }
-    if (data->tap_length > 0)
-    {
-        jlink_tap_execute (params);
         if (out)
-            jlink_copy_out_data (data, i - j, j, out);
+            urj_tap_bits_copy (out, done, data->usb_in_buffer, 0, n);
+        done += n;
     }
 
-    return i;
+    return len;
+}
+
+static int
+jlink_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                       uint8_t *out)
+{
+    return jlink_transfer_tms (cable, len, in, out, 0);
+}
+
+static int
+jlink_transfer_exit (urj_cable_t *cable, int len, const uint8_t *in,
+                     uint8_t *out)
+{
+    return jlink_transfer_tms (cable, len, in, out, 1);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -607,10 +620,13 @@ const urj_cable_driver_t urj_tap_cable_jlink_driver = {
     urj_tap_cable_jlink_set_frequency,
     jlink_clock,
     jlink_get_tdo,
-    jlink_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     jlink_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_using_transfer,
-    urj_tap_cable_generic_usbconn_help
+    urj_tap_cable_generic_usbconn_help,
+    0,
+    jlink_transfer_packed,
+    jlink_transfer_exit
 };
 URJ_DECLARE_USBCONN_CABLE(0x1366, 0x0101, "libusb", "jlink", jlink)
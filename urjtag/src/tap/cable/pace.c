@@ -0,0 +1,141 @@
+/*
+ * $Id$
+ *
+ * TCK pacing for bit-banging cables.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <urjtag/fclock.h>
+
+#include "pace.h"
+
+#if defined HAVE_CLOCK_GETTIME && defined CLOCK_MONOTONIC
+#define PACE_MONOTONIC 1
+#endif
+
+/* waits are slept only when they exceed the wake-up latency by this much;
+   shorter ones poll the clock */
+#define PACE_SLEEP_MIN_NS       50000
+/* a gap this much longer than a half period means the cable was idle */
+#define PACE_IDLE_NS            1000000
+/* default measurement window of the achieved frequency */
+#define PACE_WINDOW_NS          250000000
+
+uint64_t
+urj_tap_cable_pace_now (void)
+{
+#ifdef PACE_MONOTONIC
+    struct timespec t;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &t) == 0)
+        return (uint64_t) t.tv_sec * 1000000000 + t.tv_nsec;
+#endif
+    return urj_lib_frealtime () * 1e9;
+}
+
+static void
+pace_sleep_until (uint64_t deadline)
+{
+#if defined PACE_MONOTONIC && defined HAVE_CLOCK_NANOSLEEP && defined TIMER_ABSTIME
+    struct timespec t;
+
+    t.tv_sec = deadline / 1000000000;
+    t.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+        ;
+#else
+    uint64_t now = urj_tap_cable_pace_now ();
+
+    if (deadline > now)
+        usleep ((deadline - now) / 1000);
+#endif
+}
+
+void
+urj_tap_cable_pace_set (urj_cable_t *cable, uint32_t frequency)
+{
+    urj_cable_pace_t *pace = &cable->pace;
+
+    /* round up so TCK never runs faster than requested */
+    pace->half_period = frequency
+        ? (500000000 + (uint64_t) frequency - 1) / frequency : 0;
+    pace->last = 0;
+    if (pace->window == 0)
+        pace->window = PACE_WINDOW_NS;
+    pace->window_waits = 0;
+
+    cable->frequency = frequency;
+}
+
+void
+urj_tap_cable_pace_wait (urj_cable_t *cable)
+{
+    urj_cable_pace_t *pace = &cable->pace;
+    uint64_t now, deadline;
+
+    if (pace->half_period == 0)
+        return;
+
+    now = urj_tap_cable_pace_now ();
+    deadline = pace->last + pace->half_period;
+
+    if (pace->last == 0
+        || now > deadline + pace->half_period + PACE_IDLE_NS)
+    {
+        /* first wait or the cable was idle, measure from here on */
+        pace->window_start = now;
+        pace->window_waits = 0;
+    }
+
+    /* when the port is slower than the half period there is no debt to
+       catch up, the deadline just moves along */
+    if (deadline < now)
+        deadline = now;
+
+    if (deadline > now + pace->latency + PACE_SLEEP_MIN_NS)
+    {
+        uint64_t wake = deadline - pace->latency;
+
+        pace_sleep_until (wake);
+        now = urj_tap_cable_pace_now ();
+
+        /* keep track of how late the sleep call returns */
+        pace->latency = (pace->latency * 7 + (now > wake ? now - wake : 0)) / 8;
+    }
+
+    while (now < deadline)
+        now = urj_tap_cable_pace_now ();
+
+    pace->last = now;
+    pace->window_waits++;
+
+    if (now - pace->window_start >= pace->window)
+    {
+        cable->frequency = (uint64_t) pace->window_waits * 500000000
+            / (now - pace->window_start);
+        pace->window_start = now;
+        pace->window_waits = 0;
+    }
+}
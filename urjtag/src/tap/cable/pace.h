@@ -0,0 +1,42 @@
+/*
+ * $Id$
+ *
+ * TCK pacing for bit-banging cables.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef URJ_TAP_CABLE_PACE_H
+#define URJ_TAP_CABLE_PACE_H
+
+#include <urjtag/cable.h>
+
+/**
+ * Set the half period of urj_tap_cable_wait() for the TCK frequency and
+ * restart the measurement; 0 disables pacing.  cable->frequency is set to
+ * the requested frequency until a measurement is available.
+ */
+void urj_tap_cable_pace_set (urj_cable_t *cable, uint32_t frequency);
+/**
+ * Wait for the next half period deadline.  Every measurement window the
+ * achieved frequency is stored in cable->frequency.
+ */
+void urj_tap_cable_pace_wait (urj_cable_t *cable);
+/** @return monotonic time in ns */
+uint64_t urj_tap_cable_pace_now (void);
+
+#endif /* URJ_TAP_CABLE_PACE_H */
@@ -175,7 +175,6 @@ ts7800_connect (urj_cable_t *cable, const urj_param_t *params[])
 
     cable->params = cable_params;
     cable->chain = NULL;
-    cable->delay = 1000;
 
     return URJ_STATUS_OK;
 }
@@ -120,7 +120,9 @@ usbblaster_init (urj_cable_t *cable)
     for (i = 0; i < 64; i++)
         urj_tap_cable_cx_cmd_push (cmd_root, 0);
 
-    urj_tap_cable_cx_xfer (cmd_root, NULL, cable, URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (cmd_root, NULL, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
 
     usbblaster_set_frequency (cable, FIXED_FREQUENCY);
 
@@ -235,8 +237,9 @@ usbblaster_get_tdo (urj_cable_t *cable)
     params_t *params = cable->params;
 
     usbblaster_get_tdo_schedule (cable);
-    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
     return usbblaster_get_tdo_finish (cable);
 }
 
@@ -246,9 +249,10 @@ usbblaster_set_signal (urj_cable_t *cable, int mask, int val)
     return 1;
 }
 
+/* with exit set, TMS goes high on the last bit */
 static void
-usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
-                              char *out)
+usbblaster_transfer_schedule (urj_cable_t *cable, int len, const uint8_t *in,
+                              uint8_t *out, int exit)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
@@ -262,15 +266,17 @@ usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
         int o;
         urj_log (URJ_LOG_LEVEL_COMM, "%d in: ", len);
         for (o = 0; o < len; o++)
-            urj_log (URJ_LOG_LEVEL_COMM, "%c", in[o] ? '1' : '0');
+            urj_log (URJ_LOG_LEVEL_COMM, "%c",
+                     ((in[o >> 3] >> (o & 7)) & 1) ? '1' : '0');
         urj_log (URJ_LOG_LEVEL_COMM, "\n");
     }
 #endif
 
-    while (len - in_offset >= 8)
+    /* byte shift mode cannot drive TMS, keep the exit bit out of it */
+    while (len - exit - in_offset >= 8)
     {
         int i;
-        int chunkbytes = ((len - in_offset) >> 3);
+        int chunkbytes = ((len - exit - in_offset) >> 3);
         if (chunkbytes > 63)
             chunkbytes = 63;
 
@@ -289,32 +295,32 @@ usbblaster_transfer_schedule (urj_cable_t *cable, int len, const char *in,
                                        chunkbytes);
         }
 
+        /* in_offset is byte aligned here */
         for (i = 0; i < chunkbytes; i++)
         {
-            int j;
-            unsigned char b = 0;
-            for (j = 1; j < 256; j <<= 1)
-                if (in[in_offset++])
-                    b |= j;
-            urj_tap_cable_cx_cmd_push (cmd_root, b);
+            urj_tap_cable_cx_cmd_push (cmd_root, in[in_offset >> 3]);
+            in_offset += 8;
         }
     }
 
     while (len > in_offset)
     {
-        char tdi = in[in_offset++] ? 1 : 0;
+        int tdi = (in[in_offset >> 3] >> (in_offset & 7)) & 1;
+        int tms = (exit && in_offset == len - 1) ? (1 << TMS) : 0;
 
+        in_offset++;
         urj_tap_cable_cx_cmd_queue (cmd_root, out ? 1 : 0);
-        urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | (tdi << TDI));    /* TCK low */
+        urj_tap_cable_cx_cmd_push (cmd_root, OTHERS | tms | (tdi << TDI));    /* TCK low */
         urj_tap_cable_cx_cmd_push (cmd_root,
                                    OTHERS | ((out) ? (1 << READ) : 0) | (1 <<
                                                                          TCK)
-                                   | (tdi << TDI));
+                                   | tms | (tdi << TDI));
     }
 }
 
 static int
-usbblaster_transfer_finish (urj_cable_t *cable, int len, char *out)
+usbblaster_transfer_finish (urj_cable_t *cable, int len, uint8_t *out,
+                            int exit)
 {
     params_t *params = cable->params;
     urj_tap_cable_cx_cmd_root_t *cmd_root = &params->cmd_root;
@@ -323,42 +329,51 @@ usbblaster_transfer_finish (urj_cable_t *cable, int len, char *out)
     if (out == NULL)
         return 0;
 
-    while (len - out_offset >= 8)
+    while (len - exit - out_offset >= 8)
     {
         int i;
-        int chunkbytes = ((len - out_offset) >> 3);
+        int chunkbytes = ((len - exit - out_offset) >> 3);
         if (chunkbytes > 63)
             chunkbytes = 63;
 
         if (out)
         {
-            urj_tap_cable_cx_xfer (cmd_root, NULL, cable,
-                                   URJ_TAP_CABLE_COMPLETELY);
+            if (urj_tap_cable_cx_xfer (cmd_root, NULL, cable,
+                                       URJ_TAP_CABLE_COMPLETELY)
+                != URJ_STATUS_OK)
+                return -1;
 
             for (i = 0; i < chunkbytes; i++)
             {
-                int j;
                 unsigned char b = urj_tap_cable_cx_xfer_recv (cable);
 #if 0
                 urj_log (URJ_LOG_LEVEL_COMM, "read byte: %02X\n", b);
 #endif
 
-                for (j = 1; j < 256; j <<= 1)
-                    out[out_offset++] = (b & j) ? 1 : 0;
+                out[out_offset >> 3] = b;
+                out_offset += 8;
             }
         }
     }
 
     while (len > out_offset)
-        out[out_offset++] =
-            (urj_tap_cable_cx_xfer_recv (cable) & (1 << TDO)) ? 1 : 0;
+    {
+        uint8_t bit = 1 << (out_offset & 7);
+
+        if (urj_tap_cable_cx_xfer_recv (cable) & (1 << TDO))
+            out[out_offset >> 3] |= bit;
+        else
+            out[out_offset >> 3] &= ~bit;
+        out_offset++;
+    }
 
 #if 0
     {
         int o;
         urj_log (URJ_LOG_LEVEL_COMM, "%d out: ", len);
         for (o = 0; o < len; o++)
-            urj_log (URJ_LOG_LEVEL_COMM, "%c", out[o] ? '1' : '0');
+            urj_log (URJ_LOG_LEVEL_COMM, "%c",
+                     ((out[o >> 3] >> (o & 7)) & 1) ? '1' : '0');
         urj_log (URJ_LOG_LEVEL_COMM, "\n");
     }
 #endif
@@ -367,14 +382,29 @@ usbblaster_transfer_finish (urj_cable_t *cable, int len, char *out)
 }
 
 static int
-usbblaster_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+usbblaster_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                            uint8_t *out)
 {
     params_t *params = cable->params;
 
-    usbblaster_transfer_schedule (cable, len, in, out);
-    urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
-                           URJ_TAP_CABLE_COMPLETELY);
-    return usbblaster_transfer_finish (cable, len, out);
+    usbblaster_transfer_schedule (cable, len, in, out, 0);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
+    return usbblaster_transfer_finish (cable, len, out, 0);
+}
+
+static int
+usbblaster_transfer_exit (urj_cable_t *cable, int len, const uint8_t *in,
+                          uint8_t *out)
+{
+    params_t *params = cable->params;
+
+    usbblaster_transfer_schedule (cable, len, in, out, 1);
+    if (urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
+                               URJ_TAP_CABLE_COMPLETELY) != URJ_STATUS_OK)
+        return -1;
+    return usbblaster_transfer_finish (cable, len, out, 1);
 }
 
 static void
@@ -391,6 +421,7 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
     while (cable->todo.num_items > 0)
     {
         int i, j, n;
+        int status;
 
         for (j = i = cable->todo.next_item, n = 0; n < cable->todo.num_items;
              n++)
@@ -405,6 +436,19 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                                            cable->todo.data[i].arg.clock.n);
                 break;
 
+            case URJ_TAP_CABLE_CLOCK_COMPACT:
+                {
+                    int k;
+
+                    for (k = 0; k < cable->todo.data[i].arg.clock.n; k++)
+                        usbblaster_clock_schedule (cable,
+                                                   (cable->todo.data[i].arg.
+                                                    clock.tms >> k) & 1,
+                                                   cable->todo.data[i].arg.
+                                                   clock.tdi, 1);
+                    break;
+                }
+
             case URJ_TAP_CABLE_GET_TDO:
                 usbblaster_get_tdo_schedule (cable);
                 break;
@@ -416,7 +460,9 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                                               cable->todo.data[i].arg.
                                               transfer.in,
                                               cable->todo.data[i].arg.
-                                              transfer.out);
+                                              transfer.out,
+                                              cable->todo.data[i].arg.
+                                              transfer.exit);
                 break;
 
             default:
@@ -428,7 +474,8 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 i = 0;
         }
 
-        urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable, how_much);
+        status = urj_tap_cable_cx_xfer (&params->cmd_root, NULL, cable,
+                                        how_much);
 
         while (j != i)
         {
@@ -439,6 +486,7 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     int m;
                     m = urj_tap_cable_add_queue_item (cable, &cable->done);
                     cable->done.data[m].action = URJ_TAP_CABLE_GET_TDO;
+                    cable->done.data[m].ticket = cable->todo.data[j].ticket;
                     cable->done.data[m].arg.value.val =
                         usbblaster_get_tdo_finish (cable);
                     break;
@@ -448,6 +496,7 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                     int m =
                         urj_tap_cable_add_queue_item (cable, &cable->done);
                     cable->done.data[m].action = URJ_TAP_CABLE_GET_SIGNAL;
+                    cable->done.data[m].ticket = cable->todo.data[j].ticket;
                     cable->done.data[m].arg.value.sig =
                         cable->todo.data[j].arg.value.sig;
                     if (cable->todo.data[j].arg.value.sig == URJ_POD_CS_TRST)
@@ -458,12 +507,22 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                 }
             case URJ_TAP_CABLE_TRANSFER:
                 {
-                    int r = usbblaster_transfer_finish (cable,
+                    int r;
+
+                    /* a failed write fails the transfers queued with it */
+                    if (status != URJ_STATUS_OK)
+                        r = -1;
+                    else
+                        r = usbblaster_transfer_finish (cable,
                                                         cable->todo.data[j].
                                                         arg.transfer.len,
                                                         cable->todo.data[j].
-                                                        arg.transfer.out);
-                    free (cable->todo.data[j].arg.transfer.in);
+                                                        arg.transfer.out,
+                                                        cable->todo.data[j].
+                                                        arg.transfer.exit);
+                    urj_tap_cable_release_payload (&cable->todo,
+                                                   cable->todo.data[j].arg.
+                                                   transfer.in);
                     if (cable->todo.data[j].arg.transfer.out)
                     {
                         int m = urj_tap_cable_add_queue_item (cable,
@@ -474,6 +533,8 @@ usbblaster_flush (urj_cable_t *cable, urj_cable_flush_amount_t how_much)
                             // urj_log (URJ_LOG_LEVEL_NORMAL, "out of memory!\n");
                         }
                         cable->done.data[m].action = URJ_TAP_CABLE_TRANSFER;
+                        cable->done.data[m].ticket =
+                            cable->todo.data[j].ticket;
                         cable->done.data[m].arg.xferred.len =
                             cable->todo.data[j].arg.transfer.len;
                         cable->done.data[m].arg.xferred.res = r;
@@ -507,13 +568,16 @@ const urj_cable_driver_t urj_tap_cable_usbblaster_driver = {
     usbblaster_set_frequency,
     usbblaster_clock,
     usbblaster_get_tdo,
-    usbblaster_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     usbblaster_set_signal,
     urj_tap_cable_generic_get_signal,
 //      urj_tap_cable_generic_flush_one_by_one,
 //      urj_tap_cable_generic_flush_using_transfer,
     usbblaster_flush,
-    ftdx_usbcable_help
+    ftdx_usbcable_help,
+    0,
+    usbblaster_transfer_packed,
+    usbblaster_transfer_exit
 };
 URJ_DECLARE_FTDX_CABLE(0x09FB, 0x6001, "", "UsbBlaster", usbblaster)
 URJ_DECLARE_FTDX_CABLE(0x09FB, 0x6002, "", "UsbBlaster", cubic_cyclonium)
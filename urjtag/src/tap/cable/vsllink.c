@@ -37,6 +37,7 @@
 
 #include <urjtag/cable.h>
 #include <urjtag/chain.h>
+#include <urjtag/tap_register.h>
 
 #include "usbconn/libusb.h"
 
@@ -507,46 +508,58 @@ vsllink_get_tdo (urj_cable_t *cable)
 
 /* ---------------------------------------------------------------------- */
 
-static void
-vsllink_copy_out_data (vsllink_usbconn_data_t *data, int len, int offset,
-                       char *buf)
-{
-    int i;
-    for (i = 0; i < len; i++)
-    {
-        int bit = (1 << (i & 7));
-        int byte = i >> 3;
-        buf[offset + i] = (data->usb_buffer[1 + byte] & bit) ? 1 : 0;
-    }
-}
-
+/* with exit set, TMS goes high on the last bit */
 static int
-vsllink_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+vsllink_transfer_tms (urj_cable_t *cable, int len, const uint8_t *in,
+                      uint8_t *out, int exit)
 {
-    int i, j;
     urj_usbconn_libusb_param_t *params = cable->link.usb->params;
     vsllink_usbconn_data_t *data = params->data;
+    int done = 0;
+
+    /* start on an empty tap buffer */
+    if (vsllink_tap_execute (params) != URJ_STATUS_OK)
+        return -1;
 
-    for (j = 0, i = 0; i < len; i++)
+    while (done < len)
     {
-        vsllink_tap_append_step (data, 0, in[i]);
+        int n = len - done;
 
-        if (data->tap_length >= 8 * data->tap_buffer_size)
+        if (n > 8 * data->tap_buffer_size)
+            n = 8 * data->tap_buffer_size;
+
+        /* TMS stays low but for an exit bit, TDI is taken over as is */
+        memset (data->tms_buffer, 0, (n + 7) >> 3);
+        if (exit && done + n == len)
+            data->tms_buffer[(n - 1) >> 3] |= 1 << ((n - 1) & 7);
+        urj_tap_bits_copy (data->tdi_buffer, 0, in, done, n);
+        data->tap_length = n;
+
+        if (vsllink_tap_execute (params) != URJ_STATUS_OK)
         {
-            vsllink_tap_execute (params);
-            if (out)
-                vsllink_copy_out_data (data, i - j, j, out);
-            j = i;
+            data->tap_length = 0;
+            return -1;
         }
-    }
-    if (data->tap_length > 0)
-    {
-        vsllink_tap_execute (params);
         if (out)
-            vsllink_copy_out_data (data, i - j, j, out);
+            urj_tap_bits_copy (out, done, data->usb_buffer + 1, 0, n);
+        done += n;
     }
 
-    return i;
+    return len;
+}
+
+static int
+vsllink_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                         uint8_t *out)
+{
+    return vsllink_transfer_tms (cable, len, in, out, 0);
+}
+
+static int
+vsllink_transfer_exit (urj_cable_t *cable, int len, const uint8_t *in,
+                       uint8_t *out)
+{
+    return vsllink_transfer_tms (cable, len, in, out, 1);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -569,10 +582,13 @@ const urj_cable_driver_t urj_tap_cable_vsllink_driver = {
     vsllink_set_frequency,
     vsllink_clock,
     vsllink_get_tdo,
-    vsllink_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     vsllink_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_using_transfer,
-    urj_tap_cable_generic_usbconn_help
+    urj_tap_cable_generic_usbconn_help,
+    0,
+    vsllink_transfer_packed,
+    vsllink_transfer_exit
 };
 URJ_DECLARE_USBCONN_CABLE (0x0483, 0x5740, "libusb", "vsllink", vsllink)
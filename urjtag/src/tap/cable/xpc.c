@@ -578,7 +578,12 @@ xpcu_do_ext_transfer (xpc_ext_transfer_state_t *xts)
             while (mask <= 32768 && out_rem > 0)
             {
                 last_tdo = (rxw & mask) ? 1 : 0;
-                xts->out[xts->out_done] = last_tdo;
+                /* out holds packed bits */
+                if (last_tdo)
+                    xts->out[xts->out_done >> 3] |= 1 << (xts->out_done & 7);
+                else
+                    xts->out[xts->out_done >> 3] &=
+                        ~(1 << (xts->out_done & 7));
                 xts->out_done++;
                 mask <<= 1;
                 out_rem--;
@@ -599,8 +604,8 @@ xpcu_do_ext_transfer (xpc_ext_transfer_state_t *xts)
 /* ---------------------------------------------------------------------- */
 
 static void
-xpcu_add_bit_for_ext_transfer (xpc_ext_transfer_state_t *xts, char in,
-                               char is_real)
+xpcu_add_bit_for_ext_transfer (xpc_ext_transfer_state_t *xts, int in,
+                               int is_real)
 {
     int bit_idx = (xts->in_bits & 3);
     int buf_idx = (xts->in_bits - bit_idx) >> 1;
@@ -638,7 +643,8 @@ xpcu_add_bit_for_ext_transfer (xpc_ext_transfer_state_t *xts, char in,
 
 /** @return 0 on success; -1 on error */
 static int
-xpc_ext_transfer (urj_cable_t *cable, int len, const char *in, char *out)
+xpc_ext_transfer_packed (urj_cable_t *cable, int len, const uint8_t *in,
+                         uint8_t *out)
 {
     int i, j;
     xpc_ext_transfer_state_t xts;
@@ -649,13 +655,14 @@ xpc_ext_transfer (urj_cable_t *cable, int len, const char *in, char *out)
             (out != NULL) ? "with" : "without");
     urj_log (URJ_LOG_LEVEL_DETAIL, "tdi: ");
     for (i = 0; i < len; i++)
-        urj_log (URJ_LOG_LEVEL_DETAIL, "%c", in[i] ? '1' : '0');
+        urj_log (URJ_LOG_LEVEL_DETAIL, "%c",
+                 ((in[i >> 3] >> (i & 7)) & 1) ? '1' : '0');
     urj_log (URJ_LOG_LEVEL_DETAIL, "\n");
 #endif
 
     xts.xpcu =
         ((urj_usbconn_libusb_param_t *) (cable->link.usb->params))->handle;
-    xts.out = (uint8_t *) out;
+    xts.out = out;
     xts.in_bits = 0;
     xts.out_bits = 0;
     xts.out_done = 0;
@@ -663,7 +670,7 @@ xpc_ext_transfer (urj_cable_t *cable, int len, const char *in, char *out)
 
     for (i = 0, j = 0; i < len && j >= 0; i++)
     {
-        xpcu_add_bit_for_ext_transfer (&xts, in[i], 1);
+        xpcu_add_bit_for_ext_transfer (&xts, (in[i >> 3] >> (i & 7)) & 1, 1);
         if (xts.in_bits == (4 * XPC_A6_CHUNKSIZE - 1))
         {
             j = xpcu_do_ext_transfer (&xts);
@@ -718,10 +725,12 @@ const urj_cable_driver_t urj_tap_cable_xpc_ext_driver = {
     urj_tap_cable_generic_set_frequency,
     xpc_ext_clock,
     xpc_ext_get_tdo,
-    xpc_ext_transfer,
+    urj_tap_cable_generic_transfer_unpacked,
     xpc_set_signal,
     urj_tap_cable_generic_get_signal,
     urj_tap_cable_generic_flush_using_transfer,
-    urj_tap_cable_generic_usbconn_help
+    urj_tap_cable_generic_usbconn_help,
+    0,
+    xpc_ext_transfer_packed
 };
 URJ_DECLARE_USBCONN_CABLE(0x03FD, 0x0008, "libusb", "xpc_ext", xpc_ext)
@@ -32,6 +32,7 @@
 #include <urjtag/part_instruction.h>
 #include <urjtag/tap_state.h>
 #include <urjtag/tap.h>
+#include <urjtag/tap_register.h>
 #include <urjtag/data_register.h>
 #include <urjtag/cmd.h>
 #include <urjtag/bsdl.h>
@@ -53,6 +54,10 @@ urj_tap_chain_alloc (void)
     chain->parts = NULL;
     chain->total_instr_len = 0;
     chain->active_part = 0;
+    chain->scan_in[0] = chain->scan_in[1] = NULL;
+    chain->scan_out[0] = chain->scan_out[1] = NULL;
+    chain->deferred = NULL;
+    chain->deferred_first = chain->deferred_len = chain->deferred_max = 0;
     URJ_BSDL_GLOBS_INIT (chain->bsdl);
     urj_tap_state_init (chain);
 
@@ -62,12 +67,25 @@ urj_tap_chain_alloc (void)
 void
 urj_tap_chain_free (urj_chain_t *chain)
 {
+    int i;
+
     if (!chain)
         return;
 
     urj_tap_chain_disconnect (chain);
 
     urj_part_parts_free (chain->parts);
+    for (i = 0; i < 2; i++)
+    {
+        urj_tap_register_free (chain->scan_in[i]);
+        urj_tap_register_free (chain->scan_out[i]);
+    }
+    for (i = 0; i < chain->deferred_max; i++)
+    {
+        urj_tap_register_free (chain->deferred[i].in);
+        urj_tap_register_free (chain->deferred[i].out);
+    }
+    free (chain->deferred);
     free (chain);
 }
 
@@ -161,6 +179,9 @@ urj_tap_chain_disconnect (urj_chain_t *chain)
     if (!chain->cable)
         return;
 
+    /* the results of deferred scans go away with the cable */
+    chain->deferred_first = chain->deferred_len = 0;
+
     urj_tap_state_done (chain);
     urj_tap_cable_done (chain->cable);
     urj_tap_cable_free (chain->cable);
@@ -242,6 +263,122 @@ urj_tap_chain_get_pod_signal (urj_chain_t *chain, urj_pod_sigsel_t sig)
     return urj_tap_cable_get_signal (chain->cable, sig);
 }
 
+/* the register a part shifts in an IR (dr == 0) or DR (dr == 1) scan */
+static urj_tap_register_t *
+part_scan_register (urj_part_t *part, int dr, int out)
+{
+    urj_part_instruction_t *insn = part->active_instruction;
+
+    if (dr)
+        return out ? insn->data_register->out : insn->data_register->in;
+
+    return out ? insn->out : insn->value;
+}
+
+/* resize one of the chain's scratch registers to len bits */
+static urj_tap_register_t *
+chain_scratch (urj_tap_register_t **tr, int len)
+{
+    urj_tap_register_t *r;
+
+    if (*tr != NULL && (*tr)->len == len)
+        return *tr;
+
+    r = urj_tap_register_realloc (*tr, len);
+    if (r != NULL)
+        *tr = r;
+
+    return r;
+}
+
+/* total length of the registers the parts shift */
+static int
+chain_scan_length (urj_chain_t *chain, int dr)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, total;
+
+    for (i = total = 0; i < ps->len; i++)
+        total += part_scan_register (ps->parts[i], dr, 0)->len;
+
+    return total;
+}
+
+/* concatenate the registers the parts shift in */
+static void
+chain_gather (urj_chain_t *chain, int dr, urj_tap_register_t *in)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, pos;
+
+    for (i = pos = 0; i < ps->len; i++)
+    {
+        const urj_tap_register_t *r = part_scan_register (ps->parts[i], dr, 0);
+
+        if (r->len == 1)
+            urj_tap_register_set_bit (in, pos, urj_tap_register_get_bit (r, 0));
+        else
+            urj_tap_bits_copy (in->packed, pos, r->packed, 0, r->len);
+        pos += r->len;
+    }
+}
+
+/* split the captured bits into the output registers of the parts */
+static void
+chain_scatter (urj_chain_t *chain, int dr, const urj_tap_register_t *out)
+{
+    urj_parts_t *ps = chain->parts;
+    int i, pos;
+
+    for (i = pos = 0; i < ps->len; i++)
+    {
+        int len = part_scan_register (ps->parts[i], dr, 0)->len;
+        urj_tap_register_t *r = part_scan_register (ps->parts[i], dr, 1);
+
+        if (r != NULL && r->len == 1)
+            urj_tap_register_set_bit (r, 0, urj_tap_register_get_bit (out, pos));
+        else if (r != NULL)
+            urj_tap_bits_copy (r->packed, 0, out->packed, pos,
+                               len < r->len ? len : r->len);
+        pos += len;
+    }
+}
+
+/*
+ * Shift the registers of all parts in a single scan: part 0 is nearest to
+ * TDO and goes first, the TMS exit is on the last bit of the last part.
+ * One-bit registers (BYPASS) are moved bit-wise instead of being copied.
+ */
+static int
+chain_shift_parts (urj_chain_t *chain, int dr, int capture_output,
+                   int chain_exit)
+{
+    urj_tap_register_t *in, *out;
+    int total = chain_scan_length (chain, dr);
+
+    in = chain_scratch (&chain->scan_in[dr], total);
+    out = chain_scratch (&chain->scan_out[dr], total);
+    if (in == NULL || out == NULL)
+        return URJ_STATUS_FAIL;
+
+    chain_gather (chain, dr, in);
+
+    urj_tap_defer_shift_register (chain, in, capture_output ? out : NULL,
+                                  chain_exit);
+
+    if (!capture_output)
+    {
+        /* give the cable driver a chance to flush if it's considered useful */
+        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        return URJ_STATUS_OK;
+    }
+
+    urj_tap_shift_register_output (chain, in, out, chain_exit);
+    chain_scatter (chain, dr, out);
+
+    return URJ_STATUS_OK;
+}
+
 int
 urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
                                        int capture_output, int capture,
@@ -271,36 +408,7 @@ urj_tap_chain_shift_instructions_mode (urj_chain_t *chain,
     if (capture)
         urj_tap_capture_ir (chain);
 
-    /* new implementation: split into defer + retrieve part
-       shift the data register of each part in the chain one by one */
-
-    for (i = 0; i < ps->len; i++)
-    {
-        urj_tap_defer_shift_register (chain,
-                ps->parts[i]->active_instruction->value,
-                capture_output ? ps->parts[i]->active_instruction->out
-                    : NULL,
-                (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-    }
-
-    if (capture_output)
-    {
-        for (i = 0; i < ps->len; i++)
-        {
-            urj_tap_shift_register_output (chain,
-                    ps->parts[i]->active_instruction->value,
-                    ps->parts[i]->active_instruction->out,
-                    (i + 1) == ps->len ? chain_exit
-                        : URJ_CHAIN_EXITMODE_SHIFT);
-        }
-    }
-    else
-    {
-        /* give the cable driver a chance to flush if it's considered useful */
-        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
-    }
-
-    return URJ_STATUS_OK;
+    return chain_shift_parts (chain, 0, capture_output, chain_exit);
 }
 
 int
@@ -310,10 +418,9 @@ urj_tap_chain_shift_instructions (urj_chain_t *chain)
                                                   URJ_CHAIN_EXITMODE_IDLE);
 }
 
-int
-urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
-                                         int capture_output, int capture,
-                                         int chain_exit)
+/** @return URJ_STATUS_OK if all parts have a data register to shift */
+static int
+chain_check_data_registers (urj_chain_t *chain)
 {
     int i;
     urj_parts_t *ps;
@@ -342,46 +449,118 @@ urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
         }
     }
 
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_chain_shift_data_registers_mode (urj_chain_t *chain,
+                                         int capture_output, int capture,
+                                         int chain_exit)
+{
+    if (chain_check_data_registers (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
     if (capture)
         urj_tap_capture_dr (chain);
 
-    /* new implementation: split into defer + retrieve part
-       shift the data register of each part in the chain one by one */
+    return chain_shift_parts (chain, 1, capture_output, chain_exit);
+}
 
-    for (i = 0; i < ps->len; i++)
-    {
-        urj_tap_defer_shift_register (chain,
-                ps->parts[i]->active_instruction->data_register->in,
-                capture_output ?
-                    ps->parts[i]->active_instruction->data_register->out
-                    : NULL,
-                (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-    }
+int
+urj_tap_chain_shift_data_registers (urj_chain_t *chain, int capture_output)
+{
+    return urj_tap_chain_shift_data_registers_mode (chain, capture_output, 1,
+                                                    URJ_CHAIN_EXITMODE_IDLE);
+}
 
-    if (capture_output)
-    {
-        for (i = 0; i < ps->len; i++)
-        {
-            urj_tap_shift_register_output (chain,
-                    ps->parts[i]->active_instruction->data_register->in,
-                    ps->parts[i]->active_instruction->data_register->out,
-                    (i + 1) == ps->len ? chain_exit : URJ_CHAIN_EXITMODE_SHIFT);
-        }
-    }
-    else
+/* make room for one more deferred scan, keeping the order of the ring */
+static int
+chain_deferred_grow (urj_chain_t *chain)
+{
+    int max = chain->deferred_max ? 2 * chain->deferred_max : 16;
+    urj_chain_deferred_t *d;
+    int i;
+
+    d = calloc (max, sizeof *d);
+    if (d == NULL)
     {
-        /* give the cable driver a chance to flush if it's considered useful */
-        urj_tap_cable_flush (chain->cable, URJ_TAP_CABLE_TO_OUTPUT);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd,%zd) fails"),
+                       (size_t) max, sizeof *d);
+        return URJ_STATUS_FAIL;
     }
 
+    for (i = 0; i < chain->deferred_max; i++)
+        d[i] = chain->deferred[(chain->deferred_first + i)
+                               & (chain->deferred_max - 1)];
+    free (chain->deferred);
+
+    chain->deferred = d;
+    chain->deferred_first = 0;
+    chain->deferred_max = max;
+
     return URJ_STATUS_OK;
 }
 
 int
-urj_tap_chain_shift_data_registers (urj_chain_t *chain, int capture_output)
+urj_tap_chain_defer_data_registers (urj_chain_t *chain, int capture,
+                                    int chain_exit)
 {
-    return urj_tap_chain_shift_data_registers_mode (chain, capture_output, 1,
-                                                    URJ_CHAIN_EXITMODE_IDLE);
+    urj_chain_deferred_t *d;
+    int total;
+
+    if (chain_check_data_registers (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    if (chain->deferred_len == chain->deferred_max
+        && chain_deferred_grow (chain) != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    /* each slot has registers of its own, they stay with the cable until
+       the scan is collected */
+    d = &chain->deferred[(chain->deferred_first + chain->deferred_len)
+                         & (chain->deferred_max - 1)];
+    total = chain_scan_length (chain, 1);
+    if (chain_scratch (&d->in, total) == NULL
+        || chain_scratch (&d->out, total) == NULL)
+        return URJ_STATUS_FAIL;
+
+    chain_gather (chain, 1, d->in);
+
+    if (capture)
+        urj_tap_capture_dr (chain);
+
+    d->ticket = urj_tap_defer_shift_register_ticket (chain, d->in, d->out,
+                                                     chain_exit);
+    if (d->ticket == URJ_CABLE_NO_TICKET)
+        return URJ_STATUS_FAIL;
+    chain->deferred_len++;
+
+    return URJ_STATUS_OK;
+}
+
+int
+urj_tap_chain_collect_data_registers (urj_chain_t *chain)
+{
+    urj_chain_deferred_t *d;
+
+    if (chain->deferred_len == 0)
+    {
+        urj_error_set (URJ_ERROR_ILLEGAL_STATE,
+                       _("no deferred data register scan"));
+        return URJ_STATUS_FAIL;
+    }
+
+    d = &chain->deferred[chain->deferred_first];
+    chain->deferred_first = (chain->deferred_first + 1)
+        & (chain->deferred_max - 1);
+    chain->deferred_len--;
+
+    if (urj_tap_cable_ticket_wait (chain->cable, d->ticket) < 0)
+        return URJ_STATUS_FAIL;
+
+    chain_scatter (chain, 1, d->out);
+
+    return URJ_STATUS_OK;
 }
 
 void
@@ -45,132 +45,30 @@
 #include <urjtag/data_register.h>
 #include <urjtag/parse.h>
 #include <urjtag/jtag.h>
+#include <urjtag/partdb.h>
 
+#define strncat_const(dst, src) strncat(dst, src, sizeof(dst) - strlen(dst) - 1)
+
+/*
+ * Look up a record in the index while it covers the text table filename
+ * and has the record; otherwise search the text table and, as the index
+ * may disagree with it, do without the index for the rest of the part.
+ * @return 1 if found; 0 otherwise
+ */
 static int
-find_record (char *filename, urj_tap_register_t *key,
-             char **id_name, char **id_fullname)
+detect_find_record (const urj_partdb_t **db, urj_partdb_level_t level,
+                    uint32_t id, const char *filename,
+                    const urj_tap_register_t *key, char **name,
+                    char **fullname)
 {
-    FILE *file;
-    urj_tap_register_t *tr;
-    int r = 0;
-    char *line = NULL;
-    size_t len;
-
-    free (*id_name);
-    free (*id_fullname);
-    *id_name = *id_fullname = NULL;
-
-    file = fopen (filename, FOPEN_R);
-    if (!file)
-    {
-        urj_log (URJ_LOG_LEVEL_ERROR, _("Unable to open file '%s'\n"), filename);
-        urj_error_IO_set ("Unable to open file '%s'", filename);
-        return r;
-    }
-
-    tr = urj_tap_register_alloc (key->len);
-
-    for (;;)
-    {
-        char *p;
-        char *s;
-
-        if (getline (&line, &len, file) == -1)
-            break;
-
-        /* remove comment and nl from the line */
-        p = strpbrk (line, "#\n");
-        if (p)
-            *p = '\0';
-
-        p = line;
-
-        /* skip whitespace */
-        while (*p && isspace (*p))
-            p++;
-
-        /* remove ending whitespace */
-        s = strchr (p, '\0');
-        while (s != p)
-        {
-            if (!isspace (*--s))
-                break;
-            *s = '\0';
-        }
-
-        /* line is empty? */
-        if (!*p)
-            continue;
-
-        /* find end of field */
-        s = p;
-        while (*s && !isspace (*s))
-            s++;
-        if (*s)
-            *s++ = '\0';
-
-        /* test field length */
-        if (strlen (p) != key->len)
-            continue;
+    if (*db != NULL && urj_tap_partdb_current (*db, filename)
+        && urj_tap_partdb_lookup (*db, level, id, name, fullname))
+        return 1;
 
-        /* match */
-        urj_tap_register_init (tr, p);
-        if (urj_tap_register_compare (tr, key))
-            continue;
-
-        /* next field */
-        p = s;
-
-        /* skip whitespace */
-        while (*p && isspace (*p))
-            p++;
-
-        /* line is empty? */
-        if (!*p)
-            continue;
-
-        /* find end of field */
-        s = p;
-        while (*s && !isspace (*s))
-            s++;
-        if (*s)
-            *s++ = '\0';
-
-        /* copy name */
-        *id_name = strdup (p);
-
-        /* next field */
-        p = s;
-
-        /* skip whitespace */
-        while (*p && isspace (*p))
-            p++;
-
-        /* line is empty? */
-        if (!*p)
-        {
-            free (*id_name);
-            *id_name = NULL;
-            continue;
-        }
-
-        /* copy fullname */
-        *id_fullname = strdup (p);
-
-        r = 1;
-        break;
-    }
-    free (line);
-
-    fclose (file);
-
-    urj_tap_register_free (tr);
-
-    return r;
+    *db = NULL;
+    return urj_tap_partdb_find_record (filename, key, name, fullname);
 }
 
-#define strncat_const(dst, src) strncat(dst, src, sizeof(dst) - strlen(dst) - 1)
-
 int
 urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
 {
@@ -184,6 +82,7 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
     urj_tap_register_t *id;
     urj_tap_register_t *all_ids;
     urj_parts_t *ps;
+    urj_partdb_t *db;
     int i;
 
     char data_path[1024];
@@ -258,6 +157,9 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
     chain->parts = ps;
     chain->active_part = 0;
 
+    /* the compiled index saves reading the text tables for each part */
+    db = urj_tap_partdb_open (db_path);
+
     /* Detect parts */
     urj_tap_reset (chain);
     urj_tap_capture_dr (chain);
@@ -274,7 +176,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
         urj_part_init_func_t part_init_func;
 
         if (all_ids)
-            br->data[0] = all_ids->data[i * 32];
+            urj_tap_register_set_bit (br, 0,
+                            urj_tap_register_get_bit (all_ids, i * 32));
         else
             urj_tap_shift_register (chain, one, br, URJ_CHAIN_EXITMODE_SHIFT);
 
@@ -282,12 +185,13 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
         {
             /* Part that supports IDCODE */
             if (all_ids)
-                memcpy (id->data, &all_ids->data[i * 32 + 1], 31 * sizeof (id->data[0]));
+                urj_tap_bits_copy (id->packed, 0, all_ids->packed, i * 32 + 1,
+                                   31);
             else
                 urj_tap_shift_register (chain, ones, id,
                                         URJ_CHAIN_EXITMODE_SHIFT);
             urj_tap_register_shift_left (id, 1);
-            id->data[0] = 1;
+            urj_tap_register_set_bit (id, 0, 1);
             did = id;
 
             urj_log (URJ_LOG_LEVEL_NORMAL, _("Device Id: %s (0x%0*" PRIX64 ")\n"),
@@ -319,6 +223,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
 #endif
         {
             char *id_name = NULL, *id_fullname = NULL;
+            const urj_partdb_t *part_db = db;
+            uint32_t db_id;
 
             /* find JTAG declarations for a part with id */
 
@@ -329,8 +235,10 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/MANUFACTURERS");
 
             key = urj_tap_register_alloc (11);
-            memcpy (key->data, &id->data[1], key->len);
-            if (!find_record (data_path, key, &id_name, &id_fullname))
+            urj_tap_bits_copy (key->packed, 0, id->packed, 1, key->len);
+            db_id = urj_tap_register_get_value (key);
+            if (!detect_find_record (&part_db, URJ_PARTDB_MANUFACTURER, db_id,
+                                     data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
                          _("Unknown manufacturer!"),
@@ -359,8 +267,10 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/PARTS");
 
             key = urj_tap_register_alloc (16);
-            memcpy (key->data, &id->data[12], key->len);
-            if (!find_record (data_path, key, &id_name, &id_fullname))
+            urj_tap_bits_copy (key->packed, 0, id->packed, 12, key->len);
+            db_id = (db_id << 16) | urj_tap_register_get_value (key);
+            if (!detect_find_record (&part_db, URJ_PARTDB_PART, db_id,
+                                     data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
                          _("Unknown part!"),
@@ -389,8 +299,10 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             strncat_const (data_path, "/STEPPINGS");
 
             key = urj_tap_register_alloc (4);
-            memcpy (key->data, &id->data[28], key->len);
-            if (!find_record (data_path, key, &id_name, &id_fullname))
+            urj_tap_bits_copy (key->packed, 0, id->packed, 28, key->len);
+            db_id = (db_id << 4) | urj_tap_register_get_value (key);
+            if (!detect_find_record (&part_db, URJ_PARTDB_STEPPING, db_id,
+                                     data_path, key, &id_name, &id_fullname))
             {
                 urj_log (URJ_LOG_LEVEL_NORMAL, "  %s (%s) (%s)\n",
                          _("Unknown stepping!"),
@@ -444,6 +356,8 @@ urj_tap_detect_parts (urj_chain_t *chain, const char *db_path, int maxirlen)
             part->params = NULL;
     }
 
+    urj_tap_partdb_close (db);
+
     chain->main_part = ps->len - 1;
 
     if (!(chain->cable->driver->quirks & URJ_CABLE_QUIRK_ONESHOT))
@@ -26,10 +26,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <urjtag/tap.h>
 #include <urjtag/tap_register.h>
 #include <urjtag/chain.h>
+#include <urjtag/tap_state.h>
 
 
 #define DETECT_PATTERN_SIZE     8
@@ -37,8 +39,159 @@
 #define TEST_COUNT              1
 #define TEST_THRESHOLD          100     /* in % */
 
+/* shifted behind a zero fill to find the register length in one scan;
+   bit 0 must be set */
+#define DETECT_MARKER_SIZE      32
+#define DETECT_MARKER           0x2d4b96a5
+#define DETECT_MARKER2          0xd2b4695b
+
+/* instructions surveyed per cable flush by urj_tap_discovery */
+#define DISCOVERY_BATCH         64
+
 #undef VERY_LOW_LEVEL_DEBUG
 
+/* patterns that confirm a length found from the marker */
+static const int detect_verify_patterns[] = { 0x55, 0xaa, 0x81 };
+
+/*
+ * Shift zeros (rz) through the register, then rpat, and check that rpat
+ * comes out after rz->len bits.  tdo_stuck is -2 before the first call,
+ * the TDO level while all captured bits were equal and -1 afterwards.
+ * @return 1 if the pattern came through; 0 otherwise
+ */
+static int
+detect_test_pattern (urj_chain_t *chain, const urj_tap_register_t *rz,
+                     const urj_tap_register_t *rpat, urj_tap_register_t *rout,
+                     int *tdo_stuck)
+{
+    int i, tdo;
+    int ok = 0;
+
+    for (i = 0; i < TEST_COUNT; i++)
+    {
+        urj_tap_shift_register (chain, rz, NULL, 0);
+        urj_tap_shift_register (chain, rpat, rout, 0);
+
+#ifdef VERY_LOW_LEVEL_DEBUG
+        urj_log (URJ_LOG_LEVEL_ALL, ">>> %s\n", urj_tap_register_get_string (rz));
+        urj_log (URJ_LOG_LEVEL_ALL, "  + %s\n", urj_tap_register_get_string (rpat));
+#endif
+        tdo = urj_tap_register_all_bits_same_value (rout);
+        if (*tdo_stuck == -2)
+            *tdo_stuck = tdo;
+        if (*tdo_stuck != tdo)
+            *tdo_stuck = -1;
+
+        urj_tap_register_shift_right (rout, rz->len);
+        if (urj_tap_register_compare (rpat, rout) == 0)
+            ok++;
+#ifdef VERY_LOW_LEVEL_DEBUG
+        urj_log (URJ_LOG_LEVEL_ALL, "  = %s => %d\n", urj_tap_register_get_string (rout),
+                ok);
+#endif
+    }
+
+    return 100 * ok / TEST_COUNT >= TEST_THRESHOLD;
+}
+
+/*
+ * Find the marker in the bits captured while shifting it in behind a zero
+ * fill of at least maxlen bits: the fill comes out first, so the first
+ * one bit starts the marker.
+ * @return register length; -1 if the marker is not there
+ */
+static int
+detect_marker_offset (const urj_tap_register_t *rout, int maxlen,
+                      uint32_t marker)
+{
+    int len, i;
+
+    for (len = 0; len <= maxlen; len++)
+        if (urj_tap_register_get_bit (rout, len))
+            break;
+    if (len == 0 || len > maxlen)
+        return -1;
+
+    for (i = 0; i < DETECT_MARKER_SIZE; i++)
+        if (urj_tap_register_get_bit (rout, len + i) != ((marker >> i) & 1))
+            return -1;
+
+    return len;
+}
+
+/*
+ * Fill the register with zeros, shift a marker after them and take the
+ * length from the position the marker comes out at.  The length is then
+ * checked with detect_verify_patterns.
+ * @return register length; -1 if the marker was not found or the check
+ *      failed
+ */
+static int
+detect_register_size_fast (urj_chain_t *chain, int maxlen, int *tdo_stuck)
+{
+    int len, i, tdo;
+    urj_tap_register_t *rz;
+    urj_tap_register_t *rout;
+    urj_tap_register_t *rpat;
+
+    rz = urj_tap_register_fill (urj_tap_register_alloc (maxlen), 0);
+    rpat = urj_tap_register_fill (urj_tap_register_alloc
+                                  (maxlen + DETECT_MARKER_SIZE), 0);
+    rout = urj_tap_register_alloc (maxlen + DETECT_MARKER_SIZE);
+    if (!rz || !rpat || !rout)
+    {
+        len = -1;
+        goto done;
+    }
+
+    urj_tap_register_set_value_bit_range (rpat, DETECT_MARKER,
+                                          DETECT_MARKER_SIZE - 1, 0);
+    urj_tap_shift_register (chain, rz, NULL, 0);
+    urj_tap_shift_register (chain, rpat, rout, 0);
+
+    tdo = urj_tap_register_all_bits_same_value (rout);
+    if (*tdo_stuck == -2)
+        *tdo_stuck = tdo;
+    if (*tdo_stuck != tdo)
+        *tdo_stuck = -1;
+
+    len = detect_marker_offset (rout, maxlen, DETECT_MARKER);
+    if (len < 0)
+        goto done;
+
+    urj_tap_register_free (rz);
+    urj_tap_register_free (rpat);
+    urj_tap_register_free (rout);
+
+    rz = urj_tap_register_fill (urj_tap_register_alloc (len), 0);
+    rpat = urj_tap_register_fill (urj_tap_register_alloc
+                                  (DETECT_PATTERN_SIZE + len), 0);
+    rout = urj_tap_register_alloc (DETECT_PATTERN_SIZE + len);
+    if (!rz || !rpat || !rout)
+    {
+        len = -1;
+        goto done;
+    }
+
+    for (i = 0; i < ARRAY_SIZE (detect_verify_patterns); i++)
+    {
+        urj_tap_register_set_value_bit_range (rpat, detect_verify_patterns[i],
+                                              DETECT_PATTERN_SIZE - 1, 0);
+        if (!detect_test_pattern (chain, rz, rpat, rout, tdo_stuck))
+        {
+            len = -1;
+            break;
+        }
+    }
+
+ done:
+    urj_tap_register_free (rz);
+    urj_tap_register_free (rpat);
+    urj_tap_register_free (rout);
+
+    return len;
+}
+
 int
 urj_tap_detect_register_size (urj_chain_t *chain, int maxlen)
 {
@@ -51,8 +204,21 @@ urj_tap_detect_register_size (urj_chain_t *chain, int maxlen)
         maxlen = DEFAULT_MAX_REGISTER_LENGTH;
 
     /* This seems to be a good place to check if TDO changes at all */
-    int tdo, tdo_stuck = -2;
+    int tdo_stuck = -2;
+
+    len = detect_register_size_fast (chain, maxlen, &tdo_stuck);
+    if (len > 0)
+        return len;
+
+    /* stuck TDO will not get better by trying harder */
+    if (tdo_stuck >= 0)
+    {
+        urj_warning (_("TDO seems to be stuck at %d\n"), tdo_stuck);
+        return -1;
+    }
 
+    /* the register did not pass the marker through as expected, try all
+       lengths and patterns */
     for (len = 1; len <= maxlen; len++)
     {
         int p;
@@ -67,42 +233,9 @@ urj_tap_detect_register_size (urj_chain_t *chain, int maxlen)
 
         for (p = 1; p < (1 << DETECT_PATTERN_SIZE); p++)
         {
-            int i;
-            const char *s;
-            ok = 0;
-
-            s = urj_tap_register_get_string (rpat);
-            while (*s)
-                s++;
-
-            for (i = 0; i < TEST_COUNT; i++)
-            {
-                urj_tap_shift_register (chain, rz, NULL, 0);
-                urj_tap_shift_register (chain, rpat, rout, 0);
-
-#ifdef VERY_LOW_LEVEL_DEBUG
-                urj_log (URJ_LOG_LEVEL_ALL, ">>> %s\n", urj_tap_register_get_string (rz));
-                urj_log (URJ_LOG_LEVEL_ALL, "  + %s\n", urj_tap_register_get_string (rpat));
-#endif
-                tdo = urj_tap_register_all_bits_same_value (rout);
-                if (tdo_stuck == -2)
-                    tdo_stuck = tdo;
-                if (tdo_stuck != tdo)
-                    tdo_stuck = -1;
-
-                urj_tap_register_shift_right (rout, len);
-                if (urj_tap_register_compare (rpat, rout) == 0)
-                    ok++;
-#ifdef VERY_LOW_LEVEL_DEBUG
-                urj_log (URJ_LOG_LEVEL_ALL, "  = %s => %d\n", urj_tap_register_get_string (rout),
-                        ok);
-#endif
-            }
-            if (100 * ok / TEST_COUNT < TEST_THRESHOLD)
-            {
-                ok = 0;
+            ok = detect_test_pattern (chain, rz, rpat, rout, &tdo_stuck);
+            if (!ok)
                 break;
-            }
 
             urj_tap_register_inc (rpat);
         }
@@ -123,12 +256,102 @@ urj_tap_detect_register_size (urj_chain_t *chain, int maxlen)
     return -1;
 }
 
+/* one instruction of a urj_tap_discovery batch */
+typedef struct
+{
+    urj_tap_register_t *ir;
+    /* out of the zero fill, starts with the captured DR */
+    urj_tap_register_t *fill;
+    /* out of the two marker scans */
+    urj_tap_register_t *probe[2];
+} discovery_slot_t;
+
+/*
+ * Queue the scans that survey the DR of slot->ir.  Unless reset is 0 the
+ * TAP is reset by TMS first, which passes Update-DR with the zeros
+ * trailing the previous marker.
+ */
+static void
+discovery_queue (urj_chain_t *chain, discovery_slot_t *slot, int reset,
+                 const urj_tap_register_t *rz, urj_tap_register_t **rmark)
+{
+    if (reset)
+    {
+        urj_tap_state_reset (chain);
+        urj_tap_chain_defer_clock (chain, 1, 0, 5);     /* Test-Logic-Reset */
+        urj_tap_chain_defer_clock (chain, 0, 0, 1);     /* Run-Test/Idle */
+    }
+
+    urj_tap_capture_ir (chain);
+    urj_tap_defer_shift_register (chain, slot->ir, NULL,
+                                  URJ_CHAIN_EXITMODE_IDLE);
+
+    urj_tap_capture_dr (chain);
+    urj_tap_defer_shift_register (chain, rz, slot->fill,
+                                  URJ_CHAIN_EXITMODE_SHIFT);
+    urj_tap_defer_shift_register (chain, rmark[0], slot->probe[0],
+                                  URJ_CHAIN_EXITMODE_SHIFT);
+    urj_tap_defer_shift_register (chain, rmark[1], slot->probe[1],
+                                  URJ_CHAIN_EXITMODE_SHIFT);
+}
+
+/* pick up what discovery_queue captured, in the same order */
+static void
+discovery_collect (urj_chain_t *chain, discovery_slot_t *slot,
+                   const urj_tap_register_t *rz, urj_tap_register_t **rmark)
+{
+    urj_tap_shift_register_output (chain, rz, slot->fill,
+                                   URJ_CHAIN_EXITMODE_SHIFT);
+    urj_tap_shift_register_output (chain, rmark[0], slot->probe[0],
+                                   URJ_CHAIN_EXITMODE_SHIFT);
+    urj_tap_shift_register_output (chain, rmark[1], slot->probe[1],
+                                   URJ_CHAIN_EXITMODE_SHIFT);
+}
+
+/* print the table row of slot, surveying it again on its own if the
+   markers did not come through */
+static void
+discovery_report (urj_chain_t *chain, discovery_slot_t *slot, int maxlen)
+{
+    urj_tap_register_t *captured = NULL;
+    int len;
+
+    len = detect_marker_offset (slot->probe[0], maxlen, DETECT_MARKER);
+    if (len > 0
+        && detect_marker_offset (slot->probe[1], maxlen, DETECT_MARKER2) == len)
+    {
+        captured = urj_tap_register_alloc (len);
+        if (captured)
+            urj_tap_bits_copy (captured->packed, 0, slot->fill->packed, 0,
+                               len);
+    }
+    else
+    {
+        urj_tap_trst_reset (chain);
+        urj_tap_capture_ir (chain);
+        urj_tap_shift_register (chain, slot->ir, NULL,
+                                URJ_CHAIN_EXITMODE_IDLE);
+        urj_tap_capture_dr (chain);
+        len = urj_tap_detect_register_size (chain, maxlen);
+    }
+
+    urj_log (URJ_LOG_LEVEL_NORMAL, "%s\t%d\t%s\n",
+             urj_tap_register_get_string (slot->ir), len,
+             captured ? urj_tap_register_get_string (captured) : "-");
+    urj_tap_register_free (captured);
+}
+
 int
 urj_tap_discovery (urj_chain_t *chain)
 {
-    int irlen;
+    int irlen, i, n, last;
+    int maxlen = DEFAULT_MAX_REGISTER_LENGTH;
     urj_tap_register_t *ir;
     urj_tap_register_t *irz;
+    urj_tap_register_t *rz;
+    urj_tap_register_t *rmark[2];
+    discovery_slot_t slot[DISCOVERY_BATCH];
+    int ret = URJ_STATUS_FAIL;
 
     /* detecting IR size */
     urj_tap_trst_reset (chain);
@@ -151,38 +374,67 @@ urj_tap_discovery (urj_chain_t *chain)
     /* all 1 is BYPASS in all parts, so DR length gives number of parts */
     ir = urj_tap_register_fill (urj_tap_register_alloc (irlen), 1);
     irz = urj_tap_register_duplicate (ir);
-
-    if (!ir || !irz)
+    rz = urj_tap_register_fill (urj_tap_register_alloc (maxlen), 0);
+    rmark[0] = urj_tap_register_fill (urj_tap_register_alloc
+                                      (maxlen + DETECT_MARKER_SIZE), 0);
+    rmark[1] = urj_tap_register_duplicate (rmark[0]);
+
+    memset (slot, 0, sizeof slot);
+    if (!ir || !irz || !rz || !rmark[0] || !rmark[1])
+        goto done;
+    for (i = 0; i < DISCOVERY_BATCH; i++)
     {
-        urj_tap_register_free (ir);
-        urj_tap_register_free (irz);
-        return URJ_STATUS_FAIL;
+        slot[i].ir = urj_tap_register_alloc (irlen);
+        slot[i].fill = urj_tap_register_alloc (maxlen);
+        slot[i].probe[0] = urj_tap_register_alloc (maxlen + DETECT_MARKER_SIZE);
+        slot[i].probe[1] = urj_tap_register_alloc (maxlen + DETECT_MARKER_SIZE);
+        if (!slot[i].ir || !slot[i].fill || !slot[i].probe[0]
+            || !slot[i].probe[1])
+            goto done;
     }
 
-    for (;;)
-    {
-        int rs;
+    urj_tap_register_set_value_bit_range (rmark[0], DETECT_MARKER,
+                                          DETECT_MARKER_SIZE - 1, 0);
+    urj_tap_register_set_value_bit_range (rmark[1], DETECT_MARKER2,
+                                          DETECT_MARKER_SIZE - 1, 0);
 
+    /* the scans of a batch of instructions go out in one cable flush, the
+       results are collected in order when the batch is complete */
+    urj_log (URJ_LOG_LEVEL_NORMAL, _("# IR\tDR length\tcaptured DR\n"));
+    last = 0;
+    while (!last)
+    {
         urj_tap_trst_reset (chain);
 
-        urj_tap_capture_ir (chain);
-        urj_tap_shift_register (chain, ir, NULL, 1);
-
-        urj_log (URJ_LOG_LEVEL_NORMAL, _("Detecting DR length for IR %s ... "),
-                urj_tap_register_get_string (ir));
-        fflush (stdout);
+        for (n = 0; n < DISCOVERY_BATCH && !last; n++)
+        {
+            urj_tap_bits_copy (slot[n].ir->packed, 0, ir->packed, 0, irlen);
+            discovery_queue (chain, &slot[n], n > 0, rz, rmark);
 
-        urj_tap_capture_dr (chain);
-        rs = urj_tap_detect_register_size (chain, 0);
+            urj_tap_register_inc (ir);
+            last = urj_tap_register_compare (ir, irz) == 0;
+        }
 
-        urj_log (URJ_LOG_LEVEL_NORMAL, _("%d\n"), rs);
+        for (i = 0; i < n; i++)
+            discovery_collect (chain, &slot[i], rz, rmark);
+        for (i = 0; i < n; i++)
+            discovery_report (chain, &slot[i], maxlen);
+    }
+    ret = URJ_STATUS_OK;
 
-        urj_tap_register_inc (ir);
-        if (urj_tap_register_compare (ir, irz) == 0)
-            break;
+ done:
+    for (i = 0; i < DISCOVERY_BATCH; i++)
+    {
+        urj_tap_register_free (slot[i].ir);
+        urj_tap_register_free (slot[i].fill);
+        urj_tap_register_free (slot[i].probe[0]);
+        urj_tap_register_free (slot[i].probe[1]);
     }
     urj_tap_register_free (ir);
     urj_tap_register_free (irz);
+    urj_tap_register_free (rz);
+    urj_tap_register_free (rmark[0]);
+    urj_tap_register_free (rmark[1]);
 
-    return URJ_STATUS_OK;
+    return ret;
 }
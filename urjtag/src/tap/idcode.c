@@ -78,7 +78,7 @@ urj_tap_idcode (urj_chain_t *chain, unsigned int bytes)
         uint8_t val;
 
         if (all_rout)
-            memcpy (rout->data, &all_rout->data[i * 8], 8 * sizeof (rout->data[0]));
+            urj_tap_bits_copy (rout->packed, 0, all_rout->packed, i * 8, 8);
         else
             urj_tap_shift_register (chain, rz, rout, 0);
 
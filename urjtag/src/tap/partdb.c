@@ -0,0 +1,621 @@
+/*
+ * $Id$
+ *
+ * Compiled index of the part database
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include <sysdep.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+#include <urjtag/error.h>
+#include <urjtag/log.h>
+#include <urjtag/tap_register.h>
+#include <urjtag/partdb.h>
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/*
+ * Index file layout, all numbers in host byte order:
+ *   header
+ *   uint32_t bucket[nbuckets]        first entry + 1 of the chain, 0 if none
+ *   partdb_entry_t entry[nentries]
+ *   char strings[strings_size]       NUL terminated names
+ */
+#define PARTDB_MAGIC            "URJPDB1"
+#define PARTDB_BYTE_ORDER       0x01020304
+
+typedef struct
+{
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t nbuckets;
+    uint32_t nentries;
+    uint32_t strings_size;
+} partdb_header_t;
+
+typedef struct
+{
+    uint32_t level;
+    uint32_t id;
+    uint32_t name;              /* offsets into strings */
+    uint32_t fullname;
+    uint32_t next;              /* entry + 1 of the chain, 0 at the end */
+} partdb_entry_t;
+
+struct URJ_PARTDB
+{
+    void *map;
+    size_t size;
+    int mapped;
+    time_t mtime;               /* of the index file */
+    const partdb_header_t *header;
+    const uint32_t *bucket;
+    const partdb_entry_t *entry;
+    const char *strings;
+};
+
+/* index under construction */
+typedef struct
+{
+    partdb_entry_t *entry;
+    uint32_t nentries;
+    uint32_t max_entries;
+    char *strings;
+    uint32_t strings_size;
+    uint32_t max_strings;
+} partdb_build_t;
+
+static uint32_t
+partdb_hash (uint32_t level, uint32_t id)
+{
+    uint32_t h = id * 0x9e3779b1 ^ level * 0x85ebca6b;
+
+    return h ^ (h >> 15);
+}
+
+/*
+ * Read the next record of a table: the ID bits, the name and the full
+ * name, separated by whitespace.  Comments, empty lines and lines without
+ * all three fields are skipped.  The fields point into *line.
+ * @return 1 for a record; 0 at the end of the file
+ */
+static int
+partdb_read_record (FILE *file, char **line, size_t *len, char **bits,
+                    char **name, char **fullname)
+{
+    for (;;)
+    {
+        char *p;
+        char *s;
+
+        if (getline (line, len, file) == -1)
+            return 0;
+
+        /* remove comment and nl from the line */
+        p = strpbrk (*line, "#\n");
+        if (p)
+            *p = '\0';
+
+        p = *line;
+
+        /* skip whitespace */
+        while (*p && isspace (*p))
+            p++;
+
+        /* remove ending whitespace */
+        s = strchr (p, '\0');
+        while (s != p)
+        {
+            if (!isspace (*--s))
+                break;
+            *s = '\0';
+        }
+
+        /* line is empty? */
+        if (!*p)
+            continue;
+
+        /* find end of field */
+        s = p;
+        while (*s && !isspace (*s))
+            s++;
+        if (*s)
+            *s++ = '\0';
+        *bits = p;
+
+        /* next field */
+        p = s;
+
+        /* skip whitespace */
+        while (*p && isspace (*p))
+            p++;
+
+        /* line is empty? */
+        if (!*p)
+            continue;
+
+        /* find end of field */
+        s = p;
+        while (*s && !isspace (*s))
+            s++;
+        if (*s)
+            *s++ = '\0';
+        *name = p;
+
+        /* next field */
+        p = s;
+
+        /* skip whitespace */
+        while (*p && isspace (*p))
+            p++;
+
+        /* line is empty? */
+        if (!*p)
+            continue;
+
+        *fullname = p;
+
+        return 1;
+    }
+}
+
+/* hand out copies of name and fullname, freeing the previous ones */
+static int
+partdb_copy_names (const char *name, const char *fullname, char **id_name,
+                   char **id_fullname)
+{
+    free (*id_name);
+    free (*id_fullname);
+    *id_name = *id_fullname = NULL;
+
+    if (name == NULL)
+        return 0;
+
+    *id_name = strdup (name);
+    *id_fullname = strdup (fullname);
+    if (*id_name == NULL || *id_fullname == NULL)
+    {
+        free (*id_name);
+        free (*id_fullname);
+        *id_name = *id_fullname = NULL;
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "strdup() fails");
+        return 0;
+    }
+
+    return 1;
+}
+
+int
+urj_tap_partdb_find_record (const char *filename,
+                            const urj_tap_register_t *key, char **name,
+                            char **fullname)
+{
+    FILE *file;
+    urj_tap_register_t *tr;
+    char *line = NULL;
+    size_t len;
+    char *bits, *n, *f;
+    int r = 0;
+
+    free (*name);
+    free (*fullname);
+    *name = *fullname = NULL;
+
+    file = fopen (filename, FOPEN_R);
+    if (!file)
+    {
+        urj_log (URJ_LOG_LEVEL_ERROR, _("Unable to open file '%s'\n"), filename);
+        urj_error_IO_set ("Unable to open file '%s'", filename);
+        return r;
+    }
+
+    tr = urj_tap_register_alloc (key->len);
+
+    while (partdb_read_record (file, &line, &len, &bits, &n, &f))
+    {
+        /* test field length */
+        if (strlen (bits) != key->len)
+            continue;
+
+        /* match */
+        urj_tap_register_init (tr, bits);
+        if (urj_tap_register_compare (tr, key))
+            continue;
+
+        r = partdb_copy_names (n, f, name, fullname);
+        break;
+    }
+    free (line);
+
+    fclose (file);
+
+    urj_tap_register_free (tr);
+
+    return r;
+}
+
+/* @return value of the ID bits, as urj_tap_register_init() reads them */
+static uint32_t
+partdb_bits_value (const char *bits)
+{
+    uint32_t v = 0;
+
+    for (; *bits; bits++)
+        v = (v << 1) | (*bits != '0');
+
+    return v;
+}
+
+static uint32_t
+partdb_add_string (partdb_build_t *b, const char *s)
+{
+    size_t n = strlen (s) + 1;
+    uint32_t offset = b->strings_size;
+
+    if (b->strings_size + n > b->max_strings)
+    {
+        uint32_t size = b->max_strings ? b->max_strings : 4096;
+        char *p;
+
+        while (b->strings_size + n > size)
+            size *= 2;
+        p = realloc (b->strings, size);
+        if (p == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("realloc(%s,%zd) fails"),
+                           "strings", (size_t) size);
+            return UINT32_MAX;
+        }
+        b->strings = p;
+        b->max_strings = size;
+    }
+
+    memcpy (b->strings + offset, s, n);
+    b->strings_size += n;
+
+    return offset;
+}
+
+static int
+partdb_add (partdb_build_t *b, urj_partdb_level_t level, uint32_t id,
+            const char *name, const char *fullname)
+{
+    partdb_entry_t *e;
+
+    if (b->nentries == b->max_entries)
+    {
+        uint32_t n = b->max_entries ? 2 * b->max_entries : 256;
+
+        e = realloc (b->entry, n * sizeof *e);
+        if (e == NULL)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("realloc(%s,%zd) fails"),
+                           "entry", n * sizeof *e);
+            return URJ_STATUS_FAIL;
+        }
+        b->entry = e;
+        b->max_entries = n;
+    }
+
+    e = &b->entry[b->nentries];
+    e->level = level;
+    e->id = id;
+    e->name = partdb_add_string (b, name);
+    e->fullname = partdb_add_string (b, fullname);
+    e->next = 0;
+    if (e->name == UINT32_MAX || e->fullname == UINT32_MAX)
+        return URJ_STATUS_FAIL;
+    b->nentries++;
+
+    return URJ_STATUS_OK;
+}
+
+/*
+ * Add the records of a table of the database with ID fields of len bits
+ * below prefix, descending into the PARTS and STEPPINGS tables they name
+ */
+static int
+partdb_add_table (partdb_build_t *b, const char *filename, int len,
+                  urj_partdb_level_t level, uint32_t prefix,
+                  const char *db_path, const char *dir)
+{
+    FILE *file;
+    char *line = NULL;
+    size_t line_len;
+    char *bits, *name, *fullname;
+    char path[1024];
+    int r = URJ_STATUS_OK;
+
+    file = fopen (filename, FOPEN_R);
+    if (!file)
+    {
+        /* a manufacturer without parts or a part without steppings */
+        if (level != URJ_PARTDB_MANUFACTURER)
+            return URJ_STATUS_OK;
+        urj_error_IO_set ("Unable to open file '%s'", filename);
+        return URJ_STATUS_FAIL;
+    }
+
+    while (r == URJ_STATUS_OK
+           && partdb_read_record (file, &line, &line_len, &bits, &name,
+                                  &fullname))
+    {
+        uint32_t id, i;
+
+        if (strlen (bits) != len)
+            continue;
+
+        id = (prefix << len) | partdb_bits_value (bits);
+
+        /* like a search through the text tables, the first record wins;
+           its duplicates and the tables they name are never reached */
+        for (i = 0; i < b->nentries; i++)
+            if (b->entry[i].level == level && b->entry[i].id == id)
+                break;
+        if (i < b->nentries)
+            continue;
+
+        r = partdb_add (b, level, id, name, fullname);
+        if (r != URJ_STATUS_OK)
+            break;
+
+        switch (level)
+        {
+        case URJ_PARTDB_MANUFACTURER:
+            snprintf (path, sizeof path, "%s/%s/PARTS", db_path, name);
+            r = partdb_add_table (b, path, 16, URJ_PARTDB_PART, id, db_path,
+                                  name);
+            break;
+        case URJ_PARTDB_PART:
+            snprintf (path, sizeof path, "%s/%s/%s/STEPPINGS", db_path, dir,
+                      name);
+            r = partdb_add_table (b, path, 4, URJ_PARTDB_STEPPING, id,
+                                  db_path, NULL);
+            break;
+        default:
+            break;
+        }
+    }
+    free (line);
+    fclose (file);
+
+    return r;
+}
+
+int
+urj_tap_partdb_compile (const char *db_path, const char *index_file)
+{
+    partdb_build_t b;
+    partdb_header_t header;
+    uint32_t *bucket = NULL;
+    uint32_t nbuckets, i;
+    char path[1024];
+    FILE *file;
+    int r = URJ_STATUS_FAIL;
+
+    memset (&b, 0, sizeof b);
+
+    snprintf (path, sizeof path, "%s/MANUFACTURERS", db_path);
+    if (partdb_add_table (&b, path, 11, URJ_PARTDB_MANUFACTURER, 0, db_path,
+                          NULL) != URJ_STATUS_OK)
+        goto done;
+
+    for (nbuckets = 64; nbuckets < 2 * b.nentries; nbuckets *= 2)
+        ;
+    bucket = calloc (nbuckets, sizeof *bucket);
+    if (bucket == NULL)
+    {
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, _("calloc(%zd,%zd) fails"),
+                       (size_t) nbuckets, sizeof *bucket);
+        goto done;
+    }
+
+    for (i = 0; i < b.nentries; i++)
+    {
+        uint32_t h = partdb_hash (b.entry[i].level, b.entry[i].id);
+
+        h &= nbuckets - 1;
+        b.entry[i].next = bucket[h];
+        bucket[h] = i + 1;
+    }
+
+    memset (&header, 0, sizeof header);
+    strcpy (header.magic, PARTDB_MAGIC);
+    header.byte_order = PARTDB_BYTE_ORDER;
+    header.nbuckets = nbuckets;
+    header.nentries = b.nentries;
+    header.strings_size = b.strings_size;
+
+    file = fopen (index_file, FOPEN_W);
+    if (!file)
+    {
+        urj_error_IO_set ("Unable to create file '%s'", index_file);
+        goto done;
+    }
+    if (fwrite (&header, sizeof header, 1, file) != 1
+        || fwrite (bucket, sizeof *bucket, nbuckets, file) != nbuckets
+        || fwrite (b.entry, sizeof *b.entry, b.nentries, file) != b.nentries
+        || fwrite (b.strings, 1, b.strings_size, file) != b.strings_size)
+    {
+        urj_error_IO_set ("Unable to write file '%s'", index_file);
+        fclose (file);
+        goto done;
+    }
+    if (fclose (file) != 0)
+    {
+        urj_error_IO_set ("Unable to write file '%s'", index_file);
+        goto done;
+    }
+
+    urj_log (URJ_LOG_LEVEL_DETAIL, "%s: %lu records\n", index_file,
+             (unsigned long) b.nentries);
+    r = URJ_STATUS_OK;
+
+ done:
+    free (bucket);
+    free (b.entry);
+    free (b.strings);
+
+    return r;
+}
+
+urj_partdb_t *
+urj_tap_partdb_open (const char *db_path)
+{
+    urj_partdb_t *db;
+    const partdb_header_t *h;
+    char path[1024];
+    struct stat st;
+    size_t size;
+    int fd;
+
+    snprintf (path, sizeof path, "%s/" URJ_PARTDB_INDEX, db_path);
+    fd = open (path, O_RDONLY | O_BINARY);
+    if (fd < 0)
+        return NULL;
+
+    db = calloc (1, sizeof *db);
+    if (db == NULL || fstat (fd, &st) != 0
+        || st.st_size < (off_t) sizeof (partdb_header_t))
+    {
+        free (db);
+        close (fd);
+        return NULL;
+    }
+    db->size = st.st_size;
+    db->mtime = st.st_mtime;
+
+#ifdef HAVE_SYS_MMAN_H
+    db->map = mmap (NULL, db->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (db->map == MAP_FAILED)
+        db->map = NULL;
+    else
+        db->mapped = 1;
+#endif
+    if (db->map == NULL)
+    {
+        db->map = malloc (db->size);
+        if (db->map == NULL
+            || read (fd, db->map, db->size) != (ssize_t) db->size)
+        {
+            free (db->map);
+            free (db);
+            close (fd);
+            return NULL;
+        }
+    }
+    close (fd);
+
+    h = db->header = db->map;
+    db->bucket = (const uint32_t *) (h + 1);
+    db->entry = (const partdb_entry_t *) (db->bucket + h->nbuckets);
+    db->strings = (const char *) (db->entry + h->nentries);
+
+    /* an index from a host with other byte order, or a damaged one, is
+       left alone in favour of the text files */
+    size = sizeof *h + (size_t) h->nbuckets * sizeof *db->bucket
+        + (size_t) h->nentries * sizeof *db->entry + h->strings_size;
+    if (memcmp (h->magic, PARTDB_MAGIC, sizeof PARTDB_MAGIC) != 0
+        || h->byte_order != PARTDB_BYTE_ORDER
+        || h->nbuckets == 0 || (h->nbuckets & (h->nbuckets - 1)) != 0
+        || h->strings_size == 0 || size != db->size
+        || db->strings[h->strings_size - 1] != '\0')
+    {
+        urj_log (URJ_LOG_LEVEL_DETAIL, _("Ignoring invalid index '%s'\n"),
+                 path);
+        urj_tap_partdb_close (db);
+        return NULL;
+    }
+
+    /* the data files are edited and installed without rebuilding the
+       index; once the manufacturers table is newer, none of it is trusted */
+    snprintf (path, sizeof path, "%s/MANUFACTURERS", db_path);
+    if (!urj_tap_partdb_current (db, path))
+    {
+        urj_log (URJ_LOG_LEVEL_DETAIL, _("Ignoring outdated index '%s/%s'\n"),
+                 db_path, URJ_PARTDB_INDEX);
+        urj_tap_partdb_close (db);
+        return NULL;
+    }
+
+    return db;
+}
+
+void
+urj_tap_partdb_close (urj_partdb_t *db)
+{
+    if (db == NULL)
+        return;
+
+#ifdef HAVE_SYS_MMAN_H
+    if (db->mapped)
+        munmap (db->map, db->size);
+    else
+#endif
+        free (db->map);
+    free (db);
+}
+
+int
+urj_tap_partdb_current (const urj_partdb_t *db, const char *filename)
+{
+    struct stat st;
+
+    return stat (filename, &st) == 0 && st.st_mtime <= db->mtime;
+}
+
+int
+urj_tap_partdb_lookup (const urj_partdb_t *db, urj_partdb_level_t level,
+                       uint32_t id, char **name, char **fullname)
+{
+    const partdb_header_t *h = db->header;
+    uint32_t k;
+
+    k = db->bucket[partdb_hash (level, id) & (h->nbuckets - 1)];
+    while (k && k <= h->nentries)
+    {
+        const partdb_entry_t *e = &db->entry[k - 1];
+
+        if (e->level == level && e->id == id)
+        {
+            if (e->name >= h->strings_size || e->fullname >= h->strings_size)
+                break;
+            return partdb_copy_names (db->strings + e->name,
+                                      db->strings + e->fullname, name,
+                                      fullname);
+        }
+        k = e->next;
+    }
+
+    return partdb_copy_names (NULL, NULL, name, fullname);
+}
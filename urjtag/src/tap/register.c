@@ -32,6 +32,164 @@
 #include <urjtag/log.h>
 #include <urjtag/tap_register.h>
 
+/* size of the packed storage, rounded up to whole machine words */
+static size_t
+register_alloc_size (int len)
+{
+    size_t words = (URJ_TAP_REGISTER_BYTES (len) + sizeof (unsigned long) - 1)
+        / sizeof (unsigned long);
+
+    return words * sizeof (unsigned long);
+}
+
+/* keep the unused bits of the last byte zero; see tap_register.h */
+static void
+register_clear_padding (urj_tap_register_t *tr)
+{
+    if (tr->len & 7)
+        tr->packed[tr->len >> 3] &= (1 << (tr->len & 7)) - 1;
+}
+
+/* fetch n <= 64 bits starting at bit off, LSB first */
+static uint64_t
+bits_get (const uint8_t *p, int off, int n)
+{
+    uint64_t v = 0;
+    int i = 0;
+
+    while (i < n)
+    {
+        int sh = (off + i) & 7;
+        int take = 8 - sh;
+
+        if (take > n - i)
+            take = n - i;
+        v |= (uint64_t) ((p[(off + i) >> 3] >> sh) & ((1 << take) - 1)) << i;
+        i += take;
+    }
+
+    return v;
+}
+
+/* store n <= 64 bits of v starting at bit off, LSB first */
+static void
+bits_put (uint8_t *p, int off, int n, uint64_t v)
+{
+    int i = 0;
+
+    while (i < n)
+    {
+        int sh = (off + i) & 7;
+        int take = 8 - sh;
+        uint8_t mask;
+
+        if (take > n - i)
+            take = n - i;
+        mask = ((1 << take) - 1) << sh;
+        p[(off + i) >> 3] = (p[(off + i) >> 3] & ~mask)
+            | (((v >> i) << sh) & mask);
+        i += take;
+    }
+}
+
+void
+urj_tap_bits_copy (uint8_t *dst, int dst_off, const uint8_t *src,
+                   int src_off, int len)
+{
+    if (len <= 0)
+        return;
+
+    if (((dst_off | src_off) & 7) == 0)
+    {
+        /* byte aligned: copy whole bytes, merge the trailing partial byte */
+        int bytes = len >> 3;
+        int rest = len & 7;
+
+        dst += dst_off >> 3;
+        src += src_off >> 3;
+        memmove (dst, src, bytes);
+        if (rest)
+        {
+            uint8_t mask = (1 << rest) - 1;
+            dst[bytes] = (dst[bytes] & ~mask) | (src[bytes] & mask);
+        }
+        return;
+    }
+
+    while (len > 0)
+    {
+        int n = len > 56 ? 56 : len;
+
+        bits_put (dst, dst_off, n, bits_get (src, src_off, n));
+        dst_off += n;
+        src_off += n;
+        len -= n;
+    }
+}
+
+void
+urj_tap_bits_pack (uint8_t *dst, int dst_off, const char *src, int len)
+{
+    int i;
+
+    /* leading bits up to the next byte boundary */
+    for (i = 0; i < len && ((dst_off + i) & 7); i++)
+    {
+        int n = dst_off + i;
+        if (src[i] & 1)
+            dst[n >> 3] |= 1 << (n & 7);
+        else
+            dst[n >> 3] &= ~(1 << (n & 7));
+    }
+
+    /* whole bytes */
+    for (; i + 8 <= len; i += 8)
+    {
+        const char *s = src + i;
+
+        dst[(dst_off + i) >> 3] = (s[0] & 1) | (s[1] & 1) << 1
+            | (s[2] & 1) << 2 | (s[3] & 1) << 3 | (s[4] & 1) << 4
+            | (s[5] & 1) << 5 | (s[6] & 1) << 6 | (s[7] & 1) << 7;
+    }
+
+    /* trailing bits */
+    for (; i < len; i++)
+    {
+        int n = dst_off + i;
+        if (src[i] & 1)
+            dst[n >> 3] |= 1 << (n & 7);
+        else
+            dst[n >> 3] &= ~(1 << (n & 7));
+    }
+}
+
+void
+urj_tap_bits_unpack (char *dst, const uint8_t *src, int src_off, int len)
+{
+    int i;
+
+    for (i = 0; i < len && ((src_off + i) & 7); i++)
+        dst[i] = (src[(src_off + i) >> 3] >> ((src_off + i) & 7)) & 1;
+
+    for (; i + 8 <= len; i += 8)
+    {
+        uint8_t b = src[(src_off + i) >> 3];
+        char *d = dst + i;
+
+        d[0] = b & 1;
+        d[1] = (b >> 1) & 1;
+        d[2] = (b >> 2) & 1;
+        d[3] = (b >> 3) & 1;
+        d[4] = (b >> 4) & 1;
+        d[5] = (b >> 5) & 1;
+        d[6] = (b >> 6) & 1;
+        d[7] = (b >> 7) & 1;
+    }
+
+    for (; i < len; i++)
+        dst[i] = (src[(src_off + i) >> 3] >> ((src_off + i) & 7)) & 1;
+}
+
 urj_tap_register_t *
 urj_tap_register_alloc (int len)
 {
@@ -51,29 +209,18 @@ urj_tap_register_alloc (int len)
         return NULL;
     }
 
-    tr->data = malloc (len);
-    if (!tr->data)
+    tr->packed = calloc (1, register_alloc_size (len));
+    if (!tr->packed)
     {
         free (tr);
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) len);
-        return NULL;
-    }
-
-    memset (tr->data, 0, len);
-
-    tr->string = malloc (len + 1);
-    if (!tr->string)
-    {
-        free (tr->data);
-        free (tr);
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
-                       (size_t) (len + 1));
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "calloc(%zd) fails",
+                       register_alloc_size (len));
         return NULL;
     }
 
+    /* the string representation is only allocated on demand */
+    tr->string = NULL;
     tr->len = len;
-    tr->string[len] = '\0';
 
     return tr;
 }
@@ -81,6 +228,9 @@ urj_tap_register_alloc (int len)
 urj_tap_register_t *
 urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
 {
+    uint8_t *packed;
+    size_t new_size;
+
     if (!tr)
         return urj_tap_register_alloc (new_len);
 
@@ -90,19 +240,28 @@ urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
         return NULL;
     }
 
-    tr->data = realloc (tr->data, new_len);
-
-    if (!tr->data)
+    new_size = register_alloc_size (new_len);
+    packed = realloc (tr->packed, new_size);
+    if (!packed)
     {
-        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%d) fails",
-                       new_len);
+        urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "realloc(%zd) fails",
+                       new_size);
         return NULL;
     }
 
-    if (tr->len < new_len)
-        memset (tr->data + tr->len, 0, (new_len - tr->len));
-
+    /* new bits read as zero; cut-off bits are dropped from the padding */
+    tr->packed = packed;
+    if (new_len > tr->len)
+        memset (tr->packed + URJ_TAP_REGISTER_BYTES (tr->len), 0,
+                new_size - URJ_TAP_REGISTER_BYTES (tr->len));
+    else
+        memset (tr->packed + URJ_TAP_REGISTER_BYTES (new_len), 0,
+                new_size - URJ_TAP_REGISTER_BYTES (new_len));
     tr->len = new_len;
+    register_clear_padding (tr);
+
+    free (tr->string);
+    tr->string = NULL;
 
     return tr;
 }
@@ -110,14 +269,19 @@ urj_tap_register_realloc (urj_tap_register_t *tr, int new_len)
 urj_tap_register_t *
 urj_tap_register_duplicate (const urj_tap_register_t *tr)
 {
+    urj_tap_register_t *dup;
+
     if (!tr)
     {
         urj_error_set (URJ_ERROR_INVALID, "tr == NULL");
         return NULL;
     }
 
-    return urj_tap_register_init (urj_tap_register_alloc (tr->len),
-                                  urj_tap_register_get_string (tr));
+    dup = urj_tap_register_alloc (tr->len);
+    if (dup)
+        memcpy (dup->packed, tr->packed, URJ_TAP_REGISTER_BYTES (tr->len));
+
+    return dup;
 }
 
 void
@@ -125,7 +289,7 @@ urj_tap_register_free (urj_tap_register_t *tr)
 {
     if (tr)
     {
-        free (tr->data);
+        free (tr->packed);
         free (tr->string);
     }
     free (tr);
@@ -135,7 +299,11 @@ urj_tap_register_t *
 urj_tap_register_fill (urj_tap_register_t *tr, int val)
 {
     if (tr)
-        memset (tr->data, val & 1, tr->len);
+    {
+        memset (tr->packed, (val & 1) ? 0xff : 0,
+                URJ_TAP_REGISTER_BYTES (tr->len));
+        register_clear_padding (tr);
+    }
 
     return tr;
 }
@@ -184,7 +352,7 @@ urj_tap_register_set_string (urj_tap_register_t *tr, const char *str)
         }
 
         for (bit = 0; str[bit]; ++bit)
-            tr->data[tr->len - 1 - bit] = (str[bit] == '1');
+            urj_tap_register_set_bit (tr, tr->len - 1 - bit, str[bit] == '1');
 
         return URJ_STATUS_OK;
     }
@@ -194,7 +362,6 @@ int
 urj_tap_register_set_value_bit_range (urj_tap_register_t *tr, uint64_t val, int msb, int lsb)
 {
     int bit;
-    int step = msb >= lsb ? 1 : -1;
 
     if (!tr)
     {
@@ -210,9 +377,21 @@ urj_tap_register_set_value_bit_range (urj_tap_register_t *tr, uint64_t val, int
         return URJ_STATUS_FAIL;
     }
 
-    for (bit = lsb; bit * step <= msb * step; bit += step)
+    if (msb >= lsb)
     {
-        tr->data[bit] = !!(val & 1);
+        /* ascending range: store up to a byte at a time; bits beyond
+         * the 64 bits of val are cleared */
+        int n = msb - lsb + 1;
+
+        bits_put (tr->packed, lsb, n > 64 ? 64 : n, val);
+        for (bit = lsb + 64; bit <= msb; bit++)
+            urj_tap_register_set_bit (tr, bit, 0);
+        return URJ_STATUS_OK;
+    }
+
+    for (bit = lsb; bit >= msb; bit--)
+    {
+        urj_tap_register_set_bit (tr, bit, val & 1);
         val >>= 1;
     }
 
@@ -236,8 +415,22 @@ urj_tap_register_get_string (const urj_tap_register_t *tr)
         return NULL;
     }
 
+    if (!tr->string)
+    {
+        /* the string buffer is a cache and not part of the register value */
+        char *string = malloc (tr->len + 1);
+        if (!string)
+        {
+            urj_error_set (URJ_ERROR_OUT_OF_MEMORY, "malloc(%zd) fails",
+                           (size_t) (tr->len + 1));
+            return NULL;
+        }
+        string[tr->len] = '\0';
+        ((urj_tap_register_t *) tr)->string = string;
+    }
+
     for (i = 0; i < tr->len; i++)
-        tr->string[tr->len - 1 - i] = (tr->data[i] & 1) ? '1' : '0';
+        tr->string[tr->len - 1 - i] = urj_tap_register_get_bit (tr, i) ? '1' : '0';
 
     return tr->string;
 }
@@ -247,7 +440,6 @@ urj_tap_register_get_value_bit_range (const urj_tap_register_t *tr, int msb, int
 {
     int bit;
     uint64_t l, b;
-    int step = msb >= lsb ? 1 : -1;
 
     if (!tr)
         return 0;
@@ -255,11 +447,18 @@ urj_tap_register_get_value_bit_range (const urj_tap_register_t *tr, int msb, int
     if (msb > tr->len - 1 || lsb > tr->len - 1 || msb < 0 || lsb < 0)
         return 0;
 
+    if (msb >= lsb)
+    {
+        int n = msb - lsb + 1;
+
+        return bits_get (tr->packed, lsb, n > 64 ? 64 : n);
+    }
+
     l = 0;
     b = 1;
-    for (bit = lsb; bit * step <= msb * step; bit += step)
+    for (bit = lsb; bit >= msb; bit--)
     {
-        if (tr->data[bit] & 1)
+        if (urj_tap_register_get_bit (tr, bit))
             l |= b;
         b <<= 1;
     }
@@ -276,22 +475,32 @@ urj_tap_register_get_value (const urj_tap_register_t *tr)
 int
 urj_tap_register_all_bits_same_value (const urj_tap_register_t *tr)
 {
-    int i, value;
+    int i, value, full;
+    uint8_t pattern;
+
     if (!tr)
         return -1;
-    if (tr->len < 0)
+    if (tr->len < 1)
         return -1;
 
     /* Return -1 if any of the bits in the register
      * differs from the others; the value otherwise. */
 
-    value = tr->data[0] & 1;
+    value = urj_tap_register_get_bit (tr, 0);
+    pattern = value ? 0xff : 0;
+
+    full = tr->len >> 3;
+    for (i = 0; i < full; i++)
+        if (tr->packed[i] != pattern)
+            return -1;
 
-    for (i = 1; i < tr->len; i++)
+    if (tr->len & 7)
     {
-        if ((tr->data[i] & 1) != value)
+        uint8_t mask = (1 << (tr->len & 7)) - 1;
+        if (tr->packed[full] != (pattern & mask))
             return -1;
     }
+
     return value;
 }
 
@@ -310,11 +519,11 @@ urj_tap_register_init (urj_tap_register_t *tr, const char *value)
     for (i = 0; i < tr->len; i++)
     {
         if (p == value)
-            tr->data[i] = 0;
+            urj_tap_register_set_bit (tr, i, 0);
         else
         {
             p--;
-            tr->data[i] = (*p == '0') ? 0 : 1;
+            urj_tap_register_set_bit (tr, i, *p != '0');
         }
     }
 
@@ -325,8 +534,6 @@ int
 urj_tap_register_compare (const urj_tap_register_t *tr,
                           const urj_tap_register_t *tr2)
 {
-    int i;
-
     if (!tr && !tr2)
         return 0;
 
@@ -336,27 +543,26 @@ urj_tap_register_compare (const urj_tap_register_t *tr,
     if (tr->len != tr2->len)
         return 1;
 
-    for (i = 0; i < tr->len; i++)
-        if (tr->data[i] != tr2->data[i])
-            return 1;
-
-    return 0;
+    /* padding bits are always zero, so whole bytes can be compared */
+    return memcmp (tr->packed, tr2->packed,
+                   URJ_TAP_REGISTER_BYTES (tr->len)) ? 1 : 0;
 }
 
 int
 urj_tap_register_match (const urj_tap_register_t *tr, const char *expr)
 {
     int i;
-    const char *s;
 
     if (!tr || !expr || (tr->len != strlen (expr)))
         return 0;
 
-    s = urj_tap_register_get_string (tr);
-
     for (i = 0; i < tr->len; i++)
-        if ((expr[i] != '?') && (expr[i] != s[i]))
+    {
+        char c = expr[tr->len - 1 - i];
+
+        if (c != '?' && c != (urj_tap_register_get_bit (tr, i) ? '1' : '0'))
             return 0;
+    }
 
     return 1;
 }
@@ -364,18 +570,18 @@ urj_tap_register_match (const urj_tap_register_t *tr, const char *expr)
 urj_tap_register_t *
 urj_tap_register_inc (urj_tap_register_t *tr)
 {
-    int i;
+    int i, bytes;
 
     if (!tr)
         return NULL;
 
-    for (i = 0; i < tr->len; i++)
-    {
-        tr->data[i] ^= 1;
-
-        if (tr->data[i] == 1)
+    /* add one byte-wise; propagate the carry while a byte overflows */
+    bytes = URJ_TAP_REGISTER_BYTES (tr->len);
+    for (i = 0; i < bytes; i++)
+        if (++tr->packed[i] != 0)
             break;
-    }
+
+    register_clear_padding (tr);
 
     return tr;
 }
@@ -383,18 +589,18 @@ urj_tap_register_inc (urj_tap_register_t *tr)
 urj_tap_register_t *
 urj_tap_register_dec (urj_tap_register_t *tr)
 {
-    int i;
+    int i, bytes;
 
     if (!tr)
         return NULL;
 
-    for (i = 0; i < tr->len; i++)
-    {
-        tr->data[i] ^= 1;
-
-        if (tr->data[i] == 0)
+    /* subtract one byte-wise; propagate the borrow while a byte underflows */
+    bytes = URJ_TAP_REGISTER_BYTES (tr->len);
+    for (i = 0; i < bytes; i++)
+        if (tr->packed[i]-- != 0)
             break;
-    }
+
+    register_clear_padding (tr);
 
     return tr;
 }
@@ -402,7 +608,7 @@ urj_tap_register_dec (urj_tap_register_t *tr)
 urj_tap_register_t *
 urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
 {
-    int i;
+    int i, bytes, byte_shift, bit_shift;
 
     if (!tr)
         return NULL;
@@ -410,12 +616,27 @@ urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
     if (shift < 1)
         return tr;
 
-    for (i = 0; i < tr->len; i++)
+    if (shift >= tr->len)
+        return urj_tap_register_fill (tr, 0);
+
+    /* move towards bit 0; reading ahead of the write position
+     * allows doing this in place */
+    bytes = URJ_TAP_REGISTER_BYTES (tr->len);
+    byte_shift = shift >> 3;
+    bit_shift = shift & 7;
+    for (i = 0; i < bytes; i++)
     {
-        if (i + shift < tr->len)
-            tr->data[i] = tr->data[i + shift];
-        else
-            tr->data[i] = 0;
+        int lo = i + byte_shift;
+        int hi = lo + 1;
+        unsigned v = lo < bytes ? tr->packed[lo] : 0;
+
+        if (bit_shift)
+        {
+            v >>= bit_shift;
+            if (hi < bytes)
+                v |= tr->packed[hi] << (8 - bit_shift);
+        }
+        tr->packed[i] = v;
     }
 
     return tr;
@@ -424,7 +645,7 @@ urj_tap_register_shift_right (urj_tap_register_t *tr, int shift)
 urj_tap_register_t *
 urj_tap_register_shift_left (urj_tap_register_t *tr, int shift)
 {
-    int i;
+    int i, bytes, byte_shift, bit_shift;
 
     if (!tr)
         return NULL;
@@ -432,13 +653,43 @@ urj_tap_register_shift_left (urj_tap_register_t *tr, int shift)
     if (shift < 1)
         return tr;
 
-    for (i = tr->len - 1; i >= 0; i--)
+    if (shift >= tr->len)
+        return urj_tap_register_fill (tr, 0);
+
+    /* move away from bit 0, starting at the top */
+    bytes = URJ_TAP_REGISTER_BYTES (tr->len);
+    byte_shift = shift >> 3;
+    bit_shift = shift & 7;
+    for (i = bytes - 1; i >= 0; i--)
     {
-        if (i - shift >= 0)
-            tr->data[i] = tr->data[i - shift];
-        else
-            tr->data[i] = 0;
+        int hi = i - byte_shift;
+        int lo = hi - 1;
+        unsigned v = hi >= 0 ? tr->packed[hi] : 0;
+
+        if (bit_shift)
+        {
+            v <<= bit_shift;
+            if (lo >= 0)
+                v |= tr->packed[lo] >> (8 - bit_shift);
+        }
+        tr->packed[i] = v;
     }
 
+    register_clear_padding (tr);
+
     return tr;
 }
+
+void
+urj_tap_register_get_bits (const urj_tap_register_t *tr, char *bits,
+                           int first, int len)
+{
+    urj_tap_bits_unpack (bits, tr->packed, first, len);
+}
+
+void
+urj_tap_register_set_bits (urj_tap_register_t *tr, const char *bits,
+                           int first, int len)
+{
+    urj_tap_bits_pack (tr->packed, first, bits, len);
+}
@@ -23,8 +23,158 @@
  *
  */
 
+#include <sysdep.h>
+
+#include <urjtag/error.h>
 #include <urjtag/tap_state.h>
 #include <urjtag/chain.h>
+#include <urjtag/cable.h>
+
+/* states in the order of the rows and columns of tap_state_path */
+static const int tap_state_order[16] = {
+    URJ_TAP_STATE_TEST_LOGIC_RESET,
+    URJ_TAP_STATE_RUN_TEST_IDLE,
+    URJ_TAP_STATE_SELECT_DR_SCAN,
+    URJ_TAP_STATE_CAPTURE_DR,
+    URJ_TAP_STATE_SHIFT_DR,
+    URJ_TAP_STATE_EXIT1_DR,
+    URJ_TAP_STATE_PAUSE_DR,
+    URJ_TAP_STATE_EXIT2_DR,
+    URJ_TAP_STATE_UPDATE_DR,
+    URJ_TAP_STATE_SELECT_IR_SCAN,
+    URJ_TAP_STATE_CAPTURE_IR,
+    URJ_TAP_STATE_SHIFT_IR,
+    URJ_TAP_STATE_EXIT1_IR,
+    URJ_TAP_STATE_PAUSE_IR,
+    URJ_TAP_STATE_EXIT2_IR,
+    URJ_TAP_STATE_UPDATE_IR
+};
+
+/*
+ * Shortest TMS sequence from one state (row) to another (column): len
+ * clocks with TMS taken from the bits of tms, LSB first.  Paths never
+ * pass through Test-Logic-Reset unless that is where they start or end,
+ * so they do not disturb the instruction registers on the way.
+ */
+static const struct
+{
+    uint8_t tms;
+    uint8_t len;
+}
+tap_state_path[16][16] = {
+    /* from Test-Logic-Reset */
+    {
+        { 0x00, 0 }, { 0x00, 1 }, { 0x02, 2 }, { 0x02, 3 },
+        { 0x02, 4 }, { 0x0a, 4 }, { 0x0a, 5 }, { 0x2a, 6 },
+        { 0x1a, 5 }, { 0x06, 3 }, { 0x06, 4 }, { 0x06, 5 },
+        { 0x16, 5 }, { 0x16, 6 }, { 0x56, 7 }, { 0x36, 6 }
+    },
+    /* from Run-Test/Idle */
+    {
+        { 0x07, 3 }, { 0x00, 0 }, { 0x01, 1 }, { 0x01, 2 },
+        { 0x01, 3 }, { 0x05, 3 }, { 0x05, 4 }, { 0x15, 5 },
+        { 0x0d, 4 }, { 0x03, 2 }, { 0x03, 3 }, { 0x03, 4 },
+        { 0x0b, 4 }, { 0x0b, 5 }, { 0x2b, 6 }, { 0x1b, 5 }
+    },
+    /* from Select-DR-Scan */
+    {
+        { 0x03, 2 }, { 0x06, 4 }, { 0x00, 0 }, { 0x00, 1 },
+        { 0x00, 2 }, { 0x02, 2 }, { 0x02, 3 }, { 0x0a, 4 },
+        { 0x06, 3 }, { 0x01, 1 }, { 0x01, 2 }, { 0x01, 3 },
+        { 0x05, 3 }, { 0x05, 4 }, { 0x15, 5 }, { 0x0d, 4 }
+    },
+    /* from Capture-DR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x00, 0 },
+        { 0x00, 1 }, { 0x01, 1 }, { 0x01, 2 }, { 0x05, 3 },
+        { 0x03, 2 }, { 0x0f, 4 }, { 0x0f, 5 }, { 0x0f, 6 },
+        { 0x2f, 6 }, { 0x2f, 7 }, { 0xaf, 8 }, { 0x6f, 7 }
+    },
+    /* from Shift-DR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x07, 4 },
+        { 0x00, 0 }, { 0x01, 1 }, { 0x01, 2 }, { 0x05, 3 },
+        { 0x03, 2 }, { 0x0f, 4 }, { 0x0f, 5 }, { 0x0f, 6 },
+        { 0x2f, 6 }, { 0x2f, 7 }, { 0xaf, 8 }, { 0x6f, 7 }
+    },
+    /* from Exit1-DR */
+    {
+        { 0x0f, 4 }, { 0x01, 2 }, { 0x03, 2 }, { 0x03, 3 },
+        { 0x02, 3 }, { 0x00, 0 }, { 0x00, 1 }, { 0x02, 2 },
+        { 0x01, 1 }, { 0x07, 3 }, { 0x07, 4 }, { 0x07, 5 },
+        { 0x17, 5 }, { 0x17, 6 }, { 0x57, 7 }, { 0x37, 6 }
+    },
+    /* from Pause-DR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x07, 4 },
+        { 0x01, 2 }, { 0x05, 3 }, { 0x00, 0 }, { 0x01, 1 },
+        { 0x03, 2 }, { 0x0f, 4 }, { 0x0f, 5 }, { 0x0f, 6 },
+        { 0x2f, 6 }, { 0x2f, 7 }, { 0xaf, 8 }, { 0x6f, 7 }
+    },
+    /* from Exit2-DR */
+    {
+        { 0x0f, 4 }, { 0x01, 2 }, { 0x03, 2 }, { 0x03, 3 },
+        { 0x00, 1 }, { 0x02, 2 }, { 0x02, 3 }, { 0x00, 0 },
+        { 0x01, 1 }, { 0x07, 3 }, { 0x07, 4 }, { 0x07, 5 },
+        { 0x17, 5 }, { 0x17, 6 }, { 0x57, 7 }, { 0x37, 6 }
+    },
+    /* from Update-DR */
+    {
+        { 0x07, 3 }, { 0x00, 1 }, { 0x01, 1 }, { 0x01, 2 },
+        { 0x01, 3 }, { 0x05, 3 }, { 0x05, 4 }, { 0x15, 5 },
+        { 0x00, 0 }, { 0x03, 2 }, { 0x03, 3 }, { 0x03, 4 },
+        { 0x0b, 4 }, { 0x0b, 5 }, { 0x2b, 6 }, { 0x1b, 5 }
+    },
+    /* from Select-IR-Scan */
+    {
+        { 0x01, 1 }, { 0x06, 4 }, { 0x0e, 4 }, { 0x0e, 5 },
+        { 0x0e, 6 }, { 0x2e, 6 }, { 0x2e, 7 }, { 0xae, 8 },
+        { 0x6e, 7 }, { 0x00, 0 }, { 0x00, 1 }, { 0x00, 2 },
+        { 0x02, 2 }, { 0x02, 3 }, { 0x0a, 4 }, { 0x06, 3 }
+    },
+    /* from Capture-IR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x07, 4 },
+        { 0x07, 5 }, { 0x17, 5 }, { 0x17, 6 }, { 0x57, 7 },
+        { 0x37, 6 }, { 0x0f, 4 }, { 0x00, 0 }, { 0x00, 1 },
+        { 0x01, 1 }, { 0x01, 2 }, { 0x05, 3 }, { 0x03, 2 }
+    },
+    /* from Shift-IR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x07, 4 },
+        { 0x07, 5 }, { 0x17, 5 }, { 0x17, 6 }, { 0x57, 7 },
+        { 0x37, 6 }, { 0x0f, 4 }, { 0x0f, 5 }, { 0x00, 0 },
+        { 0x01, 1 }, { 0x01, 2 }, { 0x05, 3 }, { 0x03, 2 }
+    },
+    /* from Exit1-IR */
+    {
+        { 0x0f, 4 }, { 0x01, 2 }, { 0x03, 2 }, { 0x03, 3 },
+        { 0x03, 4 }, { 0x0b, 4 }, { 0x0b, 5 }, { 0x2b, 6 },
+        { 0x1b, 5 }, { 0x07, 3 }, { 0x07, 4 }, { 0x02, 3 },
+        { 0x00, 0 }, { 0x00, 1 }, { 0x02, 2 }, { 0x01, 1 }
+    },
+    /* from Pause-IR */
+    {
+        { 0x1f, 5 }, { 0x03, 3 }, { 0x07, 3 }, { 0x07, 4 },
+        { 0x07, 5 }, { 0x17, 5 }, { 0x17, 6 }, { 0x57, 7 },
+        { 0x37, 6 }, { 0x0f, 4 }, { 0x0f, 5 }, { 0x01, 2 },
+        { 0x05, 3 }, { 0x00, 0 }, { 0x01, 1 }, { 0x03, 2 }
+    },
+    /* from Exit2-IR */
+    {
+        { 0x0f, 4 }, { 0x01, 2 }, { 0x03, 2 }, { 0x03, 3 },
+        { 0x03, 4 }, { 0x0b, 4 }, { 0x0b, 5 }, { 0x2b, 6 },
+        { 0x1b, 5 }, { 0x07, 3 }, { 0x07, 4 }, { 0x00, 1 },
+        { 0x02, 2 }, { 0x02, 3 }, { 0x00, 0 }, { 0x01, 1 }
+    },
+    /* from Update-IR */
+    {
+        { 0x07, 3 }, { 0x00, 1 }, { 0x01, 1 }, { 0x01, 2 },
+        { 0x01, 3 }, { 0x05, 3 }, { 0x05, 4 }, { 0x15, 5 },
+        { 0x0d, 4 }, { 0x03, 2 }, { 0x03, 3 }, { 0x03, 4 },
+        { 0x0b, 4 }, { 0x0b, 5 }, { 0x2b, 6 }, { 0x00, 0 }
+    }
+};
 
 static const char *
 urj_tap_state_name (int state)
@@ -203,3 +353,56 @@ urj_tap_state_clock (urj_chain_t *chain, int tms)
     urj_tap_state_dump_2 (oldstate, chain->state, tms);
     return chain->state;
 }
+
+/** @return row/column of state in tap_state_path; -1 if unknown */
+static int
+tap_state_index (int state)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+        if (tap_state_order[i] == state)
+            return i;
+
+    return -1;
+}
+
+int
+urj_tap_goto_state (urj_chain_t *chain, int state)
+{
+    int from, to, i;
+
+    if (!chain || !chain->cable)
+    {
+        urj_error_set (URJ_ERROR_NO_CHAIN, "no chain or no part");
+        return URJ_STATUS_FAIL;
+    }
+
+    to = tap_state_index (state);
+    if (to < 0)
+    {
+        urj_error_set (URJ_ERROR_INVALID, "unknown TAP state 0x%02x", state);
+        return URJ_STATUS_FAIL;
+    }
+
+    from = tap_state_index (chain->state);
+    if (from < 0)
+    {
+        /* five clocks with TMS high reach Test-Logic-Reset from anywhere */
+        if (urj_tap_cable_defer_tms (chain->cable, 0x1f, 0, 5)
+            != URJ_STATUS_OK)
+            return URJ_STATUS_FAIL;
+        urj_tap_state_reset (chain);
+        from = tap_state_index (URJ_TAP_STATE_TEST_LOGIC_RESET);
+    }
+
+    if (urj_tap_cable_defer_tms (chain->cable, tap_state_path[from][to].tms,
+                                 0, tap_state_path[from][to].len)
+        != URJ_STATUS_OK)
+        return URJ_STATUS_FAIL;
+
+    for (i = 0; i < tap_state_path[from][to].len; i++)
+        urj_tap_state_clock (chain, (tap_state_path[from][to].tms >> i) & 1);
+
+    return URJ_STATUS_OK;
+}
@@ -27,6 +27,7 @@
 #include <stdio.h>
 
 #include <urjtag/log.h>
+#include <urjtag/error.h>
 #include <urjtag/cable.h>
 #include <urjtag/part.h>
 #include <urjtag/tap_register.h>
@@ -76,39 +77,33 @@ urj_tap_reset_bypass (urj_chain_t *chain)
     return URJ_STATUS_OK;
 }
 
-void
-urj_tap_defer_shift_register (urj_chain_t *chain,
-                              const urj_tap_register_t *in,
-                              urj_tap_register_t *out, int tap_exit)
+/*
+ * Whether the shift can leave Shift-DR/IR within the cable transfer
+ * itself; this takes all of out, so it has to be able to hold every bit
+ */
+static int
+tap_shift_exits_in_transfer (const urj_tap_register_t *in,
+                             const urj_tap_register_t *out, int tap_exit)
 {
-    int i;
+    return tap_exit != URJ_CHAIN_EXITMODE_SHIFT && in->len > 0
+        && (out == NULL || out->len >= in->len);
+}
 
+static void
+tap_shift_enter (urj_chain_t *chain, const char *func)
+{
     if (!(urj_tap_state (chain) & URJ_TAP_STATE_SHIFT))
-        urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
+        urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), func,
                 urj_tap_state (chain));
 
     /* Capture-DR, Capture-IR, Shift-DR, Shift-IR, Exit2-DR or Exit2-IR state */
     if (urj_tap_state (chain) & URJ_TAP_STATE_CAPTURE)
         urj_tap_chain_defer_clock (chain, 0, 0, 1);     /* save last TDO bit :-) */
+}
 
-    i = in->len;
-    if (tap_exit)
-        i--;
-    if (out && out->len < i)
-        i = out->len;
-
-    if (out)
-        urj_tap_cable_defer_transfer (chain->cable, i, in->data, out->data);
-    else
-        urj_tap_cable_defer_transfer (chain->cable, i, in->data, NULL);
-
-    for (; i < in->len; i++)
-    {
-        if (out != NULL && (i < out->len))
-            out->data[i] = urj_tap_cable_defer_get_tdo (chain->cable);
-        urj_tap_chain_defer_clock (chain, (tap_exit != URJ_CHAIN_EXITMODE_SHIFT && ((i + 1) == in->len)) ? 1 : 0, in->data[i], 1);      /* Shift (& Exit1) */
-    }
-
+static void
+tap_shift_leave (urj_chain_t *chain, int tap_exit)
+{
     /* Shift-DR, Shift-IR, Exit1-DR or Exit1-IR state */
     if (tap_exit == URJ_CHAIN_EXITMODE_IDLE)
     {
@@ -120,12 +115,85 @@ urj_tap_defer_shift_register (urj_chain_t *chain,
         urj_tap_chain_defer_clock (chain, 1, 0, 1);     /* Update-DR or Update-IR */
 }
 
+void
+urj_tap_defer_shift_register (urj_chain_t *chain,
+                              const urj_tap_register_t *in,
+                              urj_tap_register_t *out, int tap_exit)
+{
+    int i;
+
+    tap_shift_enter (chain, __func__);
+
+    if (tap_shift_exits_in_transfer (in, out, tap_exit))
+    {
+        /* Shift & Exit1 in one go */
+        urj_tap_cable_defer_transfer_exit (chain->cable, in->len, in->packed,
+                                           out ? out->packed : NULL);
+        urj_tap_state_clock (chain, 1);
+    }
+    else
+    {
+        i = in->len;
+        if (tap_exit)
+            i--;
+        if (out && out->len < i)
+            i = out->len;
+
+        if (out)
+            urj_tap_cable_defer_transfer_packed (chain->cable, i, in->packed,
+                                                 out->packed);
+        else
+            urj_tap_cable_defer_transfer_packed (chain->cable, i, in->packed,
+                                                 NULL);
+
+        for (; i < in->len; i++)
+        {
+            if (out != NULL && (i < out->len))
+                urj_tap_cable_defer_get_tdo (chain->cable);
+            urj_tap_chain_defer_clock (chain, (tap_exit != URJ_CHAIN_EXITMODE_SHIFT && ((i + 1) == in->len)) ? 1 : 0, urj_tap_register_get_bit (in, i), 1);  /* Shift (& Exit1) */
+        }
+    }
+
+    tap_shift_leave (chain, tap_exit);
+}
+
+urj_cable_ticket_t
+urj_tap_defer_shift_register_ticket (urj_chain_t *chain,
+                                     const urj_tap_register_t *in,
+                                     urj_tap_register_t *out, int tap_exit)
+{
+    urj_cable_ticket_t ticket;
+
+    if (out == NULL || !tap_shift_exits_in_transfer (in, out, tap_exit))
+    {
+        urj_error_set (URJ_ERROR_INVALID,
+                       _("shift of %d bits cannot be ticketed"), in->len);
+        return URJ_CABLE_NO_TICKET;
+    }
+
+    tap_shift_enter (chain, __func__);
+
+    /* Shift & Exit1 in one go, straight from and into the registers */
+    ticket = urj_tap_cable_defer_transfer_exit_zero_copy (chain->cable,
+                                                          in->len, in->packed,
+                                                          out->packed);
+    if (ticket == URJ_CABLE_NO_TICKET)
+        return URJ_CABLE_NO_TICKET;
+    urj_tap_state_clock (chain, 1);
+
+    tap_shift_leave (chain, tap_exit);
+
+    return ticket;
+}
+
 void
 urj_tap_shift_register_output (urj_chain_t *chain,
                                const urj_tap_register_t *in,
                                urj_tap_register_t *out, int tap_exit)
 {
-    if (out != NULL)
+    if (out != NULL && tap_shift_exits_in_transfer (in, out, tap_exit))
+        (void) urj_tap_cable_transfer_packed_late (chain->cable, out->packed);
+    else if (out != NULL)
     {
         int j;
 
@@ -138,9 +206,10 @@ urj_tap_shift_register_output (urj_chain_t *chain,
         /* Asking for the result of the cable transfer
          * actually flushes the queue */
 
-        (void) urj_tap_cable_transfer_late (chain->cable, out->data);
+        (void) urj_tap_cable_transfer_packed_late (chain->cable, out->packed);
         for (; j < in->len && j < out->len; j++)
-            out->data[j] = urj_tap_cable_get_tdo_late (chain->cable);
+            urj_tap_register_set_bit (out, j,
+                                      urj_tap_cable_get_tdo_late (chain->cable));
     }
 }
 
@@ -160,9 +229,15 @@ urj_tap_capture_dr (urj_chain_t *chain)
         urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
                  urj_tap_state (chain));
 
-    /* Run-Test/Idle or Update-DR or Update-IR state */
-    urj_tap_chain_defer_clock (chain, 1, 0, 1); /* Select-DR-Scan */
-    urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-DR */
+    /* Run-Test/Idle or Update-DR or Update-IR state; an unknown state is
+       not left through Test-Logic-Reset, that would reset the IR */
+    if (urj_tap_state (chain) == URJ_TAP_STATE_UNKNOWN_STATE)
+    {
+        urj_tap_chain_defer_clock (chain, 1, 0, 1); /* Select-DR-Scan */
+        urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-DR */
+    }
+    else
+        urj_tap_goto_state (chain, URJ_TAP_STATE_CAPTURE_DR);
 }
 
 void
@@ -173,7 +248,13 @@ urj_tap_capture_ir (urj_chain_t *chain)
         urj_log (URJ_LOG_LEVEL_NORMAL, _("%s: Invalid state: %2X\n"), __func__,
                  urj_tap_state (chain));
 
-    /* Run-Test/Idle or Update-DR or Update-IR state */
-    urj_tap_chain_defer_clock (chain, 1, 0, 2); /* Select-DR-Scan, then Select-IR-Scan */
-    urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-IR */
+    /* Run-Test/Idle or Update-DR or Update-IR state; an unknown state is
+       not left through Test-Logic-Reset, that would reset the IR */
+    if (urj_tap_state (chain) == URJ_TAP_STATE_UNKNOWN_STATE)
+    {
+        urj_tap_chain_defer_clock (chain, 1, 0, 2); /* Select-DR-Scan, then Select-IR-Scan */
+        urj_tap_chain_defer_clock (chain, 0, 0, 1); /* Capture-IR */
+    }
+    else
+        urj_tap_goto_state (chain, URJ_TAP_STATE_CAPTURE_IR);
 }